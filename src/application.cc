@@ -2,7 +2,11 @@
 #include "compat.h"
 #include <SDL_opengl.h>
 #include <array>
+#include <chrono>
+#include <ctime>
 #include <format>
+#include <fstream>
+#include <iterator>
 #include <print>
 #include <ranges>
 #include "gui_constants.h"
@@ -13,10 +17,17 @@
 #include "components/dashboard.h"
 #include "components/disk_creator.h"
 #include "components/disk_inspector.h"
+#include "components/event_timeline.h"
 #include "components/volume_inspector.h"
 #include "components/file_picker.h"
 #include "components/inspector.h"
+#include "components/latency_meter.h"
+#include "components/logic_analyzer.h"
+#include "components/movie_player.h"
+#include "components/rewind_controller.h"
+#include "components/script_runner.h"
 #include "components/settings_window.h"
+#include "components/snapshot_browser.h"
 #include "components/video_window.h"
 #include "components/virtual_keyboard.h"
 #include "core_actions.h"
@@ -48,11 +59,27 @@ constexpr DeviceDescriptor GetDeviceDescriptor(int device_id) {
   }
   return {ICON_FA_QUESTION, "Unknown"};
 }
+
+std::string LocalTime(int64_t seconds, const char* format) {
+  const std::time_t t = static_cast<std::time_t>(seconds);
+  std::tm local{};
+  localtime_r(&t, &local);
+  char buf[64];
+  std::strftime(buf, sizeof(buf), format, &local);
+  return buf;
+}
 }  // namespace
 Application::Application(int argc, char** argv)
     : gl_context_(nullptr, SDL_GL_DeleteContext) {}
 Application::~Application() {
+  gui::ScriptRunner::Instance().Stop();
+  gui::LatencyMeter::Instance().SetEnabled(false, emulator_);
+  gui::MoviePlayer::Instance().Stop();
+  gui::VolumeInspector::Instance().Stop();
+  gui::DiskInspector::Instance().Stop();
+  gui::SnapshotBrowser::Instance().ReleaseTextures();
   SaveConfig();
+  gui::Console::Instance().CloseLog();
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplSDL2_Shutdown();
   ImGui::DestroyContext();
@@ -64,6 +91,7 @@ bool Application::Init() {
   InitEmulator();
   config_ = std::make_unique<gui::ConfigProvider>(emulator_.defaults);
   LoadConfig();
+  OpenSnapshotLibrary();
   return true;
 }
 bool Application::InitSDL() {
@@ -166,6 +194,10 @@ void Application::LoadConfig() {
       config_->GetBool(gui::ConfigKeys::kRetainEnter, false);
   input_manager_->release_mouse_by_shaking_ =
       config_->GetBool(gui::ConfigKeys::kShakeRelease, true);
+  input_manager_->gamepad_polling_ =
+      config_->GetBool(gui::ConfigKeys::kGamepadPoll, gui::Defaults::kGamepadPolling);
+  input_manager_->mouse_deliveries_ =
+      config_->GetInt(gui::ConfigKeys::kMouseRate, gui::Defaults::kMouseDeliveries);
   kickstart_path_ = config_->GetString(gui::ConfigKeys::kKickstartPath);
   ext_rom_path_ = config_->GetString(gui::ConfigKeys::kExtRomPath);
   for (int i : std::views::iota(0, gui::kFloppyDriveCount))
@@ -237,8 +269,40 @@ void Application::LoadConfig() {
   emulator_.set(vamiga::Opt::JOY_AUTOFIRE_BULLETS, config_->GetInt(gui::ConfigKeys::kInputAutofireBullets, 1));
   emulator_.set(vamiga::Opt::JOY_AUTOFIRE_DELAY, config_->GetInt(gui::ConfigKeys::kInputAutofireDelay, 10));
   snapshot_auto_delete_ = config_->GetBool(gui::ConfigKeys::kSnapAutoDelete, gui::Defaults::kSnapshotAutoDelete);
+  snapshot_compress_ = config_->GetBool(gui::ConfigKeys::kSnapCompress, gui::Defaults::kSnapshotCompress);
+  snapshot_dedup_ = config_->GetBool(gui::ConfigKeys::kSnapDedup, gui::Defaults::kSnapshotDedup);
+  slots_persist_ = config_->GetBool(gui::ConfigKeys::kSlotsPersist, gui::Defaults::kSlotsPersist);
   screenshot_format_ = config_->GetInt(gui::ConfigKeys::kScrnFormat, gui::Defaults::kScreenshotFormat);
   screenshot_source_ = config_->GetInt(gui::ConfigKeys::kScrnSource, gui::Defaults::kScreenshotSource);
+  log_enabled_ = config_->GetBool(gui::ConfigKeys::kLogEnabled, gui::Defaults::kLogEnabled);
+  log_max_kb_ = config_->GetInt(gui::ConfigKeys::kLogMaxKb, gui::Defaults::kLogMaxKb);
+  log_max_files_ = config_->GetInt(gui::ConfigKeys::kLogMaxFiles, gui::Defaults::kLogMaxFiles);
+  log_compress_ = config_->GetBool(gui::ConfigKeys::kLogCompress, gui::Defaults::kLogCompress);
+  rewind_enabled_ = config_->GetBool(gui::ConfigKeys::kRewindEnabled, gui::Defaults::kRewindEnabled);
+  rewind_interval_ = config_->GetInt(gui::ConfigKeys::kRewindInterval, gui::Defaults::kRewindInterval);
+  rewind_budget_mb_ = config_->GetInt(gui::ConfigKeys::kRewindBudgetMb, gui::Defaults::kRewindBudgetMb);
+  ApplyLogSettings();
+  ApplyRewindSettings();
+}
+void Application::ApplyRewindSettings() {
+  gui::RewindController::Instance().Configure(
+      {rewind_enabled_, rewind_interval_, rewind_budget_mb_});
+}
+void Application::ApplyLogSettings() {
+  auto& console = gui::Console::Instance();
+  console.CloseLog();
+  if (!log_enabled_) return;
+  const char* home = std::getenv("HOME");
+  std::filesystem::path dir = home ? std::filesystem::path(home) / gui::Defaults::kConfigDir /
+                                         gui::Defaults::kAppName / gui::Defaults::kLogsDir
+                                   : std::filesystem::path(gui::Defaults::kLogsDir);
+  gui::LogWriter::Options options;
+  options.max_bytes = static_cast<std::size_t>(log_max_kb_) * 1024;
+  options.max_files = log_max_files_;
+  options.compress = log_compress_;
+  if (!console.OpenLog(dir / gui::Defaults::kLogFileName, options)) {
+    std::println(std::cerr, "Failed to open log file in {}", dir.string());
+  }
 }
 void Application::SaveConfig() {
   config_->SetBool(gui::ConfigKeys::kPauseBg,
@@ -249,6 +313,10 @@ void Application::SaveConfig() {
                    input_manager_->retain_mouse_by_entering_);
   config_->SetBool(gui::ConfigKeys::kShakeRelease,
                    input_manager_->release_mouse_by_shaking_);
+  config_->SetBool(gui::ConfigKeys::kGamepadPoll,
+                   input_manager_->gamepad_polling_);
+  config_->SetInt(gui::ConfigKeys::kMouseRate,
+                  input_manager_->mouse_deliveries_);
   for (int i : std::views::iota(0, gui::kHardDriveCount)) {
       std::string key = std::format("HD{}Path", i);
       config_->SetString(key, hard_drive_paths_[i]);
@@ -268,8 +336,18 @@ void Application::SaveConfig() {
   config_->SetInt(gui::ConfigKeys::kInputAutofireBullets, static_cast<int>(emulator_.get(vamiga::Opt::JOY_AUTOFIRE_BULLETS)));
   config_->SetInt(gui::ConfigKeys::kInputAutofireDelay, static_cast<int>(emulator_.get(vamiga::Opt::JOY_AUTOFIRE_DELAY)));
   config_->SetBool(gui::ConfigKeys::kSnapAutoDelete, snapshot_auto_delete_);
+  config_->SetBool(gui::ConfigKeys::kSnapCompress, snapshot_compress_);
+  config_->SetBool(gui::ConfigKeys::kSnapDedup, snapshot_dedup_);
+  config_->SetBool(gui::ConfigKeys::kSlotsPersist, slots_persist_);
   config_->SetInt(gui::ConfigKeys::kScrnFormat, screenshot_format_);
   config_->SetInt(gui::ConfigKeys::kScrnSource, screenshot_source_);
+  config_->SetBool(gui::ConfigKeys::kLogEnabled, log_enabled_);
+  config_->SetInt(gui::ConfigKeys::kLogMaxKb, log_max_kb_);
+  config_->SetInt(gui::ConfigKeys::kLogMaxFiles, log_max_files_);
+  config_->SetBool(gui::ConfigKeys::kLogCompress, log_compress_);
+  config_->SetBool(gui::ConfigKeys::kRewindEnabled, rewind_enabled_);
+  config_->SetInt(gui::ConfigKeys::kRewindInterval, rewind_interval_);
+  config_->SetInt(gui::ConfigKeys::kRewindBudgetMb, rewind_budget_mb_);
   config_->SetInt(gui::ConfigKeys::kHwCpu, static_cast<int>(emulator_.get(vamiga::Opt::CPU_REVISION)));
   config_->SetInt(gui::ConfigKeys::kHwAgnus, static_cast<int>(emulator_.get(vamiga::Opt::AGNUS_REVISION)));
   config_->SetInt(gui::ConfigKeys::kHwDenise, static_cast<int>(emulator_.get(vamiga::Opt::DENISE_REVISION)));
@@ -331,7 +409,23 @@ void Application::HandleEvents(bool& done) {
       std::filesystem::path path(event.drop.file);
       std::string ext = path.extension().string();
       for (auto& c : ext) c = tolower(c);
-      if (ext == ".adf" || ext == ".adz" || ext == ".dms" || ext == ".ipf")
+      std::error_code ec;
+      if (std::filesystem::is_directory(path, ec)) {
+        // A dropped folder becomes a disk image next to it.
+        std::string error;
+        if (auto import = gui::DiskCreator::ImportFolder(path, error)) {
+          if (import->hard_disk) {
+            AttachHardDrive(0, import->image);
+          } else {
+            InsertFloppy(0, import->image);
+          }
+          SetStatus(std::format("Imported {} files into {}", import->stats.files,
+                                import->image.filename().string()),
+                    false);
+        } else {
+          SetStatus("Import failed: " + error, true);
+        }
+      } else if (ext == ".adf" || ext == ".adz" || ext == ".dms" || ext == ".ipf")
         InsertFloppy(0, path);
       else if (ext == ".rom" || ext == ".bin")
         LoadKickstart(path);
@@ -348,15 +442,42 @@ void Application::HandleEvents(bool& done) {
             show_ui_ = !show_ui_;
             continue;
         }
+        if (event.key.keysym.sym >= SDLK_F1 && event.key.keysym.sym <= SDLK_F10 &&
+            (event.key.keysym.mod & KMOD_CTRL)) {
+            const int slot = event.key.keysym.sym - SDLK_F1;
+            if (event.key.keysym.mod & KMOD_SHIFT) {
+                SaveSlot(slot);
+            } else {
+                RestoreSlot(slot);
+            }
+            continue;
+        }
+        if (event.key.keysym.sym == SDLK_F11) {
+            gui::RewindController::Instance().SetRewinding(true, emulator_);
+            continue;
+        }
         if (event.key.keysym.sym == SDLK_RETURN && (event.key.keysym.mod & KMOD_ALT)) {
             ToggleFullscreen();
             continue;
         }
     }
+    if (event.type == SDL_KEYUP && event.key.keysym.sym == SDLK_F11) {
+        gui::RewindController::Instance().SetRewinding(false, emulator_);
+        continue;
+    }
     input_manager_->HandleEvent(event);
   }
+  input_manager_->FinishEvents();
+}
+void Application::Update() {
+  gui::Console::Instance().Update(emulator_);
+  gui::EventTimeline::Instance().Record(emulator_);
+  gui::LogicAnalyzer::Instance().Update(emulator_);
+  gui::MoviePlayer::Instance().Update(emulator_);
+  gui::RewindController::Instance().Update(emulator_);
+  gui::ScriptRunner::Instance().Update(emulator_);
+  snapshot_writer_.DeliverResults();
 }
-void Application::Update() {}
 void Application::Render() {
   if (video_texture_ == 0) {
     glGenTextures(1, &video_texture_);
@@ -431,6 +552,12 @@ void Application::DrawGUI() {
   if (ImGui::BeginMainMenuBar()) {
     if (ImGui::BeginMenu("File")) {
       if (ImGui::MenuItem("Import Script...")) {
+        gui::PickerOptions opts;
+        opts.title = "Import RetroShell Script";
+        opts.filters = "Scripts (*.ini *.retrosh *.txt){.ini,.retrosh,.txt},All Files{.*}";
+        gui::FilePicker::Instance().Open("ScriptLoad", opts, [](auto p) {
+          if (gui::ScriptRunner::Instance().Load(p)) gui::ScriptRunner::Instance().Open();
+        });
       }
       ImGui::Separator();
       if (ImGui::MenuItem("Quit", "Alt+F4")) {
@@ -444,7 +571,27 @@ void Application::DrawGUI() {
       ImGui::MenuItem("Inspector", nullptr, &show_inspector_);
       ImGui::MenuItem("Dashboard", nullptr, &show_dashboard_);
       ImGui::MenuItem("Console", nullptr, &show_console_);
+      ImGui::MenuItem("Input Latency", nullptr, &show_latency_);
+      ImGui::MenuItem("Input Movie", nullptr, &show_movie_);
+      ImGui::MenuItem("Snapshot Library", nullptr, &show_snapshots_);
       ImGui::Separator();
+      if (ImGui::MenuItem("Quick Snapshot")) {
+        QuickSaveSnapshot();
+      }
+      if (ImGui::BeginMenu("Quick Slots")) {
+        for (int i : std::views::iota(0, gui::SnapshotSlots::kCount)) {
+          const std::string label =
+              snapshot_slots_.Empty(i)
+                  ? std::format("Slot {}", i + 1)
+                  : std::format("Slot {} ({})", i + 1, LocalTime(snapshot_slots_.Time(i), "%H:%M:%S"));
+          if (ImGui::BeginMenu(label.c_str())) {
+            if (ImGui::MenuItem("Save", std::format("Ctrl+Shift+F{}", i + 1).c_str())) SaveSlot(i);
+            if (ImGui::MenuItem("Restore", std::format("Ctrl+F{}", i + 1).c_str())) RestoreSlot(i);
+            ImGui::EndMenu();
+          }
+        }
+        ImGui::EndMenu();
+      }
       if (ImGui::MenuItem("Load Snapshot...")) {
         gui::PickerOptions opts;
         opts.title = "Open Snapshot";
@@ -512,13 +659,27 @@ void Application::DrawGUI() {
     ctx.retain_mouse_by_click = &input_manager_->retain_mouse_by_click_;
     ctx.retain_mouse_by_entering = &input_manager_->retain_mouse_by_entering_;
     ctx.release_mouse_by_shaking = &input_manager_->release_mouse_by_shaking_;
+    ctx.gamepad_polling = &input_manager_->gamepad_polling_;
+    ctx.mouse_deliveries = &input_manager_->mouse_deliveries_;
     ctx.volume = &volume_;
     ctx.scale_mode = &scale_mode_;
     ctx.is_fullscreen = &is_fullscreen_;
     ctx.video_as_background = &video_as_background_;
     ctx.snapshot_auto_delete = &snapshot_auto_delete_;
+    ctx.snapshot_compress = &snapshot_compress_;
+    ctx.snapshot_dedup = &snapshot_dedup_;
+    ctx.slots_persist = &slots_persist_;
     ctx.screenshot_format = &screenshot_format_;
     ctx.screenshot_source = &screenshot_source_;
+    ctx.log_enabled = &log_enabled_;
+    ctx.log_max_kb = &log_max_kb_;
+    ctx.log_max_files = &log_max_files_;
+    ctx.log_compress = &log_compress_;
+    ctx.on_log_changed = [this]() { ApplyLogSettings(); };
+    ctx.rewind_enabled = &rewind_enabled_;
+    ctx.rewind_interval = &rewind_interval_;
+    ctx.rewind_budget_mb = &rewind_budget_mb_;
+    ctx.on_rewind_changed = [this]() { ApplyRewindSettings(); };
     ctx.port1_device = &port1_device_;
     ctx.port2_device = &port2_device_;
     ctx.input_manager = input_manager_.get();
@@ -549,10 +710,19 @@ void Application::DrawGUI() {
     gui::Dashboard::Instance().Draw(&show_dashboard_, emulator_);
   if (show_console_) gui::Console::Instance().Draw(&show_console_, emulator_);
   if (show_keyboard_)
-    gui::VirtualKeyboard::Instance().Draw(&show_keyboard_, emulator_);
+    gui::VirtualKeyboard::Instance().Draw(&show_keyboard_, *input_manager_);
   gui::DiskCreator::Instance().Draw(emulator_);
   gui::DiskInspector::Instance().Draw(emulator_);
   gui::VolumeInspector::Instance().Draw(emulator_);
+  gui::ScriptRunner::Instance().Draw(emulator_);
+  gui::LatencyMeter::Instance().Draw(&show_latency_, emulator_);
+  gui::MoviePlayer::Instance().Draw(&show_movie_, emulator_);
+  gui::SnapshotBrowser::Instance().Draw(&show_snapshots_, snapshot_library_,
+                                        [this](const auto& p) { LoadSnapshot(p); },
+                                        [this] {
+                                          // Frees the chunks only the deleted snapshot used.
+                                          if (chunk_store_.IsOpen()) chunk_store_.CollectAsync();
+                                        });
   gui::FilePicker::Instance().Draw();
 }
 void Application::DrawToolbar() {
@@ -618,6 +788,16 @@ void Application::DrawToolbar() {
     });
   }
   ImGui::SetItemTooltip("Load Snapshot");
+  ImGui::SameLine();
+  if (ImGui::Button(ICON_FA_BOOKMARK)) {
+    QuickSaveSnapshot();
+  }
+  ImGui::SetItemTooltip("Quick Snapshot");
+  ImGui::SameLine();
+  if (ImGui::Button(ICON_FA_IMAGES)) {
+    show_snapshots_ = !show_snapshots_;
+  }
+  ImGui::SetItemTooltip("Snapshot Library");
   ImGui::EndGroup();
   ImGui::SameLine(0, 20.0f);
   ImGui::BeginGroup();
@@ -656,6 +836,17 @@ void Application::DrawToolbar() {
   }
   ImGui::SetItemTooltip(emulator_.isPoweredOn() ? "Power Off" : "Power On");
   ImGui::EndGroup();
+  if (snapshot_writer_.Pending() > 0) {
+    ImGui::SameLine(0, 20.0f);
+    ImGui::AlignTextToFramePadding();
+    ImGui::TextDisabled(ICON_FA_FLOPPY_DISK " Saving snapshot...");
+  } else if (!status_text_.empty() && SDL_GetTicks64() < status_until_) {
+    ImGui::SameLine(0, 20.0f);
+    ImGui::AlignTextToFramePadding();
+    const ImVec4 color = status_error_ ? ImVec4(1.0f, 0.4f, 0.4f, 1.0f)
+                                       : ImGui::GetStyle().Colors[ImGuiCol_TextDisabled];
+    ImGui::TextColored(color, "%s", status_text_.c_str());
+  }
   ImGui::PopStyleVar(2);
   ImGui::PopStyleColor(3);
   ImGui::End();
@@ -752,18 +943,195 @@ void Application::ToggleRunPause() {
 }
 void Application::LoadSnapshot(const std::filesystem::path& path) {
   try {
-    emulator_.amiga.loadSnapshot(path);
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
+                                    std::istreambuf_iterator<char>()};
+    std::vector<uint8_t> raw;
+    if (gui::ChunkStore::IsManifest(data)) {
+      if (!chunk_store_.Read(data, raw)) {
+        SetStatus(std::format("{} refers to missing chunks", path.filename().string()), true);
+        return;
+      }
+    } else if (!gui::SnapshotWriter::IsPacked(data)) {
+      emulator_.amiga.loadSnapshot(path);
+      // The clock may jump forward, so history from the old timeline must go.
+      gui::RewindController::Instance().Clear();
+      return;
+    } else if (!gui::SnapshotWriter::Unpack(data, raw)) {
+      SetStatus(std::format("{} is damaged", path.filename().string()), true);
+      return;
+    }
+    if (!gui::RewindController::Restore(emulator_, raw)) {
+      SetStatus(std::format("Could not load {}", path.filename().string()), true);
+      return;
+    }
+    gui::RewindController::Instance().Clear();
   } catch (...) {
+    SetStatus(std::format("Could not load {}", path.filename().string()), true);
   }
 }
 void Application::SaveSnapshot(const std::filesystem::path& path) {
+  // Only the copy happens on this thread; packing and the write, including
+  // fsync, run on the writer's thread.
+  std::vector<uint8_t> data;
   try {
-    emulator_.amiga.saveSnapshot(path);
-    ManageSnapshots();
+    std::unique_ptr<vamiga::MediaFile> snapshot(emulator_.amiga.takeSnapshot());
+    const auto* bytes = snapshot->getData();
+    data.assign(bytes, bytes + snapshot->getSize());
   } catch (...) {
+    SetStatus("Could not take a snapshot", true);
+    return;
   }
+  // Snapshots saved into the library directory are indexed once written.
+  std::error_code ec;
+  const bool in_library = snapshot_library_.IsOpen() &&
+                          std::filesystem::equivalent(path.parent_path(), snapshot_library_.Dir(), ec);
+  gui::SnapshotLibrary::Entry entry;
+  if (in_library) {
+    entry.file = path.filename().string();
+    entry.title = std::filesystem::path(floppy_paths_[0]).stem().string();
+    entry.time = std::chrono::duration_cast<std::chrono::seconds>(
+                     std::chrono::system_clock::now().time_since_epoch()).count();
+    entry.thumbnail = CaptureThumbnail();
+  }
+  // Chunks live next to the library, so only library snapshots are deduplicated.
+  auto format = snapshot_compress_ ? gui::SnapshotWriter::Format::kPacked
+                                   : gui::SnapshotWriter::Format::kRaw;
+  if (in_library && snapshot_dedup_ && chunk_store_.IsOpen()) {
+    format = gui::SnapshotWriter::Format::kChunked;
+  }
+  const bool queued = snapshot_writer_.Submit(
+      std::move(data), path, format,
+      [this, in_library, entry](const gui::SnapshotWriter::Result& r) {
+        if (!r.ok) {
+          SetStatus(std::format("Saving {} failed: {}", r.path.filename().string(), r.error), true);
+          return;
+        }
+        SetStatus(std::format("Saved {} ({} KB, {:.0f} ms)", r.path.filename().string(),
+                              r.bytes / 1024, r.ms),
+                  false);
+        if (in_library) {
+          auto added = entry;
+          added.bytes = r.bytes;
+          snapshot_library_.Add(std::move(added));
+        }
+        ManageSnapshots();
+      });
+  if (!queued) SetStatus("Too many snapshots are being saved", true);
+}
+void Application::QuickSaveSnapshot() {
+  if (!snapshot_library_.IsOpen()) {
+    SetStatus("The snapshot library is not available", true);
+    return;
+  }
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now).count();
+  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count() % 1000;
+  SaveSnapshot(snapshot_library_.Dir() /
+               std::format("snap-{}-{:03}.vsn", LocalTime(seconds, "%Y%m%d-%H%M%S"), ms));
+}
+std::filesystem::path Application::SlotPath(int slot) const {
+  const char* home = std::getenv("HOME");
+  std::filesystem::path dir = home ? std::filesystem::path(home) / gui::Defaults::kConfigDir /
+                                         gui::Defaults::kAppName / gui::Defaults::kSlotsDir
+                                   : std::filesystem::path(gui::Defaults::kSlotsDir);
+  return dir / std::format("slot-{}.vsn", slot + 1);
+}
+void Application::SaveSlot(int slot) {
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    std::unique_ptr<vamiga::MediaFile> snapshot(emulator_.amiga.takeSnapshot());
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    snapshot_slots_.Store(slot, {snapshot->getData(), static_cast<std::size_t>(snapshot->getSize())},
+                          std::chrono::duration_cast<std::chrono::seconds>(now).count());
+  } catch (...) {
+    SetStatus(std::format("Could not save slot {}", slot + 1), true);
+    return;
+  }
+  const double ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  SetStatus(std::format("Saved slot {} ({:.1f} ms)", slot + 1, ms), false);
+  if (slots_persist_) {
+    const auto path = SlotPath(slot);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    snapshot_writer_.Submit(snapshot_slots_.Data(slot), path, gui::SnapshotWriter::Format::kRaw,
+                            [this, slot](const gui::SnapshotWriter::Result& r) {
+                              if (r.ok) return;
+                              SetStatus(std::format("Could not flush slot {}: {}", slot + 1, r.error),
+                                        true);
+                            });
+  }
+}
+void Application::RestoreSlot(int slot) {
+  if (gui::MoviePlayer::Instance().GetState() != gui::MoviePlayer::State::kIdle) return;
+  if (snapshot_slots_.Empty(slot) && slots_persist_) {
+    // Slots flushed in an earlier session are read back on first use.
+    const auto path = SlotPath(slot);
+    std::ifstream file(path, std::ios::binary);
+    if (file) {
+      const std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
+                                      std::istreambuf_iterator<char>()};
+      std::error_code ec;
+      const auto written = std::chrono::file_clock::to_sys(std::filesystem::last_write_time(path, ec));
+      snapshot_slots_.Store(
+          slot, data,
+          std::chrono::duration_cast<std::chrono::seconds>(written.time_since_epoch()).count());
+    }
+  }
+  if (snapshot_slots_.Empty(slot)) {
+    SetStatus(std::format("Slot {} is empty", slot + 1), true);
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  if (!gui::RewindController::Restore(emulator_, snapshot_slots_.Data(slot))) {
+    SetStatus(std::format("Could not restore slot {}", slot + 1), true);
+    return;
+  }
+  gui::RewindController::Instance().Clear();
+  const double ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  SetStatus(std::format("Restored slot {} ({:.1f} ms)", slot + 1, ms), false);
+}
+std::vector<uint8_t> Application::CaptureThumbnail() {
+  std::vector<uint32_t> thumbnail;
+  emulator_.videoPort.lockTexture();
+  const uint32_t* pixels = emulator_.videoPort.getTexture();
+  if (pixels) {
+    thumbnail = gui::SnapshotLibrary::MakeThumbnail(
+        {pixels, static_cast<std::size_t>(vamiga::HPIXELS * vamiga::VPIXELS)}, vamiga::HPIXELS,
+        vamiga::VPIXELS);
+  }
+  emulator_.videoPort.unlockTexture();
+  return thumbnail.empty() ? std::vector<uint8_t>() : gui::SnapshotLibrary::PackThumbnail(thumbnail);
+}
+void Application::SetStatus(std::string text, bool error) {
+  status_text_ = std::move(text);
+  status_error_ = error;
+  status_until_ = SDL_GetTicks64() + (error ? 8000 : 4000);
+}
+void Application::OpenSnapshotLibrary() {
+  const char* home = std::getenv("HOME");
+  std::filesystem::path dir = home ? std::filesystem::path(home) / gui::Defaults::kConfigDir /
+                                         gui::Defaults::kAppName / gui::Defaults::kSnapshotsDir
+                                   : std::filesystem::path(gui::Defaults::kSnapshotsDir);
+  if (!snapshot_library_.Open(dir)) {
+    std::println(std::cerr, "Failed to open snapshot library in {}", dir.string());
+    return;
+  }
+  if (chunk_store_.Open(dir / gui::Defaults::kChunksDir, dir)) {
+    snapshot_writer_.SetChunkStore(&chunk_store_);
+    // Picks up chunks orphaned by snapshots deleted in the last session.
+    chunk_store_.CollectAsync();
+  }
+  ManageSnapshots();
 }
 void Application::ManageSnapshots() {
+  // Entries are kept oldest first, so this only touches the overflow.
+  if (!snapshot_auto_delete_ || !snapshot_library_.IsOpen()) return;
+  if (snapshot_library_.Trim(gui::Defaults::kSnapshotLimit) > 0 && chunk_store_.IsOpen()) {
+    chunk_store_.CollectAsync();
+  }
 }
 void Application::TakeScreenshot() {
     int w = vamiga::HPIXELS;
@@ -10,6 +10,10 @@
 #include "VAmiga.h"
 #include "components/input_manager.h"
 #include "services/config_provider.h"
+#include "services/chunk_store.h"
+#include "services/snapshot_library.h"
+#include "services/snapshot_slots.h"
+#include "services/snapshot_writer.h"
 struct SDLWindowDeleter {
   void operator()(SDL_Window* w) const {
     if (w) SDL_DestroyWindow(w);
@@ -37,6 +41,12 @@ class Application {
   void ToggleRunPause();
   void LoadSnapshot(const std::filesystem::path& path);
   void SaveSnapshot(const std::filesystem::path& path);
+  // Saves into the snapshot library under a time-stamped name.
+  void QuickSaveSnapshot();
+  // Quick-save slots live in memory; with slots_persist_ they are also
+  // flushed to disk in the background.
+  void SaveSlot(int slot);
+  void RestoreSlot(int slot);
   void TakeScreenshot();
   vamiga::VAmiga& GetEmulator() { return emulator_; }
   SDL_Window* GetWindow() { return window_.get(); }
@@ -56,6 +66,12 @@ class Application {
   void DrawDriveMenu(int drive_index);
   void DrawHardDriveMenu(int drive_index);
   void ManageSnapshots();
+  void OpenSnapshotLibrary();
+  std::vector<uint8_t> CaptureThumbnail();
+  std::filesystem::path SlotPath(int slot) const;
+  void SetStatus(std::string text, bool error);
+  void ApplyLogSettings();
+  void ApplyRewindSettings();
   std::string_view GetDeviceIcon(int device_id);
   void DrawPortDeviceSelection(int port_idx, int& device_id);
   SDLWindowPtr window_;
@@ -69,6 +85,9 @@ class Application {
   bool show_dashboard_ = false;
   bool show_console_ = false;
   bool show_keyboard_ = false;
+  bool show_latency_ = false;
+  bool show_movie_ = false;
+  bool show_snapshots_ = false;
   bool show_ui_ = true;
   bool video_as_background_ = true;
   bool is_fullscreen_ = false;
@@ -91,7 +110,24 @@ class Application {
   int port1_device_ = 1;
   int port2_device_ = 2;
   bool snapshot_auto_delete_ = true;
+  bool snapshot_compress_ = false;
+  bool snapshot_dedup_ = false;
+  bool slots_persist_ = false;
   int screenshot_format_ = 0;
   int screenshot_source_ = 0;
+  bool log_enabled_ = false;
+  int log_max_kb_ = 4096;
+  int log_max_files_ = 5;
+  bool log_compress_ = true;
+  bool rewind_enabled_ = true;
+  int rewind_interval_ = 10;
+  int rewind_budget_mb_ = 64;
+  gui::ChunkStore chunk_store_;
+  gui::SnapshotWriter snapshot_writer_;
+  gui::SnapshotLibrary snapshot_library_;
+  gui::SnapshotSlots snapshot_slots_;
+  std::string status_text_;
+  bool status_error_ = false;
+  uint64_t status_until_ = 0;
 };
 #endif
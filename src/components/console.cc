@@ -202,6 +202,60 @@ bool Console::HandleEvent(const SDL_Event& event, vamiga::VAmiga& emu) {
   return false;
 }
 
+void Console::IndexText(std::string_view text, int console) {
+  const bool stale =
+      line_offsets_.empty() || console != indexed_console_ ||
+      text.size() < indexed_size_ ||
+      text.substr(0, first_line_.size()) != first_line_ ||
+      (line_offsets_.back() > 0 && text[line_offsets_.back() - 1] != '\n');
+  if (stale) {
+    line_offsets_.assign(1, 0);
+    indexed_console_ = console;
+  }
+
+  // The last line may still be edited in place (prompt), so rescan it.
+  for (size_t i = text.find('\n', line_offsets_.back()); i != std::string_view::npos;
+       i = text.find('\n', i + 1)) {
+    line_offsets_.push_back(i + 1);
+  }
+  indexed_size_ = text.size();
+
+  static constexpr size_t kFingerprint = 64;
+  size_t first_end = line_offsets_.size() > 1 ? line_offsets_[1] : text.size();
+  first_line_.assign(text.substr(0, std::min(first_end, kFingerprint)));
+}
+
+bool Console::OpenLog(const std::filesystem::path& path, const LogWriter::Options& options) {
+  if (!log_.Open(path, options)) return false;
+  // The first update after opening logs the whole buffer.
+  transcript_.Reset();
+  logged_line_ = 0;
+  return true;
+}
+
+void Console::CloseLog() { log_.Close(); }
+
+void Console::Update(vamiga::VAmiga& emu) {
+  if (!log_.IsOpen()) return;
+  const char* text = emu.retroShell.text();
+  transcript_.Update(text ? text : "");
+
+  // Lines that scrolled out before we saw them are gone; skip past them.
+  logged_line_ = std::max(logged_line_, transcript_.FirstLine());
+  for (; logged_line_ < transcript_.CompleteLines(); ++logged_line_) {
+    log_.Write(std::string(transcript_.Line(logged_line_)));
+  }
+}
+
+void Console::UpdateGlyphMetrics() {
+  const ImFont* font = ImGui::GetFont();
+  const float size = ImGui::GetFontSize();
+  if (font == glyph_font_ && size == glyph_font_size_) return;
+  glyph_font_ = font;
+  glyph_font_size_ = size;
+  glyph_width_ = ImGui::CalcTextSize("M").x;
+}
+
 void Console::Draw(bool* p_open, vamiga::VAmiga& emu) {
   if (!p_open || !*p_open) return;
 
@@ -240,52 +294,44 @@ void Console::Draw(bool* p_open, vamiga::VAmiga& emu) {
                     false,
                     ImGuiWindowFlags_HorizontalScrollbar);
 
-  // Compute cursor highlight position (relative to end of text).
-  const int cursor_idx =
-      std::clamp<int>(static_cast<int>(console_text.size() + info.cursorRel),
-                      0, static_cast<int>(console_text.size()));
+  IndexText(console_text, console_idx);
+  UpdateGlyphMetrics();
+
+  // Cursor position is relative to the end of the text.
+  const size_t cursor_idx = static_cast<size_t>(
+      std::clamp<long>(static_cast<long>(console_text.size() + info.cursorRel),
+                       0, static_cast<long>(console_text.size())));
+  const int cursor_line = static_cast<int>(
+      std::upper_bound(line_offsets_.begin(), line_offsets_.end(), cursor_idx) -
+      line_offsets_.begin() - 1);
+  const float cursor_x =
+      static_cast<float>(cursor_idx - line_offsets_[static_cast<size_t>(cursor_line)]) * glyph_width_;
 
   ImDrawList* draw_list = ImGui::GetWindowDrawList();
-  const ImVec2 start_pos = ImGui::GetCursorScreenPos();
-  ImVec2 pos = start_pos;
   const float line_height = ImGui::GetTextLineHeight();
-  ImVec2 highlight_min = pos;
-  ImVec2 highlight_max = pos;
-  bool have_cursor = false;
-
-  for (int i = 0; i <= static_cast<int>(console_text.size()); ++i) {
-    if (i == cursor_idx) {
-      have_cursor = true;
-      highlight_min = pos;
-      const ImVec2 char_size =
-          ImGui::CalcTextSize(i < static_cast<int>(console_text.size())
-                                  ? &console_text[i]
-                                  : " ",
-                              i < static_cast<int>(console_text.size())
-                                  ? &console_text[i] + 1
-                                  : nullptr);
-      highlight_max = ImVec2(pos.x + char_size.x, pos.y + line_height);
-    }
-
-    if (i == static_cast<int>(console_text.size())) break;
-
-    const char c = console_text[i];
-    if (c == '\n') {
-      pos.x = start_pos.x;
-      pos.y += line_height;
-    } else {
-      const ImVec2 char_size = ImGui::CalcTextSize(&c, &c + 1);
-      pos.x += char_size.x;
+  const int line_count = static_cast<int>(line_offsets_.size());
+
+  ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing,
+                      ImVec2(ImGui::GetStyle().ItemSpacing.x, 0.0f));
+  ImGuiListClipper clipper;
+  clipper.Begin(line_count, line_height);
+  while (clipper.Step()) {
+    for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line) {
+      const size_t first = line_offsets_[static_cast<size_t>(line)];
+      const size_t last = line + 1 < line_count
+                              ? line_offsets_[static_cast<size_t>(line) + 1] - 1
+                              : console_text.size();
+      if (line == cursor_line) {
+        const ImVec2 p = ImGui::GetCursorScreenPos();
+        draw_list->AddRectFilled(ImVec2(p.x + cursor_x, p.y),
+                                 ImVec2(p.x + cursor_x + glyph_width_, p.y + line_height),
+                                 ImGui::GetColorU32(cursor_color));
+      }
+      ImGui::TextUnformatted(console_text.data() + first, console_text.data() + last);
     }
   }
-
-  if (have_cursor) {
-    draw_list->AddRectFilled(
-        highlight_min, highlight_max, ImGui::GetColorU32(cursor_color));
-  }
-
-  ImGui::TextUnformatted(console_text.data(),
-                         console_text.data() + console_text.size());
+  clipper.End();
+  ImGui::PopStyleVar();
 
   if (console_text.size() != last_text_size_) {
     ImGui::SetScrollHereY(1.0f);
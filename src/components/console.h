@@ -1,9 +1,12 @@
 #ifndef LINUXGUI_COMPONENTS_CONSOLE_H_
 #define LINUXGUI_COMPONENTS_CONSOLE_H_
 
+#include <deque>
+#include <filesystem>
 #include <format>
 #include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <SDL.h>
@@ -11,6 +14,10 @@
 #include "VAmiga.h"
 #undef unreachable
 #define unreachable std::unreachable()
+#include "services/log_writer.h"
+#include "services/shell_transcript.h"
+
+struct ImFont;
 
 namespace gui {
 
@@ -19,14 +26,22 @@ class Console {
   static Console& Instance();
 
   void Draw(bool* p_open, vamiga::VAmiga& emu);
+  // Tees new RetroShell output to the log file; call once per frame.
+  void Update(vamiga::VAmiga& emu);
   bool HandleEvent(const SDL_Event& event, vamiga::VAmiga& emu);
 
   template <typename... Args>
   void AddLog(std::format_string<Args...> fmt, Args&&... args) {
     items_.push_back(std::format(fmt, std::forward<Args>(args)...));
+    if (items_.size() > kMaxItems) items_.pop_front();
+    if (log_.IsOpen()) log_.Write(items_.back());
     scroll_to_bottom_ = true;
   }
 
+  bool OpenLog(const std::filesystem::path& path, const LogWriter::Options& options);
+  void CloseLog();
+  const LogWriter& Log() const { return log_; }
+
   void SetCommandCallback(std::function<void(const std::string&)> cb);
 
   void ExecCommand(std::string_view command_line);
@@ -35,8 +50,10 @@ class Console {
  private:
   Console();
 
+  static constexpr std::size_t kMaxItems = 1000;
+
   std::vector<char> input_buf_;
-  std::vector<std::string> items_;
+  std::deque<std::string> items_;
   bool scroll_to_bottom_;
   std::vector<std::string> history_;
   int history_pos_;
@@ -45,8 +62,28 @@ class Console {
   std::function<void(const std::string&)> command_callback_;
   std::string retro_shell_current_text_;
 
+  void IndexText(std::string_view text, int console);
+  void UpdateGlyphMetrics();
+
   bool has_focus_ = false;
   size_t last_text_size_ = 0;
+
+  // Start offsets of every line in the RetroShell text. Only the tail is
+  // rescanned when text arrives; a cleared or scrolled buffer rebuilds it.
+  std::vector<size_t> line_offsets_;
+  size_t indexed_size_ = 0;
+  int indexed_console_ = -1;
+  std::string first_line_;
+
+  LogWriter log_;
+  // Numbers shell lines across scrolling; logged_line_ is the absolute
+  // number of the next line to write.
+  ShellTranscript transcript_;
+  uint64_t logged_line_ = 0;
+
+  const ImFont* glyph_font_ = nullptr;
+  float glyph_font_size_ = 0.0f;
+  float glyph_width_ = 0.0f;
 };
 
 }
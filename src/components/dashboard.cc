@@ -5,6 +5,7 @@
 #include <format>
 #include <string>
 #include "imgui.h"
+#include "components/logic_analyzer.h"
 namespace gui {
 Dashboard& Dashboard::Instance() {
   static Dashboard instance;
@@ -53,6 +54,69 @@ void Dashboard::DrawPlot(std::string_view label, const std::vector<float>& data,
                    overlay_text.empty() ? nullptr : overlay_text.data(), min, max,
                    ImVec2(0, 80));
 }
+void Dashboard::DrawBusUsage() {
+  using LA = LogicAnalyzer;
+  const auto& history = LA::Instance().BusHistory();
+  const int count = static_cast<int>(history.size());
+  const int groups = static_cast<int>(LA::kBusGroups);
+
+  ImVec2 size(ImGui::GetContentRegionAvail().x, 100.0f);
+  ImVec2 p0 = ImGui::GetCursorScreenPos();
+  ImGui::InvisibleButton("##bus_usage", size);
+  ImDrawList* dl = ImGui::GetWindowDrawList();
+  dl->AddRectFilled(p0, ImVec2(p0.x + size.x, p0.y + size.y), IM_COL32(20, 20, 20, 255));
+
+  // Stacked areas: each group is drawn between the running sums of the
+  // groups below it, one quad per pair of neighbouring frames.
+  float dx = size.x / static_cast<float>(std::max(count - 1, 1));
+  for (int i = 0; i + 1 < count; ++i) {
+    const auto& a = history[static_cast<std::size_t>(i)];
+    const auto& b = history[static_cast<std::size_t>(i + 1)];
+    if (a.samples == 0 || b.samples == 0) continue;
+    float x0 = p0.x + dx * static_cast<float>(i);
+    float x1 = x0 + dx;
+    float sum_a = 0.0f, sum_b = 0.0f;
+    for (int g = 0; g < groups; ++g) {
+      float next_a = sum_a + a.share[static_cast<std::size_t>(g)];
+      float next_b = sum_b + b.share[static_cast<std::size_t>(g)];
+      dl->AddQuadFilled(ImVec2(x0, p0.y + size.y * (1.0f - sum_a)),
+                        ImVec2(x1, p0.y + size.y * (1.0f - sum_b)),
+                        ImVec2(x1, p0.y + size.y * (1.0f - next_b)),
+                        ImVec2(x0, p0.y + size.y * (1.0f - next_a)), LA::BusGroupColor(g));
+      sum_a = next_a;
+      sum_b = next_b;
+    }
+  }
+
+  if (ImGui::IsItemHovered() && count > 0) {
+    int i = std::clamp(static_cast<int>((ImGui::GetIO().MousePos.x - p0.x) / dx + 0.5f), 0, count - 1);
+    const auto& u = history[static_cast<std::size_t>(i)];
+    if (u.samples > 0 && ImGui::BeginTooltip()) {
+      ImGui::Text("Frame %lld (%u DMA cycles)", static_cast<long long>(u.frame), u.samples);
+      for (int g = 0; g < groups; ++g) {
+        ImGui::Text("%-8s %5.1f%%", LA::BusGroupName(g).data(), u.share[static_cast<std::size_t>(g)] * 100.0f);
+      }
+      ImGui::EndTooltip();
+    }
+  }
+
+  const auto& last = history.back();
+  if (last.samples == 0) {
+    ImGui::TextDisabled("No bus data. Start a capture in the logic analyzer; only completely "
+                        "captured frames are counted.");
+    return;
+  }
+  for (int g = 0; g < groups; ++g) {
+    if (g % 3 != 0) ImGui::SameLine(static_cast<float>(g % 3) * size.x / 3.0f);
+    ImVec2 c = ImGui::GetCursorScreenPos();
+    float h = ImGui::GetTextLineHeight();
+    dl->AddRectFilled(c, ImVec2(c.x + h, c.y + h), LA::BusGroupColor(g));
+    ImGui::Dummy(ImVec2(h, h));
+    ImGui::SameLine();
+    ImGui::Text("%s %.0f%%", LA::BusGroupName(g).data(), last.share[static_cast<std::size_t>(g)] * 100.0f);
+  }
+}
+
 void Dashboard::Draw(bool* p_open, vamiga::VAmiga& emu) {
   if (!p_open || !*p_open) return;
 
@@ -77,6 +141,10 @@ void Dashboard::Draw(bool* p_open, vamiga::VAmiga& emu) {
       DrawPlot("##fast", fast_ram_activity_, 0.0f, FLT_MAX);
     }
 
+    if (ImGui::CollapsingHeader("Bus Usage", ImGuiTreeNodeFlags_DefaultOpen)) {
+      DrawBusUsage();
+    }
+
     if (ImGui::CollapsingHeader("Audio", ImGuiTreeNodeFlags_DefaultOpen)) {
       std::string buf =
           std::format("Buffer: {:.1f}%", audio_buffer_fill_.back());
@@ -30,6 +30,8 @@ class Dashboard {
 
                   float max, std::string_view overlay_text = "");
 
+    void DrawBusUsage();
+
     static constexpr int kHistorySize = 100;
 
     std::vector<float> cpu_load_;
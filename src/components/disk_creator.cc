@@ -1,5 +1,7 @@
 #include "disk_creator.h"
+#include <algorithm>
 #include <format>
+#include "services/snapshot_writer.h"
 #include "FloppyDriveTypes.h"
 #include "HardDriveTypes.h"
 #include "FSTypes.h"
@@ -40,6 +42,7 @@ void DiskCreator::OpenForFloppy(int drive_nr) {
     floppy_fs_ = 0; 
     floppy_boot_ = 1; 
     floppy_label_ = "Empty";
+    import_error_.clear();
     open_ = true;
 }
 
@@ -48,6 +51,7 @@ void DiskCreator::OpenForHardDisk(int drive_nr) {
     is_hard_disk_ = true;
     UpdateHDCapacity();
     hd_label_ = "System";
+    import_error_.clear();
     open_ = true;
 }
 
@@ -110,6 +114,15 @@ void DiskCreator::Draw(vamiga::VAmiga& emu) {
                 ImGui::InputText("Label", &hd_label_);
             }
         }
+        const bool dos = is_hard_disk_ ? hd_fs_ != 0 : floppy_fs_ != 2;
+        if (dos) {
+            ImGui::InputText("Import Folder", &import_folder_);
+            ImGui::SameLine();
+            ImGui::TextDisabled("(optional)");
+        }
+        if (!import_error_.empty()) {
+            ImGui::TextColored(ImVec4(0.90f, 0.25f, 0.25f, 1.0f), "%s", import_error_.c_str());
+        }
         
         ImGui::Separator();
         if (ImGui::Button("Cancel")) {
@@ -117,15 +130,77 @@ void DiskCreator::Draw(vamiga::VAmiga& emu) {
         }
         ImGui::SameLine();
         if (ImGui::Button(is_hard_disk_ ? "Create & Attach" : "Create & Insert")) {
-            if (is_hard_disk_) CreateHardDisk(emu);
-            else CreateFloppy(emu);
-            ImGui::CloseCurrentPopup();
+            import_error_.clear();
+            // A failed import keeps the dialog open with the reason.
+            if (is_hard_disk_ ? CreateHardDisk(emu) : CreateFloppy(emu)) {
+                ImGui::CloseCurrentPopup();
+            }
         }
         ImGui::EndPopup();
     }
 }
 
-void DiskCreator::CreateFloppy(vamiga::VAmiga& emu) {
+std::filesystem::path DiskCreator::ImagePath(const std::filesystem::path& folder,
+                                            const char* extension) {
+    auto dir = folder;
+    if (!dir.has_filename()) dir = dir.parent_path();
+    return dir.parent_path() / (dir.filename().string() + extension);
+}
+
+std::filesystem::path DiskCreator::UnusedImagePath(const std::filesystem::path& folder,
+                                                  const char* extension) {
+    // The image is renamed into place, which would silently replace an
+    // existing one; number the new image instead.
+    const auto path = ImagePath(folder, extension);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) return path;
+    const auto stem = path.parent_path() / path.stem();
+    for (int i = 2;; ++i) {
+        auto candidate = stem;
+        candidate += std::format("-{}{}", i, extension);
+        if (!std::filesystem::exists(candidate, ec)) return candidate;
+    }
+}
+
+bool DiskCreator::WriteImage(const VolumeBuilder& builder, const VolumeBuilder::Options& options,
+                             const std::filesystem::path& target, std::string& error) {
+    std::vector<uint8_t> image;
+    if (!builder.Build(options, image, error)) return false;
+    return SnapshotWriter::WriteAtomically(target, image, error);
+}
+
+std::optional<DiskCreator::Import> DiskCreator::ImportFolder(const std::filesystem::path& folder,
+                                                             std::string& error) {
+    VolumeBuilder builder;
+    if (!builder.Scan(folder, error)) return std::nullopt;
+
+    Import result;
+    result.stats = builder.GetStats();
+    VolumeBuilder::Options options;
+    options.bootable = true;
+    options.label = ImagePath(folder, "").filename().string();
+    if (builder.BlocksNeeded(options) <= options.num_blocks) {
+        result.image = UnusedImagePath(folder, ".adf");
+    } else {
+        // Same geometry rules as the dialog, with a quarter to spare and
+        // at least the smallest preset.
+        const uint64_t blocks = std::max<uint64_t>(builder.BlocksNeeded(options) * 5 / 4, 20480);
+        int s = 32, h = 1;
+        uint64_t c = (blocks + s - 1) / s;
+        while (c > 1024 && h < 16) {
+            c = (c + 1) / 2;
+            h *= 2;
+        }
+        options.num_blocks = static_cast<uint32_t>(c * h * s);
+        options.bootable = false;
+        result.hard_disk = true;
+        result.image = UnusedImagePath(folder, ".hdf");
+    }
+    if (!WriteImage(builder, options, result.image, error)) return std::nullopt;
+    return result;
+}
+
+bool DiskCreator::CreateFloppy(vamiga::VAmiga& emu) {
     vamiga::FSFormat fs;
     switch(floppy_fs_) {
         case 0: fs = vamiga::FSFormat::OFS; break;
@@ -141,10 +216,52 @@ void DiskCreator::CreateFloppy(vamiga::VAmiga& emu) {
         }
     }
     
+    if (!import_folder_.empty() && fs != vamiga::FSFormat::NODOS) {
+        VolumeBuilder builder;
+        VolumeBuilder::Options options;
+        options.num_blocks = floppy_type_ == 0 ? 1760 : 3520;
+        options.ffs = fs == vamiga::FSFormat::FFS;
+        options.bootable = bb != vamiga::BootBlockId::NONE;
+        options.label = floppy_label_;
+        const auto target = UnusedImagePath(import_folder_, ".adf");
+        if (!builder.Scan(import_folder_, import_error_) ||
+            !WriteImage(builder, options, target, import_error_)) {
+            return false;
+        }
+        try {
+            emu.df[target_drive_nr_]->insert(target, false);
+        } catch (...) {
+            import_error_ = "Cannot insert " + target.string();
+            return false;
+        }
+        return true;
+    }
+
     emu.df[target_drive_nr_]->insertBlankDisk(fs, bb, floppy_label_.c_str());
+    return true;
 }
 
-void DiskCreator::CreateHardDisk(vamiga::VAmiga& emu) {
+bool DiskCreator::CreateHardDisk(vamiga::VAmiga& emu) {
+    if (!import_folder_.empty() && hd_fs_ != 0) {
+        VolumeBuilder builder;
+        VolumeBuilder::Options options;
+        options.num_blocks = static_cast<uint32_t>(std::max(hd_c_ * hd_h_ * hd_s_, 0));
+        options.ffs = hd_fs_ == 2;
+        options.label = hd_label_;
+        const auto target = UnusedImagePath(import_folder_, ".hdf");
+        if (!builder.Scan(import_folder_, import_error_) ||
+            !WriteImage(builder, options, target, import_error_)) {
+            return false;
+        }
+        try {
+            emu.hd[target_drive_nr_]->attach(target);
+        } catch (...) {
+            import_error_ = "Cannot attach " + target.string();
+            return false;
+        }
+        return true;
+    }
+
     try {
         emu.hd[target_drive_nr_]->attach(hd_c_, hd_h_, hd_s_, 512);
         
@@ -156,6 +273,7 @@ void DiskCreator::CreateHardDisk(vamiga::VAmiga& emu) {
         
     } catch (...) {
     }
+    return true;
 }
 
 }
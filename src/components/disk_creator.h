@@ -10,7 +10,10 @@
 #define unreachable std::unreachable()
 #endif
 #include "imgui.h"
+#include <filesystem>
+#include <optional>
 #include <string>
+#include "services/volume_builder.h"
 
 namespace gui {
 
@@ -21,6 +24,17 @@ public:
     void OpenForFloppy(int drive_nr);
     void OpenForHardDisk(int drive_nr);
 
+    struct Import {
+        std::filesystem::path image;
+        bool hard_disk = false;
+        VolumeBuilder::Stats stats;
+    };
+    // Builds a bootable FFS ADF from a host folder, or an HDF when the
+    // tree does not fit on a floppy, and writes it next to the folder
+    // without replacing an existing image.
+    static std::optional<Import> ImportFolder(const std::filesystem::path& folder,
+                                              std::string& error);
+
 private:
     DiskCreator();
     
@@ -39,10 +53,21 @@ private:
     int hd_s_ = 0;
     int hd_fs_ = 2; 
     std::string hd_label_ = "System";
+
+    // Populates the new volume when set.
+    std::string import_folder_;
+    std::string import_error_;
     
     void UpdateHDCapacity();
-    void CreateFloppy(vamiga::VAmiga& emu);
-    void CreateHardDisk(vamiga::VAmiga& emu);
+    bool CreateFloppy(vamiga::VAmiga& emu);
+    bool CreateHardDisk(vamiga::VAmiga& emu);
+    static std::filesystem::path ImagePath(const std::filesystem::path& folder,
+                                           const char* extension);
+    // Like ImagePath(), but never the name of an existing file.
+    static std::filesystem::path UnusedImagePath(const std::filesystem::path& folder,
+                                                 const char* extension);
+    static bool WriteImage(const VolumeBuilder& builder, const VolumeBuilder::Options& options,
+                           const std::filesystem::path& target, std::string& error);
 };
 
 }
@@ -1,8 +1,10 @@
 #include "disk_inspector.h"
 #include <algorithm>
+#include <chrono>
 #include <format>
 #include <cmath>
 #include <ranges>
+#include <string>
 #include "resources/IconsFontAwesome6.h"
 
 namespace gui {
@@ -19,6 +21,13 @@ void DiskInspector::Open(int drive_nr, bool is_hd, vamiga::VAmiga& emu) {
     open_ = true;
 }
 
+DiskInspector::~DiskInspector() { Stop(); }
+
+void DiskInspector::Stop() {
+    StopDecoding();
+    StopVerify();
+}
+
 void DiskInspector::UpdateMedia(vamiga::VAmiga& emu) {
     media_.reset();
     
@@ -43,6 +52,62 @@ void DiskInspector::UpdateMedia(vamiga::VAmiga& emu) {
     
     current_block_ = 0;
     UpdateSelectionFromBlock();
+
+    StopDecoding();
+    StopVerify();
+    verify_report_.reset();
+    {
+        std::lock_guard lock(tracks_mutex_);
+        tracks_.assign(is_hd_ ? 0 : static_cast<size_t>(num_tracks_), nullptr);
+    }
+    decoded_ = 0;
+    if (!is_hd_ && media_) StartDecoding(emu);
+}
+
+void DiskInspector::StartDecoding(vamiga::VAmiga& emu) {
+    stop_decoding_ = false;
+    decoder_ = std::thread([this, &emu, drive = drive_nr_, count = num_tracks_] {
+        for (int t = 0; t < count && !stop_decoding_; ++t) {
+            {
+                std::lock_guard lock(tracks_mutex_);
+                if (tracks_[static_cast<size_t>(t)]) continue;
+            }
+            // The GUI may have decoded it on demand meanwhile.
+            CacheTrack(t, std::make_shared<const MfmTrack>(
+                              MfmTrack::Decode(ReadTrackBits(emu, drive, t))));
+        }
+    });
+}
+
+void DiskInspector::StopDecoding() {
+    stop_decoding_ = true;
+    if (decoder_.joinable()) decoder_.join();
+}
+
+std::shared_ptr<const MfmTrack> DiskInspector::Track(vamiga::VAmiga& emu, int track) {
+    {
+        std::lock_guard lock(tracks_mutex_);
+        if (track < 0 || track >= static_cast<int>(tracks_.size())) return nullptr;
+        if (auto cached = tracks_[static_cast<size_t>(track)]) return cached;
+    }
+    return CacheTrack(track, std::make_shared<const MfmTrack>(
+                                 MfmTrack::Decode(ReadTrackBits(emu, drive_nr_, track))));
+}
+
+std::shared_ptr<const MfmTrack> DiskInspector::CacheTrack(int track,
+                                                          std::shared_ptr<const MfmTrack> decoded) {
+    std::lock_guard lock(tracks_mutex_);
+    auto& slot = tracks_[static_cast<size_t>(track)];
+    if (!slot) {
+        slot = std::move(decoded);
+        ++decoded_;
+    }
+    return slot;
+}
+
+std::string DiskInspector::ReadTrackBits(vamiga::VAmiga& emu, int drive, int track) {
+    std::lock_guard lock(read_mutex_);
+    return emu.df[drive]->readTrackBits(track);
 }
 
 void DiskInspector::UpdateSelectionFromBlock() {
@@ -78,7 +143,10 @@ void DiskInspector::Draw(vamiga::VAmiga& emu) {
         
         if (!media_) {
             ImGui::Text("No media inserted or attached.");
-            if (ImGui::Button("Close")) ImGui::CloseCurrentPopup();
+            if (ImGui::Button("Close")) {
+                StopDecoding();
+                ImGui::CloseCurrentPopup();
+            }
             ImGui::EndPopup();
             return;
         }
@@ -97,11 +165,19 @@ void DiskInspector::Draw(vamiga::VAmiga& emu) {
                 DrawMFMView(emu);
                 ImGui::EndTabItem();
             }
+            if (ImGui::BeginTabItem("Verify")) {
+                DrawVerify(emu);
+                ImGui::EndTabItem();
+            }
             ImGui::EndTabBar();
         }
         
         ImGui::Separator();
-        if (ImGui::Button("Close")) ImGui::CloseCurrentPopup();
+        if (ImGui::Button("Close")) {
+            StopDecoding();
+            StopVerify();
+            ImGui::CloseCurrentPopup();
+        }
         
         ImGui::EndPopup();
     }
@@ -201,21 +277,240 @@ void DiskInspector::DrawBlockView() {
     }
 }
 
+namespace {
+ImVec4 RegionColor(const MfmTrack& track, const MfmTrack::Span& span) {
+    const bool bad = span.sector >= 0 && [&] {
+        const auto& sector = track.Sectors()[static_cast<size_t>(span.sector)];
+        return span.region == MfmTrack::Region::kData ? !sector.data_ok : !sector.header_ok;
+    }();
+    switch (span.region) {
+        case MfmTrack::Region::kSync: return ImVec4(0.98f, 0.40f, 0.98f, 1.0f);
+        case MfmTrack::Region::kHeader:
+            return bad ? ImVec4(0.90f, 0.25f, 0.25f, 1.0f) : ImVec4(0.40f, 0.66f, 1.0f, 1.0f);
+        case MfmTrack::Region::kData:
+            return bad ? ImVec4(0.95f, 0.55f, 0.30f, 1.0f) : ImVec4(0.52f, 0.93f, 0.52f, 1.0f);
+        case MfmTrack::Region::kGap: break;
+    }
+    return ImVec4(0.60f, 0.60f, 0.60f, 1.0f);
+}
+}  // namespace
+
 void DiskInspector::DrawMFMView(vamiga::VAmiga& emu) {
-    ImGui::Text("MFM Track Data (Track %d)", current_track_);
-    ImGui::BeginChild("MFMScroll", ImVec2(0, 300), true);
-    
-    std::string mfm = emu.df[drive_nr_]->readTrackBits(current_track_);
-    if (mfm.empty()) {
+    const auto track = Track(emu, current_track_);
+    if (!track || track->BitCount() == 0) {
         ImGui::TextDisabled("No MFM data available");
-    } else {
-        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[0]); 
-        
-        ImGui::TextWrapped("%s", mfm.c_str());
-        
-        ImGui::PopFont();
+        return;
+    }
+    ImGui::Text("Track %d: %zu bits, %zu sectors, %d bad", current_track_, track->BitCount(),
+                track->Sectors().size(), track->BadSectors());
+    ImGui::SameLine();
+    if (decoded_ < num_tracks_) {
+        ImGui::TextDisabled("(decoded %d/%d tracks)", decoded_.load(), num_tracks_);
+        ImGui::SameLine();
+    }
+    if (ImGui::SmallButton(ICON_FA_ROTATE " Re-read")) {
+        UpdateMedia(emu);
+        return;
+    }
+    DrawSectorBar(*track);
+    DrawBitstream(*track);
+}
+
+void DiskInspector::DrawSectorBar(const MfmTrack& track) {
+    // The whole track at a glance; clicking a sector scrolls to it.
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float width = ImGui::GetContentRegionAvail().x;
+    const float height = 16.0f;
+    ImGui::InvisibleButton("SectorBar", ImVec2(width, height));
+    auto* draw = ImGui::GetWindowDrawList();
+    const float scale = width / static_cast<float>(track.BitCount());
+    for (const auto& span : track.Spans()) {
+        const float x0 = origin.x + static_cast<float>(span.begin) * scale;
+        const float x1 = origin.x + static_cast<float>(span.end) * scale;
+        draw->AddRectFilled(ImVec2(x0, origin.y), ImVec2(std::max(x1, x0 + 1.0f), origin.y + height),
+                            ImGui::ColorConvertFloat4ToU32(RegionColor(track, span)));
+    }
+    if (!ImGui::IsItemHovered()) return;
+    const auto bit = static_cast<size_t>(
+        std::clamp((ImGui::GetIO().MousePos.x - origin.x) / scale, 0.0f,
+                   static_cast<float>(track.BitCount() - 1)));
+    const auto& span = track.SpanAt(bit);
+    if (span.sector < 0) {
+        ImGui::SetTooltip("Gap (bit %zu)", bit);
+        return;
+    }
+    const auto& sector = track.Sectors()[static_cast<size_t>(span.sector)];
+    ImGui::SetTooltip("Sector %d (track %d)\nHeader: %s\nData: %s", sector.sector, sector.track,
+                      sector.header_ok ? "OK" : "checksum error",
+                      sector.data_ok ? "OK" : "checksum error");
+    if (ImGui::IsItemClicked()) {
+        scroll_to_bit_ = static_cast<long long>(sector.sync_bit);
+        current_sector_ = std::clamp(sector.sector, 0, std::max(num_sectors_ - 1, 0));
+        UpdateSelectionFromGeometry();
+    }
+}
+
+void DiskInspector::DrawBitstream(const MfmTrack& track) {
+    ImGui::BeginChild("MFMScroll", ImVec2(0, 300), true);
+    ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[0]);
+    const float row_height = ImGui::GetTextLineHeightWithSpacing();
+    const int rows = static_cast<int>((track.BitCount() + kBitsPerRow - 1) / kBitsPerRow);
+    if (scroll_to_bit_ >= 0) {
+        ImGui::SetScrollY(static_cast<float>(scroll_to_bit_ / kBitsPerRow) * row_height);
+        scroll_to_bit_ = -1;
+    }
+    // Only visible rows are drawn, one run of text per region.
+    std::string run;
+    ImGuiListClipper clipper;
+    clipper.Begin(rows, row_height);
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            size_t bit = static_cast<size_t>(row) * kBitsPerRow;
+            const size_t end = std::min(bit + kBitsPerRow, track.BitCount());
+            ImGui::TextDisabled("%06zu", bit);
+            bool first = true;
+            while (bit < end) {
+                const auto& span = track.SpanAt(bit);
+                const size_t stop = std::min(end, span.end);
+                run.clear();
+                for (; bit < stop; ++bit) run.push_back(track.Bit(bit) ? '1' : '0');
+                ImGui::SameLine(0.0f, first ? -1.0f : 0.0f);
+                first = false;
+                ImGui::TextColored(RegionColor(track, span), "%s", run.c_str());
+            }
+        }
     }
+    ImGui::PopFont();
     ImGui::EndChild();
 }
 
+void DiskInspector::StartVerify(vamiga::VAmiga& emu) {
+    StopVerify();
+    verify_report_.reset();
+    // An extended ADF holds raw tracks, not sectors; its tracks are only
+    // checked through their MFM data below.
+    std::vector<uint8_t> image;
+    if (media_->type() != vamiga::FileType::EADF) {
+        image.assign(media_->getData(), media_->getData() + media_->getSize());
+    }
+    cancel_verify_ = false;
+    verifying_ = true;
+    verifier_ = std::thread([this, &emu, image = std::move(image), drive = drive_nr_,
+                             geometry = num_tracks_, tracks = is_hd_ ? 0 : num_tracks_,
+                             per_track = num_sectors_] {
+        const auto start = std::chrono::steady_clock::now();
+        auto report = std::make_unique<DiskVerifier::Report>(
+            DiskVerifier::VerifyImage(image, per_track, 0, &cancel_verify_, geometry));
+        // Floppies also get their MFM sector checksums checked. Tracks the
+        // decoder has not reached yet are read here, one after the other,
+        // and only their decoding is spread over the cores.
+        const auto count = static_cast<size_t>(tracks);
+        std::vector<std::shared_ptr<const MfmTrack>> decoded(count);
+        std::vector<std::string> bits(count);
+        for (size_t t = 0; t < count && !cancel_verify_; ++t) {
+            {
+                std::lock_guard lock(tracks_mutex_);
+                decoded[t] = tracks_[t];
+            }
+            if (!decoded[t]) bits[t] = ReadTrackBits(emu, drive, static_cast<int>(t));
+        }
+        DiskVerifier::ParallelFor(
+            tracks, 0,
+            [&](int i) {
+                const auto t = static_cast<size_t>(i);
+                if (decoded[t]) return;
+                decoded[t] = std::make_shared<const MfmTrack>(MfmTrack::Decode(bits[t]));
+            },
+            &cancel_verify_);
+        if (!cancel_verify_) {
+            for (size_t t = 0; t < count; ++t) {
+                decoded[t] = CacheTrack(static_cast<int>(t), std::move(decoded[t]));
+            }
+            DiskVerifier::VerifyTracks(*report, decoded);
+        }
+        verify_ms_ = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start).count();
+        if (!cancel_verify_) verify_report_ = std::move(report);
+        verifying_ = false;
+    });
+}
+
+void DiskInspector::StopVerify() {
+    cancel_verify_ = true;
+    if (verifier_.joinable()) verifier_.join();
+}
+
+void DiskInspector::DrawVerify(vamiga::VAmiga& emu) {
+    if (verifying_) {
+        ImGui::TextDisabled("Verifying...");
+        ImGui::SameLine();
+        if (ImGui::SmallButton(ICON_FA_XMARK " Cancel")) cancel_verify_ = true;
+        return;
+    }
+    if (ImGui::Button(ICON_FA_LIST_CHECK " Verify")) {
+        StartVerify(emu);
+        return;
+    }
+    if (!verify_report_) return;
+
+    const auto& report = *verify_report_;
+    ImGui::SameLine();
+    if (report.Ok()) {
+        ImGui::TextColored(ImVec4(0.40f, 0.80f, 0.40f, 1.0f), ICON_FA_CIRCLE_CHECK " No problems found");
+    } else {
+        ImGui::TextColored(ImVec4(0.90f, 0.25f, 0.25f, 1.0f), "%zu problems found",
+                           report.problems.size());
+    }
+    if (report.sector_image) {
+        ImGui::Text("Boot block: %s  Files: %d  Bad blocks: %d  Bad sectors: %d  (%.0f ms)",
+                    !report.dos ? "not DOS" : report.bootable ? "bootable" : "not bootable",
+                    report.files, report.bad_blocks, report.bad_sectors, verify_ms_);
+    } else {
+        ImGui::Text("Raw tracks only, file system not checked  Bad sectors: %d  (%.0f ms)",
+                    report.bad_sectors, verify_ms_);
+    }
+    DrawTrackMap(report);
+    if (!report.problems.empty() && ImGui::BeginChild("Problems", ImVec2(0, 120), true)) {
+        for (const auto& problem : report.problems) ImGui::TextUnformatted(problem.c_str());
+    }
+    if (!report.problems.empty()) ImGui::EndChild();
+}
+
+void DiskInspector::DrawTrackMap(const DiskVerifier::Report& report) {
+    // Large hard disks fold several tracks into a cell showing the worst.
+    constexpr size_t kMaxCells = 4096;
+    constexpr float kCell = 8.0f;
+    const size_t tracks = report.tracks.size();
+    if (tracks == 0) return;
+    const size_t group = (tracks + kMaxCells - 1) / kMaxCells;
+    const size_t cells = (tracks + group - 1) / group;
+    const int columns = std::max(1, static_cast<int>(ImGui::GetContentRegionAvail().x / kCell));
+    const int rows = static_cast<int>((cells + static_cast<size_t>(columns) - 1) / static_cast<size_t>(columns));
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("TrackMap", ImVec2(static_cast<float>(columns) * kCell, static_cast<float>(rows) * kCell));
+    auto* draw = ImGui::GetWindowDrawList();
+    for (size_t c = 0; c < cells; ++c) {
+        auto worst = DiskVerifier::Status::kUnchecked;
+        for (size_t t = c * group; t < std::min(tracks, (c + 1) * group); ++t) {
+            worst = std::max(worst, report.tracks[t]);
+        }
+        const ImU32 color = worst == DiskVerifier::Status::kError ? IM_COL32(230, 64, 64, 255)
+                          : worst == DiskVerifier::Status::kOk    ? IM_COL32(102, 204, 102, 255)
+                                                                   : IM_COL32(153, 153, 153, 255);
+        const ImVec2 min(origin.x + static_cast<float>(c % static_cast<size_t>(columns)) * kCell,
+                         origin.y + static_cast<float>(c / static_cast<size_t>(columns)) * kCell);
+        draw->AddRectFilled(min, ImVec2(min.x + kCell - 1.0f, min.y + kCell - 1.0f), color);
+    }
+    if (ImGui::IsItemHovered()) {
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        const size_t c = static_cast<size_t>((mouse.y - origin.y) / kCell) * static_cast<size_t>(columns) +
+                         static_cast<size_t>((mouse.x - origin.x) / kCell);
+        if (c < cells && group == 1) {
+            ImGui::SetTooltip("Track %zu", c);
+        } else if (c < cells) {
+            ImGui::SetTooltip("Tracks %zu-%zu", c * group, std::min(tracks, (c + 1) * group) - 1);
+        }
+    }
+}
+
 }
@@ -1,21 +1,29 @@
 #ifndef LINUXGUI_COMPONENTS_DISK_INSPECTOR_H_
 #define LINUXGUI_COMPONENTS_DISK_INSPECTOR_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 #include "VAmiga.h"
 #include "Media/MediaFile.h"
 #include "imgui.h"
+#include "services/disk_verifier.h"
+#include "services/mfm_track.h"
 
 namespace gui {
 
 class DiskInspector {
 public:
     static DiskInspector& Instance();
+    ~DiskInspector();
     void Draw(vamiga::VAmiga& emu);
     void Open(int drive_nr, bool is_hd, vamiga::VAmiga& emu);
+    // Stops the background decoder; call before the emulator goes away.
+    void Stop();
 
 private:
     DiskInspector() = default;
@@ -27,6 +35,26 @@ private:
     void DrawNavigation();
     void DrawBlockView();
     void DrawMFMView(vamiga::VAmiga& emu);
+    void DrawSectorBar(const MfmTrack& track);
+    void DrawBitstream(const MfmTrack& track);
+
+    // Each floppy track is decoded once, either by the background pass
+    // started in Open() or on demand when it is shown first.
+    std::shared_ptr<const MfmTrack> Track(vamiga::VAmiga& emu, int track);
+    // Stores a decoded track unless another thread got there first.
+    std::shared_ptr<const MfmTrack> CacheTrack(int track, std::shared_ptr<const MfmTrack> decoded);
+    // The drive is read by one thread at a time.
+    std::string ReadTrackBits(vamiga::VAmiga& emu, int drive, int track);
+    void StartDecoding(vamiga::VAmiga& emu);
+    void StopDecoding();
+
+    // Verification copies the image and runs on its own thread, which
+    // spreads the work over all cores. Floppy tracks come from the cache;
+    // missing ones are read in turn and only decoded in parallel.
+    void DrawVerify(vamiga::VAmiga& emu);
+    void DrawTrackMap(const DiskVerifier::Report& report);
+    void StartVerify(vamiga::VAmiga& emu);
+    void StopVerify();
     
     bool open_ = false;
     int drive_nr_ = 0;
@@ -45,6 +73,23 @@ private:
     int current_track_ = 0;
     int current_sector_ = 0;
     int current_block_ = 0;
+
+    static constexpr int kBitsPerRow = 64;
+    long long scroll_to_bit_ = -1;
+
+    std::mutex read_mutex_;
+    std::mutex tracks_mutex_;
+    std::vector<std::shared_ptr<const MfmTrack>> tracks_;
+    std::atomic<int> decoded_ = 0;
+    std::atomic<bool> stop_decoding_ = false;
+    std::thread decoder_;
+
+    // The report and time are written before verifying_ drops.
+    std::atomic<bool> verifying_ = false;
+    std::atomic<bool> cancel_verify_ = false;
+    std::unique_ptr<DiskVerifier::Report> verify_report_;
+    double verify_ms_ = 0.0;
+    std::thread verifier_;
 };
 
 }
@@ -0,0 +1,167 @@
+#include "event_timeline.h"
+#include <algorithm>
+#include <format>
+#include <ranges>
+#include "Components/Agnus/AgnusTypes.h"
+#include "resources/IconsFontAwesome6.h"
+
+namespace gui {
+
+namespace {
+enum class LaneState : uint8_t { Idle, Pending, Overdue, Fired };
+
+constexpr std::array<ImU32, 4> kLaneColors = {
+    0,
+    IM_COL32(80, 140, 220, 255),
+    IM_COL32(220, 60, 60, 255),
+    IM_COL32(240, 200, 60, 255),
+};
+
+constexpr float kLabelWidth = 90.0f;
+}  // namespace
+
+EventTimeline& EventTimeline::Instance() {
+  static EventTimeline instance;
+  return instance;
+}
+
+EventTimeline::EventTimeline() : ring_(kCapacity) {}
+
+const EventTimeline::Sample& EventTimeline::At(int age) const {
+  int idx = (head_ - 1 - age + kCapacity) % kCapacity;
+  return ring_[static_cast<std::size_t>(idx)];
+}
+
+void EventTimeline::Record(vamiga::VAmiga& emu) {
+  if (!recording_) return;
+  if (++tick_ < stride_) return;
+  tick_ = 0;
+
+  int64_t clock = emu.cpu.getInfo().clock;
+  if (count_ > 0 && At(0).clock == clock) return;
+
+  auto info = emu.agnus.getInfo();
+  Sample& s = ring_[static_cast<std::size_t>(head_)];
+  s.clock = clock;
+  for (int i : std::views::iota(0, kSlots)) {
+    const auto& slot = info.slotInfo[i];
+    if (slot.eventId == 0) {
+      s.due[static_cast<std::size_t>(i)] = kIdle;
+    } else {
+      s.due[static_cast<std::size_t>(i)] = static_cast<int32_t>(
+          std::clamp<int64_t>(slot.triggerRel, -kIdle, kIdle - 1));
+    }
+  }
+  head_ = (head_ + 1) % kCapacity;
+  count_ = std::min(count_ + 1, kCapacity);
+}
+
+void EventTimeline::DrawLanes(ImVec2 pos, float width) {
+  ImDrawList* dl = ImGui::GetWindowDrawList();
+  const float dx = width / kCapacity;
+  const float x0 = pos.x + kLabelWidth + (kCapacity - count_) * dx;
+  const float density_height = lane_height_ * 3;
+
+  auto state_at = [&](int slot, int age) {
+    int32_t due = At(age).due[static_cast<std::size_t>(slot)];
+    if (due == kIdle) return LaneState::Idle;
+    if (due < 0) return LaneState::Overdue;
+    if (age + 1 < count_) {
+      int32_t prev = At(age + 1).due[static_cast<std::size_t>(slot)];
+      if (prev != kIdle && due > prev) return LaneState::Fired;
+    }
+    return LaneState::Pending;
+  };
+
+  dl->AddText(pos, IM_COL32(180, 180, 180, 255), "Density");
+  for (int n : std::views::iota(0, count_)) {
+    int age = count_ - 1 - n;
+    int pending = 0;
+    for (int slot : std::views::iota(0, kSlots)) {
+      if (At(age).due[static_cast<std::size_t>(slot)] != kIdle) pending++;
+    }
+    float h = density_height * pending / kSlots;
+    float x = x0 + n * dx;
+    dl->AddRectFilled(ImVec2(x, pos.y + density_height - h),
+                      ImVec2(x + std::max(dx, 1.0f), pos.y + density_height),
+                      IM_COL32(120, 200, 120, 255));
+  }
+
+  for (int slot : std::views::iota(0, kSlots)) {
+    float y = pos.y + density_height + 4 + slot * lane_height_;
+    dl->AddText(ImGui::GetFont(), lane_height_, ImVec2(pos.x, y),
+                IM_COL32(180, 180, 180, 255),
+                vamiga::EventSlotEnum::_key(static_cast<vamiga::EventSlot>(slot)));
+    if (slot % 2 == 0) {
+      dl->AddRectFilled(ImVec2(pos.x + kLabelWidth, y),
+                        ImVec2(pos.x + kLabelWidth + width, y + lane_height_),
+                        IM_COL32(40, 40, 40, 255));
+    }
+
+    // Merge runs of equal state into a single rectangle per run.
+    int run_start = 0;
+    LaneState run_state = LaneState::Idle;
+    for (int n : std::views::iota(0, count_ + 1)) {
+      LaneState st = (n < count_) ? state_at(slot, count_ - 1 - n) : LaneState::Idle;
+      if (n < count_ && st == run_state) continue;
+      if (run_state != LaneState::Idle) {
+        dl->AddRectFilled(ImVec2(x0 + run_start * dx, y + 1),
+                          ImVec2(x0 + std::max(n * dx, run_start * dx + 1.0f), y + lane_height_ - 1),
+                          kLaneColors[static_cast<std::size_t>(run_state)]);
+      }
+      run_start = n;
+      run_state = st;
+    }
+  }
+
+  const float total_height = density_height + 4 + kSlots * lane_height_;
+  ImVec2 mouse = ImGui::GetIO().MousePos;
+  if (ImGui::IsWindowHovered() && mouse.x >= x0 && mouse.x < pos.x + kLabelWidth + width &&
+      mouse.y >= pos.y && mouse.y < pos.y + total_height && dx > 0) {
+    int n = static_cast<int>((mouse.x - x0) / dx);
+    if (n >= 0 && n < count_) {
+      int slot = static_cast<int>((mouse.y - pos.y - density_height - 4) / lane_height_);
+      const Sample& s = At(count_ - 1 - n);
+      if (slot >= 0 && slot < kSlots) {
+        int32_t due = s.due[static_cast<std::size_t>(slot)];
+        std::string text = due == kIdle
+            ? std::format("{}: idle", vamiga::EventSlotEnum::_key(static_cast<vamiga::EventSlot>(slot)))
+            : std::format("{}: due in {} cycles",
+                          vamiga::EventSlotEnum::_key(static_cast<vamiga::EventSlot>(slot)), due);
+        ImGui::SetTooltip("Sample %d (clock %lld)\n%s", n,
+                          static_cast<long long>(s.clock), text.c_str());
+      }
+      dl->AddLine(ImVec2(x0 + n * dx, pos.y), ImVec2(x0 + n * dx, pos.y + total_height),
+                  IM_COL32(255, 255, 0, 160));
+    }
+  }
+  ImGui::Dummy(ImVec2(kLabelWidth + width, total_height));
+}
+
+void EventTimeline::Draw(vamiga::VAmiga& emu) {
+  if (ImGui::Button(recording_ ? ICON_FA_STOP " Stop" : ICON_FA_CIRCLE " Record")) {
+    recording_ = !recording_;
+    tick_ = 0;
+  }
+  ImGui::SameLine();
+  if (ImGui::Button(ICON_FA_TRASH_CAN " Clear")) {
+    head_ = 0;
+    count_ = 0;
+  }
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(100);
+  ImGui::SliderInt("Stride", &stride_, 1, 50, "%d frame(s)");
+  ImGui::SetItemTooltip("Record one sample every N frames");
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(100);
+  ImGui::SliderFloat("Lane", &lane_height_, 6.0f, 20.0f, "%.0f px");
+  ImGui::SameLine();
+  ImGui::TextDisabled("%d / %d samples", count_, kCapacity);
+
+  ImGui::BeginChild("EventTimelineLanes", ImVec2(0, 0), true);
+  float width = std::max(1.0f, ImGui::GetContentRegionAvail().x - kLabelWidth);
+  DrawLanes(ImGui::GetCursorScreenPos(), width);
+  ImGui::EndChild();
+}
+
+}
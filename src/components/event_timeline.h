@@ -0,0 +1,42 @@
+#ifndef LINUXGUI_COMPONENTS_EVENT_TIMELINE_H_
+#define LINUXGUI_COMPONENTS_EVENT_TIMELINE_H_
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <utility>
+#include "VAmiga.h"
+#undef unreachable
+#define unreachable std::unreachable()
+#include "imgui.h"
+namespace gui {
+// Records the Agnus event table into a fixed-size ring and draws it as one
+// lane per event slot. Each sample stores, per slot, the number of cycles
+// until the pending event is due (kIdle if the slot is empty).
+class EventTimeline {
+ public:
+  static EventTimeline& Instance();
+  void Record(vamiga::VAmiga& emu);
+  void Draw(vamiga::VAmiga& emu);
+  bool IsRecording() const { return recording_; }
+ private:
+  EventTimeline();
+  static constexpr int kSlots = static_cast<int>(vamiga::SLOT_COUNT);
+  static constexpr int kCapacity = 2048;
+  static constexpr int32_t kIdle = std::numeric_limits<int32_t>::max();
+  struct Sample {
+    int64_t clock = 0;
+    std::array<int32_t, kSlots> due{};
+  };
+  const Sample& At(int age) const;
+  void DrawLanes(ImVec2 pos, float width);
+  std::vector<Sample> ring_;
+  int head_ = 0;
+  int count_ = 0;
+  int stride_ = 1;
+  int tick_ = 0;
+  bool recording_ = false;
+  float lane_height_ = 10.0f;
+};
+}
+#endif
@@ -0,0 +1,113 @@
+#include "gamepad_poller.h"
+
+#include "components/movie_player.h"
+#include "../Core/Peripherals/Joystick/JoystickTypes.h"
+
+namespace gui {
+
+GamepadPoller::~GamepadPoller() { Stop(); }
+
+void GamepadPoller::Start(vamiga::VAmiga& emu) {
+  if (IsRunning()) return;
+  stop_ = false;
+  worker_ = std::thread(&GamepadPoller::Run, this, &emu);
+}
+
+void GamepadPoller::Stop() {
+  if (!IsRunning()) return;
+  stop_ = true;
+  worker_.join();
+}
+
+void GamepadPoller::SetControllers(std::vector<SDL_GameController*> controllers) {
+  std::lock_guard lock(mutex_);
+  pads_.clear();
+  for (auto* c : controllers) pads_.push_back({c, {}});
+}
+
+void GamepadPoller::SetPorts(int port1_device, int port2_device) {
+  port_devices_[0].store(port1_device, std::memory_order_relaxed);
+  port_devices_[1].store(port2_device, std::memory_order_relaxed);
+}
+
+GamepadPoller::PadState GamepadPoller::Sample(SDL_GameController* c) {
+  auto button = [c](SDL_GameControllerButton b) { return SDL_GameControllerGetButton(c, b) != 0; };
+  const Sint16 ax = SDL_GameControllerGetAxis(c, SDL_CONTROLLER_AXIS_LEFTX);
+  const Sint16 ay = SDL_GameControllerGetAxis(c, SDL_CONTROLLER_AXIS_LEFTY);
+  PadState s;
+  if (button(SDL_CONTROLLER_BUTTON_DPAD_LEFT) || ax < -kAxisThreshold) {
+    s.x = -1;
+  } else if (button(SDL_CONTROLLER_BUTTON_DPAD_RIGHT) || ax > kAxisThreshold) {
+    s.x = 1;
+  }
+  if (button(SDL_CONTROLLER_BUTTON_DPAD_UP) || ay < -kAxisThreshold) {
+    s.y = -1;
+  } else if (button(SDL_CONTROLLER_BUTTON_DPAD_DOWN) || ay > kAxisThreshold) {
+    s.y = 1;
+  }
+  s.fire = button(SDL_CONTROLLER_BUTTON_A) || button(SDL_CONTROLLER_BUTTON_B) ||
+           button(SDL_CONTROLLER_BUTTON_X) || button(SDL_CONTROLLER_BUTTON_Y);
+  return s;
+}
+
+void GamepadPoller::Emit(vamiga::VAmiga& emu, uint8_t port, vamiga::GamePadAction action) {
+  Event event;
+  event.action = {InputAction::Type::kJoystick, port, static_cast<uint8_t>(action)};
+  event.counter = SDL_GetPerformanceCounter();
+  event.clock = emu.cpu.getInfo().clock;
+  if (MoviePlayer::Instance().GetState() == MoviePlayer::State::kIdle) {
+    MoviePlayer::Apply(emu, event.action);
+    event.applied = true;
+  }
+  // Never wait for the GUI here: it may be blocked on the joystick lock we
+  // hold. The queue is drained every frame and only fills up after a long
+  // GUI stall; the GUI reports what got lost then.
+  if (!queue_.Push(event)) dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GamepadPoller::Poll(vamiga::VAmiga& emu) {
+  using namespace vamiga;
+  std::lock_guard lock(mutex_);
+  SDL_LockJoysticks();
+  SDL_GameControllerUpdate();
+  for (std::size_t slot = 0; slot < pads_.size(); ++slot) {
+    auto& pad = pads_[slot];
+    if (!pad.controller) continue;
+    const PadState now = Sample(pad.controller);
+    if (now == pad.last) continue;
+    const int device = 4 + static_cast<int>(slot);
+    const uint8_t port = port_devices_[0] == device ? 1 : port_devices_[1] == device ? 2 : 0;
+    if (port) {
+      if (now.x != pad.last.x) {
+        Emit(emu, port, now.x < 0 ? GamePadAction::PULL_LEFT
+                        : now.x > 0 ? GamePadAction::PULL_RIGHT
+                                    : GamePadAction::RELEASE_X);
+      }
+      if (now.y != pad.last.y) {
+        Emit(emu, port, now.y < 0 ? GamePadAction::PULL_UP
+                        : now.y > 0 ? GamePadAction::PULL_DOWN
+                                    : GamePadAction::RELEASE_Y);
+      }
+      if (now.fire != pad.last.fire) {
+        Emit(emu, port, now.fire ? GamePadAction::PRESS_FIRE : GamePadAction::RELEASE_FIRE);
+      }
+    }
+    pad.last = now;
+  }
+  SDL_UnlockJoysticks();
+}
+
+void GamepadPoller::Run(vamiga::VAmiga* emu) {
+  auto next = std::chrono::steady_clock::now();
+  while (!stop_) {
+    next += kInterval;
+    Poll(*emu);
+    // Sleeping until an absolute deadline keeps the rate at 1 kHz instead of
+    // drifting by the time spent polling.
+    const auto now = std::chrono::steady_clock::now();
+    if (next < now) next = now;
+    std::this_thread::sleep_until(next);
+  }
+}
+
+}
@@ -0,0 +1,93 @@
+#ifndef LINUXGUI_COMPONENTS_GAMEPAD_POLLER_H_
+#define LINUXGUI_COMPONENTS_GAMEPAD_POLLER_H_
+
+#include <SDL.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+#include "VAmiga.h"
+#undef unreachable
+#define unreachable std::unreachable()
+#include "services/input_movie.h"
+#include "services/spsc_queue.h"
+
+namespace gui {
+
+// Samples the game controllers on its own thread so that pad input no
+// longer waits for the next rendered frame. SDL only supports updating
+// controllers off the main thread on Linux; elsewhere Poll() runs once per
+// GUI frame instead. State changes are applied to
+// the emulator right away and reported to the GUI thread, with their
+// timestamp and the CPU clock at injection, through a lock-free queue.
+// While a movie is recorded or replayed, actions are only queued and the
+// GUI thread dispatches them, so the recorder stays in control.
+class GamepadPoller {
+ public:
+  struct Event {
+    InputAction action;
+    bool applied = false;  // already handed to the emulator by the poller
+    uint64_t counter = 0;  // SDL performance counter at injection
+    int64_t clock = 0;     // CPU clock at injection
+  };
+
+#if defined(__linux__)
+  static constexpr bool kThreaded = true;
+#else
+  static constexpr bool kThreaded = false;
+#endif
+  static constexpr auto kInterval = std::chrono::microseconds(1000);
+  static constexpr int16_t kAxisThreshold = 16000;
+
+  GamepadPoller() = default;
+  ~GamepadPoller();
+  GamepadPoller(const GamepadPoller&) = delete;
+  GamepadPoller& operator=(const GamepadPoller&) = delete;
+
+  void Start(vamiga::VAmiga& emu);
+  void Stop();
+  bool IsRunning() const { return worker_.joinable(); }
+  // Samples every controller once; the worker calls this at kInterval.
+  void Poll(vamiga::VAmiga& emu);
+
+  // Controllers in slot order (device id 4 + index), null for an empty
+  // slot. Must be called before a listed controller is closed.
+  void SetControllers(std::vector<SDL_GameController*> controllers);
+  void SetPorts(int port1_device, int port2_device);
+
+  // GUI thread only.
+  bool Pop(Event& event) { return queue_.Pop(event); }
+  // Events lost because the queue was full.
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct PadState {
+    int8_t x = 0;
+    int8_t y = 0;
+    bool fire = false;
+    bool operator==(const PadState&) const = default;
+  };
+  struct Pad {
+    SDL_GameController* controller = nullptr;
+    PadState last;
+  };
+
+  void Run(vamiga::VAmiga* emu);
+  static PadState Sample(SDL_GameController* controller);
+  void Emit(vamiga::VAmiga& emu, uint8_t port, vamiga::GamePadAction action);
+
+  std::mutex mutex_;
+  std::vector<Pad> pads_;
+  std::atomic<int> port_devices_[2] = {1, 2};
+  SpscQueue<Event, 1024> queue_;
+  std::atomic<uint64_t> dropped_ = 0;
+  std::atomic<bool> stop_ = false;
+  std::thread worker_;
+};
+
+}
+
+#endif
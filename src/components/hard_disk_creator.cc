@@ -1,9 +1,16 @@
 #include "hard_disk_creator.h"
 #include "file_picker.h"
 #include "imgui.h"
+#include <fcntl.h>
+#include <unistd.h>
 #include <algorithm>
-#include <fstream>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
 #include <vector>
+#include "services/volume_builder.h"
 
 namespace gui {
 
@@ -16,8 +23,14 @@ HardDiskCreator::HardDiskCreator() {
   current_geometry_ = CalculateGeometryForSize(selected_preset_mb_);
 }
 
+HardDiskCreator::~HardDiskCreator() {
+  if (worker_.joinable()) worker_.join();
+}
+
 void HardDiskCreator::Open() {
   open_ = true;
+  created_ = false;
+  error_.clear();
   current_geometry_ = CalculateGeometryForSize(selected_preset_mb_);
 }
 
@@ -48,6 +61,14 @@ void HardDiskCreator::Draw() {
     if (!open_) return;
 
     if (ImGui::Begin("Create Hard Disk", &open_)) {
+        // The worker reads the geometry and options while it runs.
+        const bool busy = creating_;
+        if (!busy && worker_.joinable()) {
+            worker_.join();
+            if (created_) open_ = false;
+        }
+        ImGui::BeginDisabled(busy);
+
         ImGui::Text("Size Preset:");
         
         if (ImGui::Button("10 MB")) { selected_preset_mb_ = 10; current_geometry_ = CalculateGeometryForSize(10); custom_geometry_ = false; } ImGui::SameLine();
@@ -72,6 +93,20 @@ void HardDiskCreator::Draw() {
 
         ImGui::Separator();
 
+        ImGui::Checkbox("Preallocate", &options_.preallocate);
+        ImGui::SameLine();
+        ImGui::TextDisabled("(otherwise sparse)");
+        ImGui::Checkbox("Write RDB", &options_.rdb);
+        ImGui::SameLine();
+        ImGui::Checkbox("Format FFS", &options_.format);
+        if (options_.format) {
+            char label[32];
+            std::snprintf(label, sizeof(label), "%s", options_.label.c_str());
+            if (ImGui::InputText("Label", label, sizeof(label))) options_.label = label;
+        }
+
+        ImGui::Separator();
+
         if (ImGui::Button("Create")) {
              PickerOptions opts;
              opts.title = "Create Hard Disk File";
@@ -79,39 +114,191 @@ void HardDiskCreator::Draw() {
              opts.mode = PickerMode::kSaveFile;
              
              FilePicker::Instance().Open("CreateHDF", opts, [this](std::filesystem::path path) {
-                 if (CreateHDF(path)) {
-                     open_ = false;
-                 }
+                 StartCreate(path);
              });
         }
         ImGui::SameLine();
         if (ImGui::Button("Cancel")) {
             open_ = false;
         }
+        ImGui::EndDisabled();
+
+        if (busy) {
+            ImGui::ProgressBar(progress_, ImVec2(-1, 0));
+        } else if (!error_.empty()) {
+            ImGui::TextColored(ImVec4(0.90f, 0.25f, 0.25f, 1.0f), "%s", error_.c_str());
+        }
     }
     ImGui::End();
 }
 
+void HardDiskCreator::StartCreate(const std::filesystem::path& path) {
+    if (creating_) return;
+    if (worker_.joinable()) worker_.join();
+    creating_ = true;
+    created_ = false;
+    worker_ = std::thread([this, path] {
+        created_ = CreateHDF(path);
+        creating_ = false;
+    });
+}
+
 bool HardDiskCreator::CreateHDF(const std::filesystem::path& path) {
-    std::ofstream file(path, std::ios::binary);
-    if (!file) return false;
+    error_.clear();
+    progress_ = 0.0f;
+    const long long size_bytes = static_cast<long long>(current_geometry_.cylinders) *
+                                 current_geometry_.heads *
+                                 current_geometry_.sectors *
+                                 current_geometry_.block_size;
+    if (size_bytes <= 0) {
+        error_ = "Invalid geometry";
+        return false;
+    }
 
-    long long size_bytes = static_cast<long long>(current_geometry_.cylinders) * 
-                           current_geometry_.heads * 
-                           current_geometry_.sectors * 
-                           current_geometry_.block_size;
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error_ = std::strerror(errno);
+        return false;
+    }
+    // Extending the file leaves a hole that reads back as zeros, so no
+    // data is written and no space is used until the Amiga writes.
+    bool ok = ::ftruncate(fd, size_bytes) == 0;
+    if (!ok) error_ = std::strerror(errno);
+    if (ok && options_.preallocate) ok = Preallocate(fd, size_bytes);
+    if (ok && (options_.rdb || options_.format)) ok = WriteLayout(fd);
+    if (::close(fd) != 0 && ok) {
+        error_ = std::strerror(errno);
+        ok = false;
+    }
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    progress_ = 1.0f;
+    return ok;
+}
 
-    const size_t chunk_size = 1024 * 1024;
-    std::vector<char> buffer(chunk_size, 0);
-    
-    long long bytes_remaining = size_bytes;
-    while (bytes_remaining > 0) {
-        long long to_write = std::min(bytes_remaining, static_cast<long long>(chunk_size));
-        file.write(buffer.data(), to_write);
-        if (!file) return false;
-        bytes_remaining -= to_write;
+bool HardDiskCreator::Preallocate(int fd, long long size) {
+#if defined(__APPLE__)
+    // No posix_fallocate here; the image stays sparse.
+    (void)fd;
+    (void)size;
+    return true;
+#else
+    // In steps, so the progress bar moves on slow file systems.
+    constexpr long long kStep = 64LL << 20;
+    for (long long offset = 0; offset < size; offset += kStep) {
+        const int err = ::posix_fallocate(fd, offset, std::min(kStep, size - offset));
+        if (err != 0) {
+            error_ = std::strerror(err);
+            return false;
+        }
+        progress_ = 0.5f * static_cast<float>(offset + kStep) / static_cast<float>(size);
+    }
+    return true;
+#endif
+}
+
+bool HardDiskCreator::WriteBlock(int fd, long long block, const void* data) {
+    const auto bytes = static_cast<size_t>(current_geometry_.block_size);
+    if (::pwrite(fd, data, bytes, static_cast<off_t>(block) * static_cast<off_t>(bytes)) !=
+        static_cast<ssize_t>(bytes)) {
+        error_ = std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+namespace {
+void PutLong(std::array<uint8_t, 512>& block, int index, uint32_t value) {
+    block[index * 4] = static_cast<uint8_t>(value >> 24);
+    block[index * 4 + 1] = static_cast<uint8_t>(value >> 16);
+    block[index * 4 + 2] = static_cast<uint8_t>(value >> 8);
+    block[index * 4 + 3] = static_cast<uint8_t>(value);
+}
+
+// RDB blocks sum to zero over their first 64 longwords.
+void SealRdbBlock(std::array<uint8_t, 512>& block) {
+    uint32_t sum = 0;
+    for (int i = 0; i < 64; ++i) {
+        sum += (uint32_t{block[i * 4]} << 24) | (uint32_t{block[i * 4 + 1]} << 16) |
+               (uint32_t{block[i * 4 + 2]} << 8) | block[i * 4 + 3];
+    }
+    PutLong(block, 2, ~sum + 1);
+}
+}  // namespace
+
+bool HardDiskCreator::WriteLayout(int fd) {
+    const auto& g = current_geometry_;
+    if (g.block_size != 512) {
+        error_ = "RDB and formatting need 512 byte blocks";
+        return false;
+    }
+    const uint32_t cyl_blocks = static_cast<uint32_t>(g.heads * g.sectors);
+    long long first = 0;
+    long long blocks = static_cast<long long>(g.cylinders) * cyl_blocks;
+
+    if (options_.rdb) {
+        if (g.cylinders < 2) {
+            error_ = "An RDB needs at least two cylinders";
+            return false;
+        }
+        constexpr uint32_t kNone = 0xFFFFFFFF;
+        const uint32_t cyls = static_cast<uint32_t>(g.cylinders);
+        std::array<uint8_t, 512> rdsk{};
+        PutLong(rdsk, 0, 0x5244534B);  // 'RDSK'
+        PutLong(rdsk, 1, 64);
+        PutLong(rdsk, 3, 7);
+        PutLong(rdsk, 4, 512);
+        PutLong(rdsk, 6, kNone);
+        PutLong(rdsk, 7, 1);  // partition list
+        for (int i = 8; i < 16; ++i) PutLong(rdsk, i, kNone);
+        PutLong(rdsk, 16, cyls);
+        PutLong(rdsk, 17, static_cast<uint32_t>(g.sectors));
+        PutLong(rdsk, 18, static_cast<uint32_t>(g.heads));
+        PutLong(rdsk, 19, 1);
+        PutLong(rdsk, 20, cyls);
+        PutLong(rdsk, 24, cyls);
+        PutLong(rdsk, 25, cyls);
+        PutLong(rdsk, 26, 3);
+        PutLong(rdsk, 33, cyl_blocks - 1);
+        PutLong(rdsk, 34, 1);
+        PutLong(rdsk, 35, cyls - 1);
+        PutLong(rdsk, 36, cyl_blocks);
+        PutLong(rdsk, 38, 1);
+        SealRdbBlock(rdsk);
+
+        std::array<uint8_t, 512> part{};
+        PutLong(part, 0, 0x50415254);  // 'PART'
+        PutLong(part, 1, 64);
+        PutLong(part, 3, 7);
+        PutLong(part, 4, kNone);
+        PutLong(part, 5, 1);  // bootable
+        static constexpr char kDrive[] = "\3DH0";
+        std::memcpy(part.data() + 36, kDrive, sizeof(kDrive) - 1);
+        // DosEnvec
+        const std::array<uint32_t, 17> env = {
+            16, 128, 0, static_cast<uint32_t>(g.heads), 1, static_cast<uint32_t>(g.sectors),
+            2, 0, 0, 1, cyls - 1, 30, 0, 0x1FE00, 0x7FFFFFFE, 0, 0x444F5301};
+        for (size_t i = 0; i < env.size(); ++i) PutLong(part, 32 + static_cast<int>(i), env[i]);
+        SealRdbBlock(part);
+        if (!WriteBlock(fd, 0, rdsk.data()) || !WriteBlock(fd, 1, part.data())) return false;
+        first = cyl_blocks;
+        blocks -= cyl_blocks;
+    }
+
+    if (options_.format) {
+        VolumeBuilder::Options volume;
+        volume.num_blocks = static_cast<uint32_t>(std::min<long long>(blocks, UINT32_MAX));
+        volume.label = options_.label;
+        std::map<uint32_t, std::vector<uint8_t>> layout;
+        if (!VolumeBuilder::Format(volume, layout, error_)) return false;
+        size_t written = 0;
+        for (const auto& [nr, data] : layout) {
+            if (!WriteBlock(fd, first + nr, data.data())) return false;
+            progress_ = 0.5f + 0.5f * static_cast<float>(++written) / static_cast<float>(layout.size());
+        }
     }
-    
     return true;
 }
 
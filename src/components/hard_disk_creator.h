@@ -1,8 +1,10 @@
 #ifndef COMPONENT_HARD_DISK_CREATOR_H
 #define COMPONENT_HARD_DISK_CREATOR_H
 
+#include <atomic>
 #include <string>
 #include <filesystem>
+#include <thread>
 
 namespace gui {
 
@@ -15,17 +17,35 @@ public:
     int block_size = 512;
   };
 
+  // Images are sparse unless preallocated. With an RDB the first cylinder
+  // holds the rigid disk block and the partition starts after it.
+  struct Options {
+    bool preallocate = false;
+    bool rdb = false;
+    bool format = false;
+    std::string label = "Work";
+  };
+
   static HardDiskCreator& Instance();
   static Geometry CalculateGeometryForSize(int size_mb);
 
   void Open();
   void Draw();
 
+  ~HardDiskCreator();
+
+  void SetOptions(const Options& options) { options_ = options; }
   bool CreateHDF(const std::filesystem::path& path);
+  const std::string& LastError() const { return error_; }
 
 private:
   HardDiskCreator();
 
+  bool Preallocate(int fd, long long size);
+  bool WriteLayout(int fd);
+  bool WriteBlock(int fd, long long block, const void* data);
+  void StartCreate(const std::filesystem::path& path);
+
   bool open_ = false;
   int selected_preset_mb_ = 10;
   Geometry current_geometry_;
@@ -33,6 +53,14 @@ private:
   bool custom_geometry_ = false;
 
   std::string file_path_;
+
+  Options options_;
+  std::string error_;
+  // The worker writes error_ before creating_ drops.
+  std::atomic<float> progress_ = 0.0f;
+  std::atomic<bool> creating_ = false;
+  bool created_ = false;
+  std::thread worker_;
 };
 
 }
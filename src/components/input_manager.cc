@@ -2,6 +2,8 @@
 #include <algorithm>
 #include <iostream>
 #include "imgui.h"
+#include "components/latency_meter.h"
+#include "components/movie_player.h"
 #include "../Core/Peripherals/Joystick/JoystickTypes.h"
 InputManager::InputManager(vamiga::VAmiga& emulator) : emulator_(emulator) {
   int num_joysticks = SDL_NumJoysticks();
@@ -14,16 +16,29 @@ InputManager::InputManager(vamiga::VAmiga& emulator) : emulator_(emulator) {
     }
   }
 }
-InputManager::~InputManager() { controllers_.clear(); }
+InputManager::~InputManager() {
+  poller_.Stop();
+  controllers_.clear();
+}
 void InputManager::SetPortDevices(int port1_device, int port2_device) {
   port1_device_ = port1_device;
   port2_device_ = port2_device;
+  poller_.SetPorts(port1_device, port2_device);
 }
 void InputManager::SetViewportHovered(bool hovered) {
   viewport_hovered_ = hovered;
 }
 void InputManager::SetCaptured(bool captured) {
   if (captured_ != captured) {
+    if (!captured) {
+      // Hand over what is still pending; the sub-pixel rest is dropped.
+      const auto d = motion_.Take(emulator_.cpu.getInfo().clock);
+      if (d.dx != 0.0 || d.dy != 0.0) {
+        Dispatch({gui::InputAction::Type::kMouseMove, ActiveMousePort(), 0,
+                  static_cast<float>(d.dx), static_cast<float>(d.dy)});
+      }
+      motion_.Reset();
+    }
     captured_ = captured;
     SDL_SetRelativeMouseMode(captured_ ? SDL_TRUE : SDL_FALSE);
   }
@@ -48,7 +63,54 @@ void InputManager::HandleWindowFocus(bool focused) {
     }
   }
 }
-void InputManager::Update() {}
+void InputManager::Update() {
+  // The poller thread only runs while there is a controller to sample.
+  const bool poll = PollingGamepads();
+  if (gui::GamepadPoller::kThreaded) {
+    if (poll && !poller_.IsRunning()) {
+      SyncPoller();
+      poller_.Start(emulator_);
+    } else if (!poll && poller_.IsRunning()) {
+      poller_.Stop();
+    }
+  } else if (poll) {
+    poller_.Poll(emulator_);
+  }
+  DrainPoller();
+  const bool ntsc = emulator_.get(vamiga::Opt::AMIGA_VIDEO_FORMAT) ==
+                    static_cast<vamiga::i64>(vamiga::TV::NTSC);
+  motion_.Configure(mouse_deliveries_, ntsc ? gui::MotionCoalescer::kNtscFrameCycles
+                                            : gui::MotionCoalescer::kPalFrameCycles);
+}
+void InputManager::FinishEvents() {
+  if (captured_) FlushMotion();
+}
+void InputManager::SyncPoller() {
+  std::vector<SDL_GameController*> pads;
+  for (SDL_JoystickID id : gamepad_ids_) {
+    auto it = controllers_.find(id);
+    pads.push_back(it != controllers_.end() ? it->second.get() : nullptr);
+  }
+  poller_.SetControllers(std::move(pads));
+}
+void InputManager::DrainPoller() {
+  auto& meter = gui::LatencyMeter::Instance();
+  gui::GamepadPoller::Event event;
+  while (poller_.Pop(event)) {
+    if (!event.applied) {
+      Dispatch(event.action);
+    } else if (meter.IsEnabled()) {
+      meter.Stamp(gui::LatencyMeter::Source::kGamepad, 0.0, event.counter, event.clock);
+    }
+  }
+  // Reported once per stall rather than once per lost event.
+  const uint64_t dropped = poller_.Dropped();
+  if (dropped != reported_drops_) {
+    std::cout << "Gamepad queue full: " << dropped - reported_drops_ << " events dropped ("
+              << dropped << " in total)" << std::endl;
+    reported_drops_ = dropped;
+  }
+}
 void InputManager::HandleEvent(const SDL_Event& event) {
   ImGuiIO& io = ImGui::GetIO();
   if (event.type == SDL_KEYDOWN) {
@@ -57,6 +119,11 @@ void InputManager::HandleEvent(const SDL_Event& event) {
       return;
     }
   }
+  // A replay owns the emulator's inputs; only hot-plugging still goes through.
+  if (gui::MoviePlayer::Instance().IsReplaying() &&
+      event.type != SDL_CONTROLLERDEVICEADDED && event.type != SDL_CONTROLLERDEVICEREMOVED) {
+    return;
+  }
   if (!captured_) {
     if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEWHEEL) {
       if (io.WantCaptureMouse && !viewport_hovered_) return;
@@ -65,6 +132,12 @@ void InputManager::HandleEvent(const SDL_Event& event) {
       if (io.WantCaptureKeyboard) return;
     }
   }
+  // The poller samples the controllers itself; SDL's copies would double up.
+  if (PollingGamepads() &&
+      (event.type == SDL_CONTROLLERBUTTONDOWN || event.type == SDL_CONTROLLERBUTTONUP ||
+       event.type == SDL_CONTROLLERAXISMOTION)) {
+    return;
+  }
   switch (event.type) {
     case SDL_KEYDOWN:
       HandleKeyDown(event.key);
@@ -95,6 +168,30 @@ void InputManager::HandleEvent(const SDL_Event& event) {
       HandleControllerAxis(event.caxis);
       break;
   }
+  StampLatency(event);
+}
+void InputManager::StampLatency(const SDL_Event& event) {
+  using Source = gui::LatencyMeter::Source;
+  auto& meter = gui::LatencyMeter::Instance();
+  if (!meter.IsEnabled()) return;
+  switch (event.type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+      meter.Stamp(Source::kKeyboard, event.common.timestamp);
+      break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+      if (captured_) meter.Stamp(Source::kMouseButton, event.common.timestamp);
+      break;
+    case SDL_MOUSEMOTION:
+      if (captured_) meter.Stamp(Source::kMouseMotion, event.common.timestamp);
+      break;
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+    case SDL_CONTROLLERAXISMOTION:
+      meter.Stamp(Source::kGamepad, event.common.timestamp);
+      break;
+  }
 }
 
 InputManager::DeviceInfo InputManager::GetDeviceInfo(int device_id) const {
@@ -157,59 +254,80 @@ vamiga::MouseAPI* InputManager::GetActiveMouse() {
   if (port2_device_ == 1) return &emulator_.controlPort2.mouse;
   return &emulator_.controlPort1.mouse;
 }
+uint8_t InputManager::ActiveMousePort() const {
+  return (port1_device_ != 1 && port2_device_ == 1) ? 2 : 1;
+}
+uint8_t InputManager::PortOf(int device_id) const {
+  if (port1_device_ == device_id) return 1;
+  if (port2_device_ == device_id) return 2;
+  return 0;
+}
+void InputManager::Dispatch(const gui::InputAction& action) {
+  if (gui::MoviePlayer::Instance().Capture(action)) return;
+  gui::MoviePlayer::Apply(emulator_, action);
+}
+void InputManager::PressKey(vamiga::KeyCode key) {
+  Dispatch({gui::InputAction::Type::kKeyPress, 0, static_cast<uint8_t>(key)});
+}
+void InputManager::ReleaseKey(vamiga::KeyCode key) {
+  Dispatch({gui::InputAction::Type::kKeyRelease, 0, static_cast<uint8_t>(key)});
+}
+void InputManager::TriggerJoystick(uint8_t port, vamiga::GamePadAction action) {
+  Dispatch({gui::InputAction::Type::kJoystick, port, static_cast<uint8_t>(action)});
+}
+void InputManager::TriggerMouse(vamiga::GamePadAction action) {
+  Dispatch({gui::InputAction::Type::kMouseButton, ActiveMousePort(),
+            static_cast<uint8_t>(action)});
+}
 bool InputManager::HandleKeyset(int device_id, const SDL_KeyboardEvent& event,
                                 bool is_down) {
   using namespace vamiga;
-  JoystickAPI* joy = nullptr;
-  if (port1_device_ == device_id)
-    joy = &emulator_.controlPort1.joystick;
-  else if (port2_device_ == device_id)
-    joy = &emulator_.controlPort2.joystick;
-  if (!joy) return false;
+  const uint8_t port = PortOf(device_id);
+  if (!port) return false;
   SDL_Keycode sym = event.keysym.sym;
   bool hit = false;
   if (device_id == 2) {
     if (sym == SDLK_UP) {
-      joy->trigger(is_down ? GamePadAction::PULL_UP
-                           : GamePadAction::RELEASE_Y);
+      TriggerJoystick(port, is_down ? GamePadAction::PULL_UP
+                                    : GamePadAction::RELEASE_Y);
       hit = true;
     } else if (sym == SDLK_DOWN) {
-      joy->trigger(is_down ? GamePadAction::PULL_DOWN
-                           : GamePadAction::RELEASE_Y);
+      TriggerJoystick(port, is_down ? GamePadAction::PULL_DOWN
+                                    : GamePadAction::RELEASE_Y);
       hit = true;
     } else if (sym == SDLK_LEFT) {
-      joy->trigger(is_down ? GamePadAction::PULL_LEFT
-                           : GamePadAction::RELEASE_X);
+      TriggerJoystick(port, is_down ? GamePadAction::PULL_LEFT
+                                    : GamePadAction::RELEASE_X);
       hit = true;
     } else if (sym == SDLK_RIGHT) {
-      joy->trigger(is_down ? GamePadAction::PULL_RIGHT
-                           : GamePadAction::RELEASE_X);
+      TriggerJoystick(port, is_down ? GamePadAction::PULL_RIGHT
+                                    : GamePadAction::RELEASE_X);
       hit = true;
     } else if (sym == SDLK_RCTRL || sym == SDLK_KP_0) {
-      joy->trigger(is_down ? GamePadAction::PRESS_FIRE
-                           : GamePadAction::RELEASE_FIRE);
+      TriggerJoystick(port, is_down ? GamePadAction::PRESS_FIRE
+                                    : GamePadAction::RELEASE_FIRE);
       hit = true;
     }
   } else if (device_id == 3) {
     if (sym == SDLK_w) {
-      joy->trigger(is_down ? GamePadAction::PULL_UP
-                           : GamePadAction::RELEASE_Y);
+      TriggerJoystick(port, is_down ? GamePadAction::PULL_UP
+                                    : GamePadAction::RELEASE_Y);
       hit = true;
     } else if (sym == SDLK_s) {
-      joy->trigger(is_down ? GamePadAction::PULL_DOWN
-                           : GamePadAction::RELEASE_Y);
+      TriggerJoystick(port, is_down ? GamePadAction::PULL_DOWN
+                                    : GamePadAction::RELEASE_Y);
       hit = true;
     } else if (sym == SDLK_a) {
-      joy->trigger(is_down ? GamePadAction::PULL_LEFT
-                           : GamePadAction::RELEASE_X);
+      TriggerJoystick(port, is_down ? GamePadAction::PULL_LEFT
+                                    : GamePadAction::RELEASE_X);
       hit = true;
     } else if (sym == SDLK_d) {
-      joy->trigger(is_down ? GamePadAction::PULL_RIGHT
-                           : GamePadAction::RELEASE_X);
+      TriggerJoystick(port, is_down ? GamePadAction::PULL_RIGHT
+                                    : GamePadAction::RELEASE_X);
       hit = true;
     } else if (sym == SDLK_LCTRL) {
-      joy->trigger(is_down ? GamePadAction::PRESS_FIRE
-                           : GamePadAction::RELEASE_FIRE);
+      TriggerJoystick(port, is_down ? GamePadAction::PRESS_FIRE
+                                    : GamePadAction::RELEASE_FIRE);
       hit = true;
     }
   }
@@ -226,7 +344,7 @@ void InputManager::HandleKeyDown(const SDL_KeyboardEvent& event) {
   if (HandleKeyset(3, event, true)) return;
   vamiga::KeyCode kc = SdlToAmigaKeyCode(event.keysym.sym);
   if (kc != 0xFF) {
-    emulator_.keyboard.press(kc);
+    Dispatch({gui::InputAction::Type::kKeyPress, 0, static_cast<uint8_t>(kc)});
   }
 }
 void InputManager::HandleKeyUp(const SDL_KeyboardEvent& event) {
@@ -234,7 +352,7 @@ void InputManager::HandleKeyUp(const SDL_KeyboardEvent& event) {
   if (HandleKeyset(3, event, false)) return;
   vamiga::KeyCode kc = SdlToAmigaKeyCode(event.keysym.sym);
   if (kc != 0xFF) {
-    emulator_.keyboard.release(kc);
+    Dispatch({gui::InputAction::Type::kKeyRelease, 0, static_cast<uint8_t>(kc)});
   }
 }
 void InputManager::HandleMouseButtonDown(const SDL_MouseButtonEvent& event) {
@@ -245,29 +363,23 @@ void InputManager::HandleMouseButtonDown(const SDL_MouseButtonEvent& event) {
       SetCaptured(true);
     }
   } else {
-    MouseAPI* mouse = GetActiveMouse();
-    if (mouse) {
-      if (event.button == SDL_BUTTON_LEFT)
-        mouse->trigger(GamePadAction::PRESS_LEFT);
-      else if (event.button == SDL_BUTTON_RIGHT)
-        mouse->trigger(GamePadAction::PRESS_RIGHT);
-      else if (event.button == SDL_BUTTON_MIDDLE)
-        mouse->trigger(GamePadAction::PRESS_MIDDLE);
-    }
+    if (event.button == SDL_BUTTON_LEFT)
+      TriggerMouse(GamePadAction::PRESS_LEFT);
+    else if (event.button == SDL_BUTTON_RIGHT)
+      TriggerMouse(GamePadAction::PRESS_RIGHT);
+    else if (event.button == SDL_BUTTON_MIDDLE)
+      TriggerMouse(GamePadAction::PRESS_MIDDLE);
   }
 }
 void InputManager::HandleMouseButtonUp(const SDL_MouseButtonEvent& event) {
   using namespace vamiga;
   if (captured_) {
-    MouseAPI* mouse = GetActiveMouse();
-    if (mouse) {
-      if (event.button == SDL_BUTTON_LEFT)
-        mouse->trigger(GamePadAction::RELEASE_LEFT);
-      else if (event.button == SDL_BUTTON_RIGHT)
-        mouse->trigger(GamePadAction::RELEASE_RIGHT);
-      else if (event.button == SDL_BUTTON_MIDDLE)
-        mouse->trigger(GamePadAction::RELEASE_MIDDLE);
-    }
+    if (event.button == SDL_BUTTON_LEFT)
+      TriggerMouse(GamePadAction::RELEASE_LEFT);
+    else if (event.button == SDL_BUTTON_RIGHT)
+      TriggerMouse(GamePadAction::RELEASE_RIGHT);
+    else if (event.button == SDL_BUTTON_MIDDLE)
+      TriggerMouse(GamePadAction::RELEASE_MIDDLE);
   }
 }
 void InputManager::HandleMouseMotion(const SDL_MouseMotionEvent& event) {
@@ -280,17 +392,20 @@ void InputManager::HandleMouseMotion(const SDL_MouseMotionEvent& event) {
   if (captured_) {
     float scale_x = 1.0f;
     float scale_y = 1.0f;
-    double dx = event.xrel * scale_x;
-    double dy = event.yrel * scale_y;
-    vamiga::MouseAPI* mouse = GetActiveMouse();
-    if (mouse) {
-      mouse->setDxDy(dx, dy);
-      if (release_mouse_by_shaking_) {
-        if (mouse->detectShakeDxDy(dx, dy)) {
-          SetCaptured(false);
-        }
-      }
-    }
+    // A burst of motion events is delivered as one move in FinishEvents().
+    motion_.Add(event.xrel * scale_x, event.yrel * scale_y);
+  }
+}
+void InputManager::FlushMotion() {
+  const int64_t clock = emulator_.cpu.getInfo().clock;
+  if (!motion_.Due(clock)) return;
+  const auto d = motion_.Take(clock);
+  Dispatch({gui::InputAction::Type::kMouseMove, ActiveMousePort(), 0,
+            static_cast<float>(d.dx), static_cast<float>(d.dy)});
+  // Shake detection sees the same coalesced deltas as the emulator.
+  vamiga::MouseAPI* mouse = GetActiveMouse();
+  if (release_mouse_by_shaking_ && mouse && mouse->detectShakeDxDy(d.dx, d.dy)) {
+    SetCaptured(false);
   }
 }
 void InputManager::HandleControllerDeviceAdded(
@@ -303,6 +418,7 @@ void InputManager::HandleControllerDeviceAdded(
       SDL_JoystickID instance_id = SDL_JoystickInstanceID(joy);
       controllers_.emplace(instance_id, std::unique_ptr<SDL_GameController, void(*)(SDL_GameController*)>(controller, SDL_GameControllerClose));
       gamepad_ids_.push_back(instance_id);
+      SyncPoller();
       std::cout << "Gamepad added: ID " << instance_id << " (Slot "
                 << (gamepad_ids_.size() - 1) << ")" << std::endl;
     }
@@ -313,12 +429,14 @@ void InputManager::HandleControllerDeviceRemoved(
   SDL_JoystickID instance_id = event.which;
   auto it = controllers_.find(instance_id);
   if (it != controllers_.end()) {
-    controllers_.erase(it);
     auto vec_it =
         std::find(gamepad_ids_.begin(), gamepad_ids_.end(), instance_id);
     if (vec_it != gamepad_ids_.end()) {
       gamepad_ids_.erase(vec_it);
     }
+    // The poller must let go of the handle before it is closed.
+    SyncPoller();
+    controllers_.erase(it);
     std::cout << "Gamepad removed: ID " << instance_id << std::endl;
   }
 }
@@ -332,12 +450,8 @@ void InputManager::HandleControllerButton(
     }
   }
   if (slot == -1) return;
-  vamiga::JoystickAPI* joy = nullptr;
-  if (port1_device_ == (4 + slot))
-    joy = &emulator_.controlPort1.joystick;
-  else if (port2_device_ == (4 + slot))
-    joy = &emulator_.controlPort2.joystick;
-  if (!joy) return;
+  const uint8_t port = PortOf(4 + slot);
+  if (!port) return;
   using namespace vamiga;
   bool down = (event.state == SDL_PRESSED);
   switch (event.button) {
@@ -345,20 +459,20 @@ void InputManager::HandleControllerButton(
     case SDL_CONTROLLER_BUTTON_B:
     case SDL_CONTROLLER_BUTTON_X:
     case SDL_CONTROLLER_BUTTON_Y:
-      joy->trigger(down ? GamePadAction::PRESS_FIRE
-                        : GamePadAction::RELEASE_FIRE);
+      TriggerJoystick(port, down ? GamePadAction::PRESS_FIRE
+                                 : GamePadAction::RELEASE_FIRE);
       break;
     case SDL_CONTROLLER_BUTTON_DPAD_UP:
-      joy->trigger(down ? GamePadAction::PULL_UP : GamePadAction::RELEASE_Y);
+      TriggerJoystick(port, down ? GamePadAction::PULL_UP : GamePadAction::RELEASE_Y);
       break;
     case SDL_CONTROLLER_BUTTON_DPAD_DOWN:
-      joy->trigger(down ? GamePadAction::PULL_DOWN : GamePadAction::RELEASE_Y);
+      TriggerJoystick(port, down ? GamePadAction::PULL_DOWN : GamePadAction::RELEASE_Y);
       break;
     case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
-      joy->trigger(down ? GamePadAction::PULL_LEFT : GamePadAction::RELEASE_X);
+      TriggerJoystick(port, down ? GamePadAction::PULL_LEFT : GamePadAction::RELEASE_X);
       break;
     case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
-      joy->trigger(down ? GamePadAction::PULL_RIGHT : GamePadAction::RELEASE_X);
+      TriggerJoystick(port, down ? GamePadAction::PULL_RIGHT : GamePadAction::RELEASE_X);
       break;
   }
 }
@@ -371,28 +485,24 @@ void InputManager::HandleControllerAxis(const SDL_ControllerAxisEvent& event) {
     }
   }
   if (slot == -1) return;
-  vamiga::JoystickAPI* joy = nullptr;
-  if (port1_device_ == (4 + slot))
-    joy = &emulator_.controlPort1.joystick;
-  else if (port2_device_ == (4 + slot))
-    joy = &emulator_.controlPort2.joystick;
-  if (!joy) return;
+  const uint8_t port = PortOf(4 + slot);
+  if (!port) return;
   using namespace vamiga;
   const int kThreshold = 16000;
   if (event.axis == SDL_CONTROLLER_AXIS_LEFTY) {
     if (event.value < -kThreshold)
-      joy->trigger(GamePadAction::PULL_UP);
+      TriggerJoystick(port, GamePadAction::PULL_UP);
     else if (event.value > kThreshold)
-      joy->trigger(GamePadAction::PULL_DOWN);
+      TriggerJoystick(port, GamePadAction::PULL_DOWN);
     else
-      joy->trigger(GamePadAction::RELEASE_Y);
+      TriggerJoystick(port, GamePadAction::RELEASE_Y);
   } else if (event.axis == SDL_CONTROLLER_AXIS_LEFTX) {
     if (event.value < -kThreshold)
-      joy->trigger(GamePadAction::PULL_LEFT);
+      TriggerJoystick(port, GamePadAction::PULL_LEFT);
     else if (event.value > kThreshold)
-      joy->trigger(GamePadAction::PULL_RIGHT);
+      TriggerJoystick(port, GamePadAction::PULL_RIGHT);
     else
-      joy->trigger(GamePadAction::RELEASE_X);
+      TriggerJoystick(port, GamePadAction::RELEASE_X);
   }
 }
 bool InputManager::IsGrabKeyCombo(const SDL_KeyboardEvent& event) {
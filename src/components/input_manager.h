@@ -9,12 +9,18 @@
 #include "VAmiga.h"
 #undef unreachable
 #define unreachable std::unreachable()
+#include "components/gamepad_poller.h"
+#include "services/input_movie.h"
+#include "services/motion_coalescer.h"
 class InputManager {
  public:
   explicit InputManager(vamiga::VAmiga& emulator);
   ~InputManager();
   void Update();
   void HandleEvent(const SDL_Event& event);
+  // Delivers the mouse motion of all events handled since the last call;
+  // call once after the SDL event queue has been drained.
+  void FinishEvents();
   void HandleWindowFocus(bool focused);
   void SetPortDevices(int port1_device, int port2_device);
   void SetViewportHovered(bool hovered);
@@ -31,15 +37,28 @@ class InputManager {
   };
   DeviceInfo GetDeviceInfo(int device_id) const;
   std::vector<std::string> GetActiveActions(int device_id) const;
+  // Keys from the on-screen keyboard; recorded like physical keys.
+  void PressKey(vamiga::KeyCode key);
+  void ReleaseKey(vamiga::KeyCode key);
 
   static constexpr int kMaxDevices = 8;
   bool pause_in_background_ = true;
   bool retain_mouse_by_click_ = true;
   bool retain_mouse_by_entering_ = false;
   bool release_mouse_by_shaking_ = true;
+  bool gamepad_polling_ = true;
+  // Mouse motion deliveries per emulated frame; 0 forwards every event.
+  int mouse_deliveries_ = 1;
  private:
   void SetCaptured(bool captured);
   vamiga::MouseAPI* GetActiveMouse();
+  uint8_t ActiveMousePort() const;
+  uint8_t PortOf(int device_id) const;
+  // Every action bound for the emulator passes through here so that the
+  // movie recorder sees exactly what the emulator sees.
+  void Dispatch(const gui::InputAction& action);
+  void TriggerJoystick(uint8_t port, vamiga::GamePadAction action);
+  void TriggerMouse(vamiga::GamePadAction action);
   bool HandleKeyset(int device_id, const SDL_KeyboardEvent& event, bool is_down);
   void HandleKeyDown(const SDL_KeyboardEvent& event);
   void HandleKeyUp(const SDL_KeyboardEvent& event);
@@ -58,6 +77,11 @@ class InputManager {
   void UpdateGamepads();
   void HandleKeyboard(const SDL_Event& event);
   void UpdateMouseCapture();
+  void StampLatency(const SDL_Event& event);
+  bool PollingGamepads() const { return gamepad_polling_ && !controllers_.empty(); }
+  void SyncPoller();
+  void DrainPoller();
+  void FlushMotion();
   vamiga::VAmiga& emulator_;
   bool window_focused_ = true;
   bool viewport_hovered_ = false;
@@ -69,5 +93,8 @@ class InputManager {
   bool captured_ = false;
   std::map<SDL_JoystickID, std::unique_ptr<SDL_GameController, void (*)(SDL_GameController*)>> controllers_{};
   std::vector<SDL_JoystickID> gamepad_ids_;
+  gui::GamepadPoller poller_;
+  uint64_t reported_drops_ = 0;
+  gui::MotionCoalescer motion_;
 };
 #endif
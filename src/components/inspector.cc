@@ -1,5 +1,6 @@
 #include "inspector.h"
 #include "../compat.h"
+#include "event_timeline.h"
 #include "logic_analyzer.h"
 #include <algorithm>
 #include <charconv>
@@ -1222,6 +1223,9 @@ void Inspector::DrawEvents(vamiga::VAmiga& emu) {
     }
     ImGui::EndTable();
   }
+  if (ImGui::CollapsingHeader("Timeline", ImGuiTreeNodeFlags_DefaultOpen)) {
+    EventTimeline::Instance().Draw(emu);
+  }
 }
 void Inspector::DrawWatchpoints(vamiga::VAmiga& emu) {
   if (!ImGui::CollapsingHeader("Watchpoints", ImGuiTreeNodeFlags_DefaultOpen)) return;
@@ -1294,6 +1298,44 @@ void Inspector::DrawWatchpoints(vamiga::VAmiga& emu) {
   }
 }
 
+void Inspector::UpdateCopperCache(CopperListCache& cache, uint32_t start,
+                                  int rows, bool symbolic,
+                                  vamiga::VAmiga& emu) {
+  const int frame = ImGui::GetFrameCount();
+  const bool same_layout = cache.start == start && cache.symbolic == symbolic &&
+                           static_cast<int>(cache.words.size()) == rows;
+  if (same_layout && cache.frame == frame) return;
+  cache.frame = frame;
+
+  std::vector<uint32_t> words(static_cast<std::size_t>(rows));
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (int i : std::views::iota(0, rows)) {
+    uint32_t addr = start + static_cast<uint32_t>(i * 4);
+    uint32_t hi = emu.mem.debugger.spypeek16(vamiga::Accessor::AGNUS, addr);
+    uint32_t lo = emu.mem.debugger.spypeek16(vamiga::Accessor::AGNUS, addr + 2);
+    words[static_cast<std::size_t>(i)] = (hi << 16) | lo;
+    hash = (hash ^ words[static_cast<std::size_t>(i)]) * 0x100000001B3ULL;
+  }
+  if (same_layout && hash == cache.hash) return;
+
+  cache.lines.resize(static_cast<std::size_t>(rows));
+  cache.changed_frame.resize(static_cast<std::size_t>(rows));
+  for (int i : std::views::iota(0, rows)) {
+    auto idx = static_cast<std::size_t>(i);
+    bool changed = same_layout && words[idx] != cache.words[idx];
+    if (!same_layout || changed) {
+      uint32_t addr = start + static_cast<uint32_t>(i * 4);
+      cache.lines[idx] = emu.agnus.copper.disassemble(addr, symbolic);
+    }
+    if (!same_layout) cache.changed_frame[idx] = -kCopperHighlightFrames;
+    if (changed) cache.changed_frame[idx] = frame;
+  }
+  cache.start = start;
+  cache.symbolic = symbolic;
+  cache.hash = hash;
+  cache.words = std::move(words);
+}
+
 void Inspector::DrawCopperList(int list_idx, bool symbolic, int extra_rows,
                                const vamiga::CopperInfo& info,
                                vamiga::VAmiga& emu) {
@@ -1302,63 +1344,89 @@ void Inspector::DrawCopperList(int list_idx, bool symbolic, int extra_rows,
   if (end < start) std::swap(start, end);
   int native_len = static_cast<int>(std::min<uint32_t>((end - start) / 4, 500));
   int total_rows = std::max(0, native_len + extra_rows);
+
+  auto& cache = copper_cache_[static_cast<std::size_t>(list_idx - 1)];
+  UpdateCopperCache(cache, start, total_rows, symbolic, emu);
+  const int frame = ImGui::GetFrameCount();
+
   ImGui::BeginChild(
       std::format("CopperList{}Child", list_idx).c_str(),
       ImVec2(0, 220), true,
       ImGuiWindowFlags_HorizontalScrollbar);
   ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(6, 2));
-  bool scrolled_to_pc = false;
-  for (int i : std::views::iota(0, total_rows)) {
-    uint32_t addr = start + static_cast<uint32_t>(i * 4);
-    auto bp = emu.copperBreakpoints.guardAt(addr);
-    bool is_bp = bp.has_value();
-    bool bp_enabled = bp && bp->enabled;
-    bool illegal = emu.agnus.copper.isIllegalInstr(addr);
-    bool is_pc = (addr == info.coppc0);
-
-    ImGui::PushID(static_cast<int>(addr));
-    if (is_bp) {
-      ImGui::PushStyleColor(ImGuiCol_Button,
-                            bp_enabled ? ImVec4(0.8f, 0.2f, 0.2f, 1.0f)
-                                       : ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
-      ImGui::PushStyleColor(ImGuiCol_ButtonHovered,
-                            bp_enabled ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f)
-                                       : ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
-      ImGui::PushStyleColor(ImGuiCol_ButtonActive,
-                            bp_enabled ? ImVec4(0.8f, 0.2f, 0.2f, 1.0f)
-                                       : ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
-    }
-    if (ImGui::SmallButton(is_bp ? ICON_FA_CIRCLE : ICON_FA_CIRCLE_DOT)) {
-      if (!is_bp) {
-        emu.copperBreakpoints.setAt(addr);
-      } else if (bp_enabled) {
-        emu.copperBreakpoints.disableAt(addr);
-      } else {
-        emu.copperBreakpoints.enableAt(addr);
+  const float row_height = ImGui::GetTextLineHeight() + 2.0f;
+
+  // Follow the Copper PC only when it moves, so the list stays scrollable.
+  uint32_t& last_pc = copper_last_pc_[list_idx - 1];
+  if (info.coppc0 != last_pc && info.coppc0 >= start &&
+      info.coppc0 < start + static_cast<uint32_t>(total_rows * 4)) {
+    float pc_y = static_cast<float>((info.coppc0 - start) / 4) * row_height;
+    ImGui::SetScrollY(std::max(0.0f, pc_y - ImGui::GetWindowHeight() * 0.5f));
+  }
+  last_pc = info.coppc0;
+
+  ImDrawList* draw_list = ImGui::GetWindowDrawList();
+  ImGuiListClipper clipper;
+  clipper.Begin(total_rows, row_height);
+  while (clipper.Step()) {
+    for (int i : std::views::iota(clipper.DisplayStart, clipper.DisplayEnd)) {
+      auto idx = static_cast<std::size_t>(i);
+      uint32_t addr = start + static_cast<uint32_t>(i * 4);
+      auto bp = emu.copperBreakpoints.guardAt(addr);
+      bool is_bp = bp.has_value();
+      bool bp_enabled = bp && bp->enabled;
+      bool illegal = emu.agnus.copper.isIllegalInstr(addr);
+      bool is_pc = (addr == info.coppc0);
+
+      int age = frame - cache.changed_frame[idx];
+      if (age < kCopperHighlightFrames) {
+        ImVec2 row_min = ImGui::GetCursorScreenPos();
+        float alpha = 0.6f * (1.0f - static_cast<float>(age) / kCopperHighlightFrames);
+        draw_list->AddRectFilled(
+            row_min,
+            ImVec2(row_min.x + ImGui::GetContentRegionAvail().x,
+                   row_min.y + ImGui::GetTextLineHeight()),
+            ImGui::GetColorU32(ImVec4(0.9f, 0.6f, 0.1f, alpha)));
       }
-    }
-    if (is_bp && ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
-      emu.copperBreakpoints.removeAt(addr);
-    }
-    if (is_bp) ImGui::PopStyleColor(3);
-    ImGui::SameLine();
 
-    if (is_pc) ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 1, 0, 1));
-    if (illegal) ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 0.3f, 0.3f, 1));
+      ImGui::PushID(static_cast<int>(addr));
+      if (is_bp) {
+        ImGui::PushStyleColor(ImGuiCol_Button,
+                              bp_enabled ? ImVec4(0.8f, 0.2f, 0.2f, 1.0f)
+                                         : ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,
+                              bp_enabled ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f)
+                                         : ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive,
+                              bp_enabled ? ImVec4(0.8f, 0.2f, 0.2f, 1.0f)
+                                         : ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
+      }
+      if (ImGui::SmallButton(is_bp ? ICON_FA_CIRCLE : ICON_FA_CIRCLE_DOT)) {
+        if (!is_bp) {
+          emu.copperBreakpoints.setAt(addr);
+        } else if (bp_enabled) {
+          emu.copperBreakpoints.disableAt(addr);
+        } else {
+          emu.copperBreakpoints.enableAt(addr);
+        }
+      }
+      if (is_bp && ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
+        emu.copperBreakpoints.removeAt(addr);
+      }
+      if (is_bp) ImGui::PopStyleColor(3);
+      ImGui::SameLine();
+
+      if (is_pc) ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 1, 0, 1));
+      if (illegal) ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 0.3f, 0.3f, 1));
 
-    std::string dis = emu.agnus.copper.disassemble(addr, symbolic);
-    ImGui::Text("%08X: %s", addr, dis.c_str());
+      ImGui::Text("%08X: %s", addr, cache.lines[idx].c_str());
 
-    if (illegal) ImGui::PopStyleColor();
-    if (is_pc) {
-      ImGui::PopStyleColor();
-      if (!scrolled_to_pc) {
-        ImGui::SetScrollHereY();
-        scrolled_to_pc = true;
-      }
+      if (illegal) ImGui::PopStyleColor();
+      if (is_pc) ImGui::PopStyleColor();
+      ImGui::PopID();
     }
-    ImGui::PopID();
   }
+  clipper.End();
   ImGui::PopStyleVar();
   ImGui::EndChild();
 }
@@ -122,6 +122,20 @@ class Inspector {
   void DrawBus(vamiga::VAmiga& emu);
   void DrawCopperList(int list_idx, bool symbolic, int extra_rows,
                       const vamiga::CopperInfo& info, vamiga::VAmiga& emu);
+  // Decoded Copper list, rebuilt only when its location, the symbolic
+  // setting or the hash of its instruction words changes.
+  struct CopperListCache {
+    int frame = -1;
+    uint32_t start = 0;
+    uint64_t hash = 0;
+    bool symbolic = true;
+    std::vector<uint32_t> words;
+    std::vector<std::string> lines;
+    std::vector<int> changed_frame;
+  };
+  static constexpr int kCopperHighlightFrames = 30;
+  void UpdateCopperCache(CopperListCache& cache, uint32_t start, int rows,
+                         bool symbolic, vamiga::VAmiga& emu);
   template <std::unsigned_integral T, std::size_t N>
   static bool HexInput(const char* id, std::array<char, N>& buffer, T& out) {
     if (ImGui::InputText(
@@ -149,6 +163,8 @@ class Inspector {
   int selected_cia_ = 0;
   bool copper_symbolic_[2] = {true, true};
   int copper_extra_rows_[2] = {0, 0};
+  std::array<CopperListCache, 2> copper_cache_{};
+  uint32_t copper_last_pc_[2] = {0, 0};
   int mem_accessor_ = 0;  // 0=CPU,1=Agnus
   int mem_selected_bank_ = 0;
   std::vector<WindowState> windows_{{true, 1, Tab::kCPU}};
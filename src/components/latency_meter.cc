@@ -0,0 +1,221 @@
+#include "latency_meter.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <format>
+#include <fstream>
+
+#include "Infrastructure/OptionTypes.h"
+#include "components/file_picker.h"
+#include "imgui.h"
+#include "resources/IconsFontAwesome6.h"
+
+namespace gui {
+
+namespace {
+constexpr std::array<std::string_view, 4> kSourceNames = {"Keyboard", "Mouse button",
+                                                          "Mouse motion", "Gamepad"};
+
+double Percentile(std::vector<double>& sorted, double p) {
+  if (sorted.empty()) return 0.0;
+  const auto idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+// Emulated frame number for a CPU clock sampled at beam line `vpos`.
+int64_t FrameAt(vamiga::VAmiga& emu, int64_t clock, long vpos) {
+  const bool ntsc = emu.get(vamiga::Opt::AMIGA_VIDEO_FORMAT) ==
+                    static_cast<vamiga::i64>(vamiga::TV::NTSC);
+  const double line_len = ntsc ? 227.5 : 227.0;
+  const double frame_len = line_len * (ntsc ? 262.5 : 313.0);
+  // The CPU runs at twice the DMA clock.
+  const double start = static_cast<double>(clock / 2) - static_cast<double>(vpos) * line_len;
+  return std::llround(start / frame_len);
+}
+}  // namespace
+
+LatencyMeter& LatencyMeter::Instance() {
+  static LatencyMeter instance;
+  return instance;
+}
+
+LatencyMeter::~LatencyMeter() {
+  if (worker_.joinable()) {
+    stop_ = true;
+    queued_.fetch_add(1);
+    queued_.notify_one();
+    worker_.join();
+  }
+}
+
+void LatencyMeter::SetEnabled(bool enabled, vamiga::VAmiga& emu) {
+  if (enabled == enabled_) return;
+  if (enabled) {
+    emu_ = &emu;
+    stop_ = false;
+    queued_ = 0;
+    enabled_ = true;
+    worker_ = std::thread(&LatencyMeter::Run, this, &emu);
+  } else {
+    enabled_ = false;
+    stop_ = true;
+    queued_.fetch_add(1);
+    queued_.notify_one();
+    if (worker_.joinable()) worker_.join();
+    Pending drop;
+    while (queue_.Pop(drop)) {
+    }
+  }
+}
+
+void LatencyMeter::Stamp(Source source, uint32_t sdl_timestamp) {
+  if (!enabled_) return;
+  Stamp(source, static_cast<double>(SDL_GetTicks() - sdl_timestamp), SDL_GetPerformanceCounter(),
+        emu_->cpu.getInfo().clock);
+}
+
+void LatencyMeter::Stamp(Source source, double queue_ms, uint64_t injected, int64_t clock) {
+  if (!enabled_) return;
+  if (!queue_.Push({source, queue_ms, injected, clock})) return;
+  if (queued_.fetch_add(1, std::memory_order_release) == 0) queued_.notify_one();
+}
+
+void LatencyMeter::Run(vamiga::VAmiga* emu) {
+  const double ticks_per_ms = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0;
+  std::vector<Pending> pending;
+  while (!stop_) {
+    if (pending.empty()) queued_.wait(0, std::memory_order_acquire);
+    Pending p;
+    int32_t popped = 0;
+    while (queue_.Pop(p)) {
+      pending.push_back(p);
+      ++popped;
+    }
+    if (popped > 0) queued_.fetch_sub(popped, std::memory_order_acq_rel);
+    if (pending.empty()) continue;
+
+    std::this_thread::sleep_for(kProbeInterval);
+    const int64_t clock = emu->cpu.getInfo().clock;
+    const long vpos = static_cast<long>(emu->agnus.getInfo().vpos);
+    const uint64_t now = SDL_GetPerformanceCounter();
+    std::erase_if(pending, [&](const Pending& e) {
+      const double ms = static_cast<double>(now - e.injected) / ticks_per_ms;
+      if (clock > e.clock) {
+        Record({e.source, e.queue_ms, ms, clock, FrameAt(*emu, clock, vpos), vpos});
+        return true;
+      }
+      if (ms > kGiveUpMs) {
+        std::lock_guard lock(mutex_);
+        ++lost_;
+        return true;
+      }
+      return false;
+    });
+  }
+}
+
+void LatencyMeter::Record(const Sample& sample) {
+  std::lock_guard lock(mutex_);
+  if (samples_.size() < kCapacity) {
+    samples_.push_back(sample);
+  } else {
+    samples_[next_] = sample;
+  }
+  next_ = (next_ + 1) % kCapacity;
+  ++total_;
+}
+
+void LatencyMeter::Clear() {
+  std::lock_guard lock(mutex_);
+  samples_.clear();
+  next_ = 0;
+  total_ = 0;
+  lost_ = 0;
+}
+
+bool LatencyMeter::Export(const std::filesystem::path& path) const {
+  std::ofstream file(path);
+  if (!file) return false;
+  file << "source,sdl_queue_ms,resume_ms,total_ms,cpu_clock,frame,vpos\n";
+  std::lock_guard lock(mutex_);
+  // Oldest first: once the ring has wrapped, it starts at next_.
+  const std::size_t first = samples_.size() < kCapacity ? 0 : next_;
+  for (std::size_t i = 0; i < samples_.size(); ++i) {
+    const auto& s = samples_[(first + i) % samples_.size()];
+    file << std::format("{},{:.3f},{:.3f},{:.3f},{},{},{}\n",
+                        kSourceNames[static_cast<std::size_t>(s.source)], s.queue_ms,
+                        s.resume_ms, s.Total(), s.clock, s.frame, s.vpos);
+  }
+  return static_cast<bool>(file);
+}
+
+void LatencyMeter::Draw(bool* p_open, vamiga::VAmiga& emu) {
+  if (!p_open || !*p_open) {
+    SetEnabled(false, emu);
+    return;
+  }
+  ImGui::SetNextWindowSize(ImVec2(420, 380), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Input Latency", p_open)) {
+    ImGui::End();
+    return;
+  }
+
+  bool enabled = enabled_;
+  if (ImGui::Checkbox("Measure", &enabled)) SetEnabled(enabled, emu);
+  ImGui::SameLine();
+  if (ImGui::Button(ICON_FA_TRASH " Clear")) Clear();
+  ImGui::SameLine();
+  if (ImGui::Button(ICON_FA_FILE_EXPORT " Export CSV")) {
+    PickerOptions opts;
+    opts.title = "Export Latency Log";
+    opts.mode = PickerMode::kSaveFile;
+    opts.filters = "CSV Files (*.csv){.csv}";
+    FilePicker::Instance().Open("LatencyExport", opts, [this](auto p) { Export(p); });
+  }
+
+  static constexpr std::array kFilterItems = {"All", "Keyboard", "Mouse button",
+                                              "Mouse motion", "Gamepad"};
+  ImGui::SetNextItemWidth(140);
+  ImGui::Combo("Source", &source_filter_, kFilterItems.data(), static_cast<int>(kFilterItems.size()));
+
+  std::array<float, kBuckets> histogram{};
+  std::vector<double> totals;
+  double queue_sum = 0.0, resume_sum = 0.0;
+  uint64_t total = 0, lost = 0;
+  {
+    std::lock_guard lock(mutex_);
+    totals.reserve(samples_.size());
+    for (const auto& s : samples_) {
+      if (source_filter_ > 0 && static_cast<int>(s.source) != source_filter_ - 1) continue;
+      const double t = s.Total();
+      totals.push_back(t);
+      queue_sum += s.queue_ms;
+      resume_sum += s.resume_ms;
+      const int bucket = std::min(static_cast<int>(t / kBucketMs), kBuckets - 1);
+      histogram[static_cast<std::size_t>(bucket)] += 1.0f;
+    }
+    total = total_;
+    lost = lost_;
+  }
+  std::ranges::sort(totals);
+
+  const double n = static_cast<double>(std::max<std::size_t>(totals.size(), 1));
+  ImGui::Text("Samples: %zu shown, %llu total, %llu timed out", totals.size(),
+              static_cast<unsigned long long>(total), static_cast<unsigned long long>(lost));
+  ImGui::Text("Mean: %.2f ms (SDL queue %.2f + until emulator ran on %.2f)",
+              (queue_sum + resume_sum) / n, queue_sum / n, resume_sum / n);
+  ImGui::Text("p50 %.2f   p95 %.2f   p99 %.2f   max %.2f ms", Percentile(totals, 0.50),
+              Percentile(totals, 0.95), Percentile(totals, 0.99),
+              totals.empty() ? 0.0 : totals.back());
+
+  std::string overlay = std::format("0 .. {:.0f} ms ({:.0f} ms buckets, last is overflow)",
+                                    kBuckets * kBucketMs, kBucketMs);
+  ImGui::PlotHistogram("##latency", histogram.data(), kBuckets, 0, overlay.c_str(), 0.0f,
+                       FLT_MAX, ImVec2(-1, 160));
+  if (!enabled_) ImGui::TextDisabled("Enable 'Measure' to stamp incoming input events.");
+  ImGui::End();
+}
+
+}
@@ -0,0 +1,93 @@
+#ifndef LINUXGUI_COMPONENTS_LATENCY_METER_H_
+#define LINUXGUI_COMPONENTS_LATENCY_METER_H_
+
+#include <SDL.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <utility>
+#include "VAmiga.h"
+#undef unreachable
+#define unreachable std::unreachable()
+#include "services/spsc_queue.h"
+
+namespace gui {
+
+// Measures how long input takes from SDL to the emulator. Events are stamped
+// when the frontend injects them; a probe thread then watches the CPU clock
+// and records the moment the emulator has run past the injection point. That
+// is when the input became visible to emulated code, not when a program read
+// the port or CIA, and it includes up to one probe interval of polling.
+class LatencyMeter {
+ public:
+  enum class Source : uint8_t { kKeyboard, kMouseButton, kMouseMotion, kGamepad };
+
+  struct Sample {
+    Source source = Source::kKeyboard;
+    double queue_ms = 0.0;   // SDL timestamp until the frontend handled it
+    double resume_ms = 0.0;  // injection until the emulator was seen running on
+    int64_t clock = 0;       // CPU clock when that was observed
+    int64_t frame = 0;       // emulated frame at that moment
+    long vpos = 0;           // beam line at that moment
+    double Total() const { return queue_ms + resume_ms; }
+  };
+
+  static constexpr std::size_t kCapacity = 4096;
+  static constexpr int kBuckets = 50;
+  static constexpr float kBucketMs = 1.0f;
+
+  static LatencyMeter& Instance();
+  ~LatencyMeter();
+
+  void SetEnabled(bool enabled, vamiga::VAmiga& emu);
+  bool IsEnabled() const { return enabled_; }
+
+  // Call right after the event has been forwarded to the emulator.
+  void Stamp(Source source, uint32_t sdl_timestamp);
+  // For input injected elsewhere: `injected` is the SDL performance counter
+  // and `clock` the CPU clock at the moment of injection.
+  void Stamp(Source source, double queue_ms, uint64_t injected, int64_t clock);
+
+  void Draw(bool* p_open, vamiga::VAmiga& emu);
+  bool Export(const std::filesystem::path& path) const;
+  void Clear();
+
+ private:
+  struct Pending {
+    Source source;
+    double queue_ms;
+    uint64_t injected;  // SDL performance counter
+    int64_t clock;      // CPU clock at injection
+  };
+
+  LatencyMeter() = default;
+  void Run(vamiga::VAmiga* emu);
+  void Record(const Sample& sample);
+
+  static constexpr auto kProbeInterval = std::chrono::microseconds(250);
+  static constexpr double kGiveUpMs = 1000.0;
+
+  std::atomic<bool> enabled_ = false;
+  vamiga::VAmiga* emu_ = nullptr;
+  SpscQueue<Pending, 1024> queue_;
+  std::atomic<int32_t> queued_ = 0;
+  std::atomic<bool> stop_ = false;
+  std::thread worker_;
+
+  mutable std::mutex mutex_;
+  std::vector<Sample> samples_;
+  std::size_t next_ = 0;
+  uint64_t total_ = 0;
+  uint64_t lost_ = 0;
+
+  int source_filter_ = 0;
+};
+
+}
+
+#endif
@@ -1,15 +1,128 @@
 #include "logic_analyzer.h"
+#include <algorithm>
 #include <array>
 #include <charconv>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <format>
 #include <ranges>
+#include <span>
+#include <thread>
 #include "Misc/LogicAnalyzer/LogicAnalyzerTypes.h"
 #include "Infrastructure/OptionTypes.h"
+#include "components/file_picker.h"
+#include "components/movie_player.h"
 #include "resources/IconsFontAwesome6.h"
 
 namespace gui {
 
+namespace {
+using Clock = std::chrono::steady_clock;
+constexpr auto kStepTimeout = std::chrono::seconds(1);
+// Time per GUI frame spent stepping lines during a capture.
+constexpr auto kCaptureBudget = std::chrono::milliseconds(12);
+
+struct OwnerStyle {
+  std::string_view label;
+  ImU32 color;
+};
+
+constexpr OwnerStyle StyleFor(vamiga::BusOwner owner) {
+  switch (owner) {
+    case vamiga::BusOwner::CPU: return {"CPU", IM_COL32(100, 150, 250, 255)};
+    case vamiga::BusOwner::REFRESH: return {"REF", IM_COL32(100, 100, 100, 255)};
+    case vamiga::BusOwner::DISK: return {"DSK", IM_COL32(200, 200, 50, 255)};
+    case vamiga::BusOwner::AUD0: return {"AUD0", IM_COL32(200, 100, 50, 255)};
+    case vamiga::BusOwner::AUD1: return {"AUD1", IM_COL32(200, 100, 50, 255)};
+    case vamiga::BusOwner::AUD2: return {"AUD2", IM_COL32(200, 100, 50, 255)};
+    case vamiga::BusOwner::AUD3: return {"AUD3", IM_COL32(200, 100, 50, 255)};
+    case vamiga::BusOwner::BPL1: return {"BPL1", IM_COL32(100, 150, 255, 255)};
+    case vamiga::BusOwner::BPL2: return {"BPL2", IM_COL32(100, 150, 255, 255)};
+    case vamiga::BusOwner::BPL3: return {"BPL3", IM_COL32(100, 150, 255, 255)};
+    case vamiga::BusOwner::BPL4: return {"BPL4", IM_COL32(100, 150, 255, 255)};
+    case vamiga::BusOwner::BPL5: return {"BPL5", IM_COL32(100, 150, 255, 255)};
+    case vamiga::BusOwner::BPL6: return {"BPL6", IM_COL32(100, 150, 255, 255)};
+    case vamiga::BusOwner::SPRITE0: return {"SPR0", IM_COL32(200, 50, 200, 255)};
+    case vamiga::BusOwner::SPRITE1: return {"SPR1", IM_COL32(200, 50, 200, 255)};
+    case vamiga::BusOwner::SPRITE2: return {"SPR2", IM_COL32(200, 50, 200, 255)};
+    case vamiga::BusOwner::SPRITE3: return {"SPR3", IM_COL32(200, 50, 200, 255)};
+    case vamiga::BusOwner::SPRITE4: return {"SPR4", IM_COL32(200, 50, 200, 255)};
+    case vamiga::BusOwner::SPRITE5: return {"SPR5", IM_COL32(200, 50, 200, 255)};
+    case vamiga::BusOwner::SPRITE6: return {"SPR6", IM_COL32(200, 50, 200, 255)};
+    case vamiga::BusOwner::SPRITE7: return {"SPR7", IM_COL32(200, 50, 200, 255)};
+    case vamiga::BusOwner::COPPER: return {"COP", IM_COL32(50, 200, 50, 255)};
+    case vamiga::BusOwner::BLITTER: return {"BLT", IM_COL32(50, 200, 200, 255)};
+    default: return {"-", 0};
+  }
+}
+
+constexpr auto kOwnerStyles = [] {
+  std::array<OwnerStyle, 256> table{};
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    table[i] = StyleFor(static_cast<vamiga::BusOwner>(i));
+  }
+  table[LogicAnalyzer::kNoOwner] = {"", 0};
+  return table;
+}();
+
+constexpr int GroupFor(vamiga::BusOwner owner) {
+  switch (owner) {
+    case vamiga::BusOwner::CPU: return LogicAnalyzer::kBusCpu;
+    case vamiga::BusOwner::REFRESH: return LogicAnalyzer::kBusRefresh;
+    case vamiga::BusOwner::DISK: return LogicAnalyzer::kBusDisk;
+    case vamiga::BusOwner::AUD0:
+    case vamiga::BusOwner::AUD1:
+    case vamiga::BusOwner::AUD2:
+    case vamiga::BusOwner::AUD3: return LogicAnalyzer::kBusAudio;
+    case vamiga::BusOwner::BPL1:
+    case vamiga::BusOwner::BPL2:
+    case vamiga::BusOwner::BPL3:
+    case vamiga::BusOwner::BPL4:
+    case vamiga::BusOwner::BPL5:
+    case vamiga::BusOwner::BPL6: return LogicAnalyzer::kBusBitplane;
+    case vamiga::BusOwner::SPRITE0:
+    case vamiga::BusOwner::SPRITE1:
+    case vamiga::BusOwner::SPRITE2:
+    case vamiga::BusOwner::SPRITE3:
+    case vamiga::BusOwner::SPRITE4:
+    case vamiga::BusOwner::SPRITE5:
+    case vamiga::BusOwner::SPRITE6:
+    case vamiga::BusOwner::SPRITE7: return LogicAnalyzer::kBusSprite;
+    case vamiga::BusOwner::COPPER: return LogicAnalyzer::kBusCopper;
+    case vamiga::BusOwner::BLITTER: return LogicAnalyzer::kBusBlitter;
+    default: return LogicAnalyzer::kBusFree;
+  }
+}
+
+constexpr auto kBusGroupOf = [] {
+  std::array<uint8_t, 256> table{};
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    table[i] = static_cast<uint8_t>(GroupFor(static_cast<vamiga::BusOwner>(i)));
+  }
+  return table;
+}();
+
+std::string_view FormatValue(std::array<char, 16>& buf, uint32_t value,
+                             bool hex, int min_digits = 0) {
+  char* first = buf.data();
+  auto [ptr, _] = std::to_chars(first, first + buf.size(), value, hex ? 16 : 10);
+  int len = static_cast<int>(ptr - first);
+  if (len < min_digits) {
+    std::memmove(first + (min_digits - len), first, static_cast<std::size_t>(len));
+    std::fill(first, first + (min_digits - len), '0');
+    len = min_digits;
+  }
+  if (hex) {
+    for (char& c : std::span(first, static_cast<std::size_t>(len))) {
+      if (c >= 'a' && c <= 'f') c = static_cast<char>(c - 'a' + 'A');
+    }
+  }
+  buf[static_cast<std::size_t>(len)] = 0;
+  return {first, static_cast<std::size_t>(len)};
+}
+}  // namespace
+
 const std::vector<LogicAnalyzer::ProbePreset> LogicAnalyzer::kPresets = {
     {"None", 0, 0},
     {"-", 0, 0},
@@ -38,96 +151,320 @@ LogicAnalyzer& LogicAnalyzer::Instance() {
   return instance;
 }
 
-LogicAnalyzer::LogicAnalyzer() {}
+LogicAnalyzer::LogicAnalyzer() : bus_history_(kBusHistory) {}
+
+std::string_view LogicAnalyzer::BusGroupName(int group) {
+  static constexpr std::array<std::string_view, kBusGroups> kNames = {
+      "CPU", "Bitplane", "Copper", "Blitter", "Sprite", "Disk", "Audio", "Refresh", "Free"};
+  return kNames[static_cast<std::size_t>(group)];
+}
+
+ImU32 LogicAnalyzer::BusGroupColor(int group) {
+  static constexpr std::array<ImU32, kBusGroups> kColors = {
+      IM_COL32(100, 150, 250, 255), IM_COL32(60, 90, 200, 255), IM_COL32(50, 200, 50, 255),
+      IM_COL32(50, 200, 200, 255), IM_COL32(200, 50, 200, 255), IM_COL32(200, 200, 50, 255),
+      IM_COL32(200, 100, 50, 255), IM_COL32(100, 100, 100, 255), IM_COL32(45, 45, 45, 255)};
+  return kColors[static_cast<std::size_t>(group)];
+}
+
+void LogicAnalyzer::FoldBusCounts() {
+  // Shares of a partly captured frame would depend on which lines were
+  // seen, so only complete frames enter the history.
+  if (!bus_frame_whole_) {
+    bus_counts_.fill(0);
+    return;
+  }
+  BusUsage usage;
+  usage.frame = frame_;
+  std::array<uint32_t, kBusGroups> groups{};
+  for (std::size_t i = 0; i < bus_counts_.size(); ++i) {
+    if (i == kNoOwner || bus_counts_[i] == 0) continue;
+    groups[kBusGroupOf[i]] += bus_counts_[i];
+    usage.samples += bus_counts_[i];
+  }
+  if (usage.samples > 0) {
+    for (int g : std::views::iota(0, static_cast<int>(kBusGroups))) {
+      usage.share[static_cast<std::size_t>(g)] =
+          static_cast<float>(groups[static_cast<std::size_t>(g)]) / static_cast<float>(usage.samples);
+    }
+  }
+  bus_counts_.fill(0);
+  std::rotate(bus_history_.begin(), bus_history_.begin() + 1, bus_history_.end());
+  bus_history_.back() = usage;
+}
+
+LogicAnalyzer::CaptureRing::CaptureRing()
+    : owner(static_cast<std::size_t>(kDepth) * kSegments, kNoOwner),
+      addr(static_cast<std::size_t>(kDepth) * kSegments, 0),
+      data(static_cast<std::size_t>(kDepth) * kSegments, 0) {
+  for (auto& p : probe) p.assign(static_cast<std::size_t>(kDepth) * kSegments, kNoValue);
+  frame.fill(-1);
+}
 
 void LogicAnalyzer::Update(vamiga::VAmiga& emu) {
-  auto la_info = emu.agnus.logicAnalyzer.getInfo();
-  if (!la_info.busOwner) return;
+  if (!capturing_) return;
+  const auto deadline = Clock::now() + kCaptureBudget;
+  do {
+    if (!StepLine(emu)) {
+      StopCapture(emu, false);
+      capture_status_ = "Capture stopped: the emulator did not advance";
+      return;
+    }
+    CaptureLine(emu);
+  } while (capturing_ && Clock::now() < deadline);
+}
 
-  long hpos = emu.agnus.getInfo().hpos;
+bool LogicAnalyzer::StartCapture(vamiga::VAmiga& emu) {
+  if (capturing_) return true;
+  // Movies step the emulator themselves.
+  if (MoviePlayer::Instance().GetState() != MoviePlayer::State::kIdle) {
+    capture_status_ = "Cannot capture while a movie is recorded or replayed";
+    return false;
+  }
+  resume_after_capture_ = emu.isRunning();
+  emu.pause();
+  capture_status_.clear();
+  capturing_ = true;
+  return true;
+}
 
-  for (int i : std::views::iota(0, kSegments)) {
-    labels_[i] = "";
-    colors_[i] = 0;
-    
-    if (i < hpos) {
-      vamiga::BusOwner owner = la_info.busOwner[i];
-      switch (owner) {
-        case vamiga::BusOwner::CPU:
-          labels_[i] = "CPU";
-          colors_[i] = IM_COL32(100, 150, 250, 255);
-          break;
-        case vamiga::BusOwner::REFRESH:
-          labels_[i] = "REF";
-          colors_[i] = IM_COL32(100, 100, 100, 255);
-          break;
-        case vamiga::BusOwner::DISK:
-          labels_[i] = "DSK";
-          colors_[i] = IM_COL32(200, 200, 50, 255);
-          break;
-        case vamiga::BusOwner::AUD0:
-        case vamiga::BusOwner::AUD1:
-        case vamiga::BusOwner::AUD2:
-        case vamiga::BusOwner::AUD3:
-          labels_[i] = std::format("AUD{}", static_cast<int>(owner) - static_cast<int>(vamiga::BusOwner::AUD0));
-          colors_[i] = IM_COL32(200, 100, 50, 255);
-          break;
-        case vamiga::BusOwner::BPL1:
-        case vamiga::BusOwner::BPL2:
-        case vamiga::BusOwner::BPL3:
-        case vamiga::BusOwner::BPL4:
-        case vamiga::BusOwner::BPL5:
-        case vamiga::BusOwner::BPL6:
-          labels_[i] = std::format("BPL{}", static_cast<int>(owner) - static_cast<int>(vamiga::BusOwner::BPL1) + 1);
-          colors_[i] = IM_COL32(100, 150, 255, 255);
-          break;
-        case vamiga::BusOwner::SPRITE0:
-        case vamiga::BusOwner::SPRITE1:
-        case vamiga::BusOwner::SPRITE2:
-        case vamiga::BusOwner::SPRITE3:
-        case vamiga::BusOwner::SPRITE4:
-        case vamiga::BusOwner::SPRITE5:
-        case vamiga::BusOwner::SPRITE6:
-        case vamiga::BusOwner::SPRITE7:
-          labels_[i] = std::format("SPR{}", static_cast<int>(owner) - static_cast<int>(vamiga::BusOwner::SPRITE0));
-          colors_[i] = IM_COL32(200, 50, 200, 255);
+void LogicAnalyzer::StopCapture(vamiga::VAmiga& emu, bool resume) {
+  if (!capturing_) return;
+  capturing_ = false;
+  capture_next_cycle_ = -1;
+  // Lines run while not capturing are a gap in the VCD.
+  EndVcdLine();
+  // Triggers need continuous data.
+  if (trigger_state_ == TriggerState::kArmed || trigger_state_ == TriggerState::kFired) {
+    trigger_state_ = TriggerState::kIdle;
+  }
+  if (resume && resume_after_capture_) emu.run();
+}
+
+bool LogicAnalyzer::StepLine(vamiga::VAmiga& emu) {
+  const int64_t before = emu.cpu.getInfo().clock;
+  emu.finishLine();
+  // finishLine() is queued; the line is done once the emulator has moved
+  // and is paused again.
+  const auto deadline = Clock::now() + kStepTimeout;
+  while (emu.isRunning() || emu.cpu.getInfo().clock == before) {
+    if (Clock::now() > deadline) return false;
+    emu.wakeUp();
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+void LogicAnalyzer::TrackFrame(vamiga::VAmiga& emu, int64_t line_cycle, long vpos) {
+  // NTSC lines alternate between 227 and 228 DMA cycles and frames
+  // between 262 and 263 lines.
+  const bool ntsc = emu.get(vamiga::Opt::AMIGA_VIDEO_FORMAT) ==
+                    static_cast<vamiga::i64>(vamiga::TV::NTSC);
+  const double line_len = ntsc ? 227.5 : 227.0;
+  const double frame_len = line_len * (ntsc ? 262.5 : 313.0);
+  const int64_t start = line_cycle - std::llround(static_cast<double>(vpos) * line_len);
+  const double elapsed = static_cast<double>(start - frame_start_) / frame_len;
+  if (frame_ < 0 || elapsed < -0.5) {
+    // First line, or the clock went backwards after a reset or a loaded
+    // snapshot.
+    if (frame_ >= 0 && vcd_.IsOpen()) {
+      StopVcd();
+      vcd_status_ = "VCD stopped: the emulator clock went backwards";
+    }
+    frame_ = std::llround(static_cast<double>(start) / frame_len);
+    frame_start_ = start;
+    bus_counts_.fill(0);
+    return;
+  }
+  if (elapsed < 0.5) return;
+  FoldBusCounts();
+  frame_ += std::llround(elapsed);
+  frame_start_ = start;
+}
+
+void LogicAnalyzer::CaptureLine(vamiga::VAmiga& emu) {
+  // The emulator is paused, so position, clock and bus data all describe
+  // the same instant.
+  const auto agnus = emu.agnus.getInfo();
+  const long vpos = agnus.vpos;
+  const auto la_info = emu.agnus.logicAnalyzer.getInfo();
+  if (!la_info.busOwner || vpos < 0 || vpos >= kLines) return;
+  // finishLine() stops on the last cycle of the line, after it executed.
+  const int cycles = static_cast<int>(std::clamp<long>(agnus.hpos + 1, 0, kSegments));
+  // Two CPU cycles per DMA cycle.
+  const int64_t line_cycle = emu.cpu.getInfo().clock / 2 - cycles;
+  const bool contiguous = line_cycle == capture_next_cycle_;
+  if (!contiguous) bus_frame_whole_ = false;
+  TrackFrame(emu, line_cycle, vpos);
+  if (vpos == 0) bus_frame_whole_ = true;
+  if (!contiguous) {
+    // Not adjacent to the previous line: nothing carries over.
+    last_probe_.fill(kNoValue);
+    armed_sample_ = samples_;
+  }
+  capture_next_cycle_ = line_cycle + cycles;
+
+  head_slot_ = (head_slot_ + 1) % kDepth;
+  count_ = std::min(count_ + 1, kDepth);
+  ++samples_;
+  const auto slot = static_cast<std::size_t>(head_slot_);
+  ring_.frame[slot] = frame_;
+  ring_.cycle[slot] = line_cycle;
+  ring_.line[slot] = static_cast<int16_t>(vpos);
+  ring_.cycles[slot] = static_cast<int16_t>(cycles);
+
+  const std::size_t base = ring_.Offset(head_slot_);
+  for (int i : std::views::iota(0, cycles)) {
+    const auto idx = base + static_cast<std::size_t>(i);
+    ring_.owner[idx] = static_cast<uint8_t>(la_info.busOwner[i]);
+    ring_.addr[idx] = static_cast<uint32_t>(la_info.addrBus[i]);
+    ring_.data[idx] = static_cast<uint16_t>(la_info.dataBus[i]);
+    bus_counts_[ring_.owner[idx]]++;
+  }
+  for (int c : std::views::iota(0, kProbes)) {
+    const vamiga::isize* channel = la_info.channel[c];
+    auto& dst = ring_.probe[static_cast<std::size_t>(c)];
+    for (int i : std::views::iota(0, cycles)) {
+      dst[base + static_cast<std::size_t>(i)] =
+          channel ? static_cast<int32_t>(channel[i]) : kNoValue;
+    }
+  }
+  if (vcd_.IsOpen()) {
+    if (line_cycle != vcd_next_cycle_) EndVcdLine();
+    std::array<uint64_t, 3 + kProbes> values{};
+    for (int i : std::views::iota(0, cycles)) {
+      const auto idx = base + static_cast<std::size_t>(i);
+      values[0] = ring_.owner[idx];
+      values[1] = ring_.addr[idx];
+      values[2] = ring_.data[idx];
+      for (int c : std::views::iota(0, kProbes)) {
+        int32_t v = ring_.probe[static_cast<std::size_t>(c)][idx];
+        values[static_cast<std::size_t>(3 + c)] =
+            v == kNoValue ? VcdWriter::kUnknown : static_cast<uint64_t>(static_cast<uint32_t>(v));
+      }
+      vcd_.Sample(static_cast<uint64_t>(line_cycle + i) * vcd_ps_per_cycle_, values);
+    }
+    vcd_next_cycle_ = line_cycle + cycles;
+    if (vcd_.Overflowed()) {
+      StopVcd();
+      vcd_status_ = "VCD stopped: the disk could not keep up";
+    }
+  }
+  if (trigger_state_ == TriggerState::kArmed || trigger_state_ == TriggerState::kFired) {
+    CheckTrigger(emu, base, 0, cycles, line_cycle, static_cast<int>(vpos));
+  }
+}
+
+void LogicAnalyzer::CheckTrigger(vamiga::VAmiga& emu, std::size_t base,
+                                 int from, int to, int64_t line_cycle, int line) {
+  if (trigger_state_ == TriggerState::kArmed) {
+    // A hit only counts once the pre-trigger window is in the ring.
+    const bool filled = samples_ - armed_sample_ > trigger_.pre_lines;
+    const auto& probe = ring_.probe[static_cast<std::size_t>(trigger_.probe)];
+    for (int i : std::views::iota(from, to)) {
+      const auto idx = base + static_cast<std::size_t>(i);
+      bool hit = false;
+      switch (trigger_.kind) {
+        case TriggerKind::kAddress:
+          hit = ((ring_.addr[idx] ^ trigger_.value) & trigger_.mask) == 0;
           break;
-        case vamiga::BusOwner::COPPER:
-          labels_[i] = "COP";
-          colors_[i] = IM_COL32(50, 200, 50, 255);
+        case TriggerKind::kOwner:
+          hit = ring_.owner[idx] == trigger_.value;
           break;
-        case vamiga::BusOwner::BLITTER:
-          labels_[i] = "BLT";
-          colors_[i] = IM_COL32(50, 200, 200, 255);
+        case TriggerKind::kProbe:
+          hit = probe[idx] != kNoValue &&
+                ((static_cast<uint32_t>(probe[idx]) ^ trigger_.value) & trigger_.mask) == 0;
           break;
-        default:
-          labels_[i] = "-";
-          colors_[i] = 0;
+        case TriggerKind::kIplChange: {
+          // last_probe_ holds the previous cycle; it is reset on gaps.
+          int32_t v = probe[idx];
+          hit = v != kNoValue && last_probe_[static_cast<std::size_t>(trigger_.probe)] != kNoValue &&
+                v != last_probe_[static_cast<std::size_t>(trigger_.probe)];
+          if (v != kNoValue) last_probe_[static_cast<std::size_t>(trigger_.probe)] = v;
           break;
+        }
+      }
+      if (hit && filled) {
+        trigger_hit_ = {line_cycle + i, frame_, line, i, samples_};
+        trigger_state_ = TriggerState::kFired;
+        break;
       }
-
-      data_[0][i] = la_info.addrBus[i];
-      data_[1][i] = la_info.dataBus[i];
-    } else {
-        data_[0][i] = -1;
-        data_[1][i] = -1;
     }
   }
+  if (trigger_state_ != TriggerState::kFired) return;
+
+  if (samples_ - trigger_hit_.sample < trigger_.post_lines) return;
+  trigger_state_ = TriggerState::kDone;
+  // Ending the capture freezes the ring; pausing leaves the emulator where
+  // the post-trigger window ends.
+  StopCapture(emu, trigger_.action == TriggerAction::kFreeze);
+  ShowLine(trigger_hit_.frame, trigger_hit_.line);
+}
+
+bool LogicAnalyzer::StartVcd(vamiga::VAmiga& emu, const std::filesystem::path& path) {
+  bool ntsc = emu.get(vamiga::Opt::AMIGA_VIDEO_FORMAT) ==
+              static_cast<vamiga::i64>(vamiga::TV::NTSC);
+  // One DMA cycle is one colour clock period.
+  vcd_ps_per_cycle_ = ntsc ? 279365 : 281937;
+  std::vector<VcdWriter::Signal> signals = {
+      {"bus_owner", 8}, {"addr_bus", 24}, {"data_bus", 16},
+      {"probe0", 16},   {"probe1", 16},   {"probe2", 16}, {"probe3", 16}};
+  if (!vcd_.Open(path, std::move(signals), "1 ps", "amiga")) {
+    vcd_status_ = std::format("Could not write {}", path.string());
+    return false;
+  }
+  vcd_status_.clear();
+  vcd_next_cycle_ = -1;
+  // Only captured lines reach the file.
+  StartCapture(emu);
+  return true;
+}
+
+void LogicAnalyzer::StopVcd() {
+  EndVcdLine();
+  vcd_.Close();
+}
 
-  const vamiga::isize* channels[4] = {la_info.channel[0], la_info.channel[1],
-                            la_info.channel[2], la_info.channel[3]};
+void LogicAnalyzer::EndVcdLine() {
+  if (!vcd_.IsOpen() || vcd_next_cycle_ < 0) return;
+  std::array<uint64_t, 3 + kProbes> unknown;
+  unknown.fill(VcdWriter::kUnknown);
+  vcd_.Sample(static_cast<uint64_t>(vcd_next_cycle_) * vcd_ps_per_cycle_, unknown);
+  vcd_next_cycle_ = -1;
+}
 
-  for (int c : std::views::iota(0, 4)) {
-    if (channels[c]) {
-      for (int i : std::views::iota(0, kSegments)) {
-        data_[c + 2][i] = (i < hpos) ? static_cast<int>(channels[c][i]) : -1;
-      }
-    } else {
-      for (int i : std::views::iota(0, kSegments)) {
-        data_[c + 2][i] = -1;
-      }
-    }
+int LogicAnalyzer::FindLine(int64_t frame, int line) const {
+  for (int age : std::views::iota(0, count_)) {
+    const auto slot = static_cast<std::size_t>((head_slot_ - age + kDepth) % kDepth);
+    if (ring_.frame[slot] == frame && ring_.line[slot] == line) return age;
   }
+  return -1;
+}
+
+void LogicAnalyzer::ShowLine(int64_t frame, int line) {
+  follow_beam_ = false;
+  view_frame_ = static_cast<int>(std::clamp<int64_t>(GetLine(0).frame - frame, 0, kFrames - 1));
+  view_line_ = line;
+}
+
+LogicAnalyzer::LineView LogicAnalyzer::GetLine(int age) const {
+  LineView view;
+  const int slot = (head_slot_ - std::clamp(age, 0, kDepth - 1) + kDepth) % kDepth;
+  const auto tag = static_cast<std::size_t>(slot);
+  const std::size_t base = ring_.Offset(slot);
+  if (age >= 0 && age < count_) {
+    view.frame = ring_.frame[tag];
+    view.line = ring_.line[tag];
+    view.cycle = ring_.cycle[tag];
+    view.cycles = ring_.cycles[tag];
+  }
+  view.owner = ring_.owner.data() + base;
+  view.addr = ring_.addr.data() + base;
+  view.data = ring_.data.data() + base;
+  for (int c : std::views::iota(0, kProbes)) {
+    view.probe[static_cast<std::size_t>(c)] = ring_.probe[static_cast<std::size_t>(c)].data() + base;
+  }
+  return view;
 }
 
 void LogicAnalyzer::UpdateProbe(vamiga::VAmiga& emu, int channel, int probe_type, uint32_t addr) {
@@ -165,6 +502,40 @@ void LogicAnalyzer::DrawControls(vamiga::VAmiga& emu) {
   if (ImGui::Button(symbolic_ ? "SYM" : "RAW")) symbolic_ = !symbolic_;
   ImGui::SetItemTooltip("Toggle Symbolic/Raw");
 
+  ImGui::SameLine();
+  if (capturing_) {
+    if (ImGui::Button(ICON_FA_STOP " Stop")) StopCapture(emu);
+  } else if (ImGui::Button(ICON_FA_CIRCLE " Capture")) {
+    StartCapture(emu);
+  }
+  ImGui::SetItemTooltip("Runs the emulator line by line and captures every line; "
+                        "emulation is slower while capturing");
+  if (!capture_status_.empty()) {
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", capture_status_.c_str());
+  }
+
+  ImGui::SameLine();
+  if (vcd_.IsOpen()) {
+    if (ImGui::Button(ICON_FA_STOP " VCD")) StopVcd();
+    ImGui::SetItemTooltip("%s", std::format("Recording: {} samples, {:.1f} MB written\n"
+                                            "Times are absolute DMA cycles; lines not captured are x",
+                                            vcd_.SamplesQueued(),
+                                            vcd_.BytesWritten() / (1024.0 * 1024.0)).c_str());
+  } else if (ImGui::Button(ICON_FA_FILE_EXPORT " VCD")) {
+    PickerOptions opts;
+    opts.title = "Export VCD";
+    opts.mode = PickerMode::kSaveFile;
+    opts.filters = "Value Change Dump (*.vcd){.vcd}";
+    FilePicker::Instance().Open("LogicVcdExport", opts, [this, &emu](std::filesystem::path p) {
+      StartVcd(emu, p);
+    });
+  }
+  if (!vcd_status_.empty()) {
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", vcd_status_.c_str());
+  }
+
   auto hex_input = [](const char* id, std::array<char, 17>& buffer,
                       uint32_t& out) {
     if (ImGui::InputText(id, buffer.data(), buffer.size(),
@@ -236,7 +607,7 @@ void LogicAnalyzer::DrawControls(vamiga::VAmiga& emu) {
   ImGui::Separator();
 }
 
-void LogicAnalyzer::DrawSignal(vamiga::VAmiga& emu, int channel, ImVec2 pos, float width, float height) {
+void LogicAnalyzer::DrawSignal(const LineView& view, int channel, ImVec2 pos, float width, float height) {
   ImDrawList* dl = ImGui::GetWindowDrawList();
   float dx = width / kSegments;
   float margin = 2.0f;
@@ -246,105 +617,311 @@ void LogicAnalyzer::DrawSignal(vamiga::VAmiga& emu, int channel, ImVec2 pos, flo
 
   dl->AddRect(pos, ImVec2(pos.x + width, pos.y + height), IM_COL32(50, 50, 50, 255));
 
-  int prev_val = -1;
-  int bit_width = (channel == 0) ? 24 : 16; 
+  auto value_at = [&](int i) -> int64_t {
+    if (i >= view.cycles) return kNoValue;
+    if (channel == 1) return view.data[i];
+    return view.probe[static_cast<std::size_t>(channel - 2)][i];
+  };
 
-  for (int i : std::views::iota(0, kSegments)) {
-    int val = data_[channel][i];
+  int64_t prev_val = kNoValue;
+  std::array<char, 16> buf{};
+  for (int i : std::views::iota(0, view.cycles)) {
+    int64_t val = value_at(i);
     if (val < 0) continue;
 
     float x1 = pos.x + i * dx;
     float x2 = pos.x + (i + 1) * dx;
 
-    if (bit_width == 1) {
-        float y = (val != 0) ? y_top : y_bot;
-        if (i > 0 && prev_val != -1) {
-            float prev_y = (prev_val != 0) ? y_top : y_bot;
-            dl->AddLine(ImVec2(x1, prev_y), ImVec2(x1, y), IM_COL32(200, 200, 200, 255));
-        }
-        dl->AddLine(ImVec2(x1, y), ImVec2(x2, y), IM_COL32(200, 200, 200, 255));
-    } else {
-        if (i > 0 && prev_val != val) {
-            dl->AddLine(ImVec2(x1, y_bot), ImVec2(x1, y_top), IM_COL32(200, 200, 200, 255));
-        }
-        dl->AddLine(ImVec2(x1, y_top), ImVec2(x2, y_top), IM_COL32(200, 200, 200, 255));
-        dl->AddLine(ImVec2(x1, y_bot), ImVec2(x2, y_bot), IM_COL32(200, 200, 200, 255));
-        
-        if (dx > 20) {
-             std::string label;
-             if (hex_mode_) label = std::format("{:X}", val);
-             else label = std::format("{}", val);
-             
-             dl->AddText(ImGui::GetFont(), 10.0f, ImVec2(x1 + 2, y_mid - 5), IM_COL32(200, 200, 200, 255), label.c_str());
-        }
+    if (i > 0 && prev_val != val) {
+      dl->AddLine(ImVec2(x1, y_bot), ImVec2(x1, y_top), IM_COL32(200, 200, 200, 255));
+    }
+    dl->AddLine(ImVec2(x1, y_top), ImVec2(x2, y_top), IM_COL32(200, 200, 200, 255));
+    dl->AddLine(ImVec2(x1, y_bot), ImVec2(x2, y_bot), IM_COL32(200, 200, 200, 255));
+
+    if (dx > 20) {
+      auto label = FormatValue(buf, static_cast<uint32_t>(val), hex_mode_);
+      dl->AddText(ImGui::GetFont(), 10.0f, ImVec2(x1 + 2, y_mid - 5),
+                  IM_COL32(200, 200, 200, 255), label.data(), label.data() + label.size());
     }
     prev_val = val;
   }
 }
 
-void LogicAnalyzer::DrawBus(vamiga::VAmiga& emu, ImVec2 pos, float width, float height) {
-    ImDrawList* dl = ImGui::GetWindowDrawList();
-    float dx = width / kSegments;
-
-    for (int i : std::views::iota(0, kSegments)) {
-        if (colors_[i] != 0) {
-            dl->AddRectFilled(
-                ImVec2(pos.x + i * dx, pos.y),
-                ImVec2(pos.x + (i + 1) * dx, pos.y + height),
-                colors_[i]
-            );
-        }
+void LogicAnalyzer::DrawBus(const LineView& view, ImVec2 pos, float width, float height) {
+  ImDrawList* dl = ImGui::GetWindowDrawList();
+  float dx = width / kSegments;
+
+  for (int i : std::views::iota(0, view.cycles)) {
+    ImU32 color = kOwnerStyles[view.owner[i]].color;
+    if (color != 0) {
+      dl->AddRectFilled(ImVec2(pos.x + i * dx, pos.y),
+                        ImVec2(pos.x + (i + 1) * dx, pos.y + height), color);
     }
-    
-    float y_text = pos.y + height - 12;
-    for (int i : std::views::iota(0, kSegments)) {
-        if (dx > 30 && !labels_[i].empty()) {
-            dl->AddText(ImGui::GetFont(), 10.0f, ImVec2(pos.x + i * dx + 2, pos.y), IM_COL32(255, 255, 255, 255), labels_[i].c_str());
-        }
-        
-        int val = data_[0][i];
-        if (val >= 0 && dx > 40) {
-            std::string label = std::format("{:06X}", val);
-            dl->AddText(ImGui::GetFont(), 10.0f, ImVec2(pos.x + i * dx + 2, y_text), IM_COL32(200, 200, 200, 255), label.c_str());
+  }
+
+  float y_text = pos.y + height - 12;
+  std::array<char, 16> buf{};
+  for (int i : std::views::iota(0, view.cycles)) {
+    std::string_view label = kOwnerStyles[view.owner[i]].label;
+    if (dx > 30 && !label.empty()) {
+      dl->AddText(ImGui::GetFont(), 10.0f, ImVec2(pos.x + i * dx + 2, pos.y),
+                  IM_COL32(255, 255, 255, 255), label.data(), label.data() + label.size());
+    }
+    if (dx > 40) {
+      auto addr = FormatValue(buf, view.addr[i], true, 6);
+      dl->AddText(ImGui::GetFont(), 10.0f, ImVec2(pos.x + i * dx + 2, y_text),
+                  IM_COL32(200, 200, 200, 255), addr.data(), addr.data() + addr.size());
+    }
+  }
+}
+
+void LogicAnalyzer::DrawOverview(ImVec2 pos, float width, float height) {
+  ImDrawList* dl = ImGui::GetWindowDrawList();
+  const float frame_width = width / kFrames;
+  const float dx = frame_width / kSegments;
+  const float dy = height / kLines;
+  dl->AddRectFilled(pos, ImVec2(pos.x + width, pos.y + height), IM_COL32(20, 20, 20, 255));
+
+  // One column per frame, the latest on the right, and one row per line.
+  const int64_t latest = GetLine(0).frame;
+  auto column_x = [&](int64_t frame) {
+    return pos.x + static_cast<float>(kFrames - 1 - (latest - frame)) * frame_width;
+  };
+  for (int age : std::views::iota(0, count_)) {
+    LineView view = GetLine(age);
+    if (latest - view.frame >= kFrames) continue;
+    const float x0 = column_x(view.frame);
+    const float y0 = pos.y + static_cast<float>(view.line) * dy;
+    const float y1 = y0 + std::max(dy, 1.0f);
+    int run_start = 0;
+    for (int i : std::views::iota(1, view.cycles + 1)) {
+      if (i < view.cycles && view.owner[i] == view.owner[run_start]) continue;
+      ImU32 color = kOwnerStyles[view.owner[run_start]].color;
+      if (color != 0) {
+        dl->AddRectFilled(ImVec2(x0 + run_start * dx, y0), ImVec2(x0 + i * dx, y1), color);
+      }
+      run_start = i;
+    }
+  }
+  for (int f : std::views::iota(1, kFrames)) {
+    const float x = pos.x + static_cast<float>(f) * frame_width;
+    dl->AddLine(ImVec2(x, pos.y), ImVec2(x, pos.y + height), IM_COL32(90, 90, 90, 255));
+  }
+
+  const float x_sel = pos.x + static_cast<float>(kFrames - 1 - view_frame_) * frame_width;
+  const float y_sel = pos.y + static_cast<float>(view_line_) * dy;
+  dl->AddRect(ImVec2(x_sel, y_sel), ImVec2(x_sel + frame_width, y_sel + std::max(dy, 1.0f)),
+              IM_COL32(255, 255, 0, 255));
+
+  ImGui::InvisibleButton("##overview", ImVec2(width, height));
+  if (ImGui::IsItemHovered()) {
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+    const int column = std::clamp(static_cast<int>((mouse.x - pos.x) / frame_width), 0, kFrames - 1);
+    const int line = std::clamp(static_cast<int>((mouse.y - pos.y) / dy), 0, kLines - 1);
+    const int64_t frame = latest - (kFrames - 1 - column);
+    ImGui::SetTooltip("Frame %lld, line %d%s", static_cast<long long>(frame), line,
+                      FindLine(frame, line) < 0 ? " (not captured)" : "");
+    if (ImGui::IsMouseDown(ImGuiMouseButton_Left)) ShowLine(frame, line);
+    float wheel = ImGui::GetIO().MouseWheel;
+    if (wheel != 0.0f) {
+      view_line_ = std::clamp(view_line_ - static_cast<int>(wheel), 0, kLines - 1);
+      follow_beam_ = false;
+    }
+  }
+}
+
+void LogicAnalyzer::DrawTrigger(vamiga::VAmiga& emu) {
+  static constexpr std::array kKindLabels = {"Address", "Bus owner", "Probe value", "IPL change"};
+  static constexpr std::array kActionLabels = {"Freeze capture", "Pause emulator"};
+  ImGui::PushID("Trigger");
+  ImGui::TextDisabled("Arming starts a capture. Every captured cycle is checked once the "
+                      "pre-trigger window has filled; stopping the capture disarms.");
+  const bool editable = trigger_state_ == TriggerState::kIdle || trigger_state_ == TriggerState::kDone;
+  if (!editable) ImGui::BeginDisabled();
+
+  int kind = static_cast<int>(trigger_.kind);
+  ImGui::SetNextItemWidth(120);
+  if (ImGui::Combo("##kind", &kind, kKindLabels.data(), static_cast<int>(kKindLabels.size()))) {
+    trigger_.kind = static_cast<TriggerKind>(kind);
+  }
+  ImGui::SameLine();
+  switch (trigger_.kind) {
+    case TriggerKind::kAddress:
+    case TriggerKind::kProbe: {
+      if (trigger_.kind == TriggerKind::kProbe) {
+        ImGui::SetNextItemWidth(80);
+        ImGui::SliderInt("##probe", &trigger_.probe, 0, kProbes - 1, "Probe %d");
+        ImGui::SameLine();
+      }
+      ImGui::SetNextItemWidth(80);
+      ImGui::InputScalar("Value", ImGuiDataType_U32, &trigger_.value, nullptr, nullptr, "%06X",
+                         ImGuiInputTextFlags_CharsHexadecimal);
+      ImGui::SameLine();
+      ImGui::SetNextItemWidth(80);
+      ImGui::InputScalar("Mask", ImGuiDataType_U32, &trigger_.mask, nullptr, nullptr, "%06X",
+                         ImGuiInputTextFlags_CharsHexadecimal);
+      break;
+    }
+    case TriggerKind::kOwner: {
+      std::string_view preview = kOwnerStyles[trigger_.value & 0xFF].label;
+      ImGui::SetNextItemWidth(80);
+      if (ImGui::BeginCombo("##owner", preview.data())) {
+        for (std::size_t i = 1; i < kOwnerStyles.size(); ++i) {
+          if (kOwnerStyles[i].color == 0) continue;
+          if (ImGui::Selectable(kOwnerStyles[i].label.data(), trigger_.value == i)) {
+            trigger_.value = static_cast<uint32_t>(i);
+          }
         }
+        ImGui::EndCombo();
+      }
+      break;
     }
+    case TriggerKind::kIplChange:
+      ImGui::SetNextItemWidth(80);
+      ImGui::SliderInt("##probe", &trigger_.probe, 0, kProbes - 1, "Probe %d");
+      if (probe_types_[trigger_.probe] != 2) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(probe is not set to IPL)");
+      }
+      break;
+  }
+
+  ImGui::SetNextItemWidth(100);
+  ImGui::SliderInt("Pre", &trigger_.pre_lines, 0, kDepth - 1, "%d lines");
+  ImGui::SetItemTooltip("Lines kept before the trigger (bounded by the capture ring)");
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(100);
+  ImGui::SliderInt("Post", &trigger_.post_lines, 0, kDepth - 1, "%d lines");
+  ImGui::SetItemTooltip("Lines captured after the trigger");
+  ImGui::SameLine();
+  int action = static_cast<int>(trigger_.action);
+  ImGui::SetNextItemWidth(130);
+  if (ImGui::Combo("##action", &action, kActionLabels.data(), static_cast<int>(kActionLabels.size()))) {
+    trigger_.action = static_cast<TriggerAction>(action);
+  }
+  if (!editable) ImGui::EndDisabled();
+
+  // Pre and post windows together must fit into the ring.
+  trigger_.pre_lines = std::min(trigger_.pre_lines, kDepth - 1 - trigger_.post_lines);
+
+  ImGui::SameLine();
+  if (trigger_state_ == TriggerState::kArmed || trigger_state_ == TriggerState::kFired) {
+    if (ImGui::Button(ICON_FA_XMARK " Disarm")) trigger_state_ = TriggerState::kIdle;
+  } else if (ImGui::Button(ICON_FA_CROSSHAIRS " Arm")) {
+    // Triggers are checked against captured lines.
+    if (StartCapture(emu)) {
+      last_probe_.fill(kNoValue);
+      armed_sample_ = samples_;
+      trigger_state_ = TriggerState::kArmed;
+    }
+  }
+
+  switch (trigger_state_) {
+    case TriggerState::kIdle: ImGui::TextDisabled("Idle"); break;
+    case TriggerState::kArmed: {
+      const int64_t filled = std::min<int64_t>(samples_ - armed_sample_, trigger_.pre_lines);
+      if (filled < trigger_.pre_lines) {
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f),
+                           "Armed, filling pre-trigger window (%lld/%d lines)",
+                           static_cast<long long>(filled), trigger_.pre_lines);
+      } else {
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "Armed");
+      }
+      break;
+    }
+    case TriggerState::kFired:
+    case TriggerState::kDone:
+      ImGui::TextColored(ImVec4(0.3f, 1.0f, 0.3f, 1.0f), "%s at frame %lld, line %d, cycle %d",
+                         trigger_state_ == TriggerState::kFired ? "Capturing post-trigger" : "Triggered",
+                         static_cast<long long>(trigger_hit_.frame), trigger_hit_.line,
+                         trigger_hit_.hpos);
+      if (trigger_state_ == TriggerState::kDone) {
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Show")) ShowLine(trigger_hit_.frame, trigger_hit_.line);
+        ImGui::SameLine();
+        const int64_t age = samples_ - trigger_hit_.sample + trigger_.pre_lines;
+        if (ImGui::SmallButton("Pre-trigger start") && age < count_) {
+          const LineView start = GetLine(static_cast<int>(age));
+          ShowLine(start.frame, start.line);
+        }
+      }
+      break;
+  }
+  ImGui::PopID();
 }
 
 void LogicAnalyzer::Draw(vamiga::VAmiga& emu) {
-  Update(emu);
   DrawControls(emu);
+  if (ImGui::CollapsingHeader("Trigger")) {
+    DrawTrigger(emu);
+  }
+
+  ImGui::Checkbox("Follow beam", &follow_beam_);
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(120);
+  if (ImGui::SliderInt("Frame", &view_frame_, 0, kFrames - 1,
+                       view_frame_ == 0 ? "Latest" : "-%d")) {
+    follow_beam_ = false;
+  }
+  ImGui::SetItemTooltip("The ring keeps the last %d captured frames", kFrames);
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(160);
+  if (ImGui::SliderInt("Line", &view_line_, 0, kLines - 1)) follow_beam_ = false;
+  if (follow_beam_) {
+    view_frame_ = 0;
+    view_line_ = GetLine(0).line;
+  }
+  const int64_t view_frame = GetLine(0).frame - view_frame_;
+  const int age = FindLine(view_frame, view_line_);
+  LineView view = age >= 0 ? GetLine(age) : LineView{};
+  ImGui::SameLine();
+  if (age >= 0) {
+    ImGui::TextDisabled("Frame %lld, line %d, %d cycles", static_cast<long long>(view.frame),
+                        view.line, view.cycles);
+  } else {
+    ImGui::TextDisabled("Frame %lld, line %d not captured", static_cast<long long>(view_frame),
+                        view_line_);
+  }
+
+  if (ImGui::CollapsingHeader("Captured Frames")) {
+    ImVec2 p = ImGui::GetCursorScreenPos();
+    DrawOverview(p, ImGui::GetContentRegionAvail().x, 160.0f);
+  }
 
   ImVec2 avail = ImGui::GetContentRegionAvail();
   float content_width = avail.x * zoom_;
   float header_height = 30.0f;
   float row_height = (avail.y - header_height - 20) / kSignals;
-  
+
   ImGui::BeginChild("LogicScroll", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
-  
+
   ImVec2 p = ImGui::GetCursorScreenPos();
-  
+
   ImDrawList* dl = ImGui::GetWindowDrawList();
   float dx = content_width / kSegments;
-  
+
+  std::array<char, 16> buf{};
   for (int i : std::views::iota(0, kSegments)) {
-     if (i % 4 == 0) {
-         std::string s = std::format("{:02X}", i);
-         dl->AddText(ImVec2(p.x + i * dx, p.y), IM_COL32(150, 150, 150, 255), s.c_str());
-     }
-     dl->AddLine(ImVec2(p.x + i*dx, p.y + header_height), ImVec2(p.x + i*dx, p.y + avail.y), IM_COL32(50, 50, 50, 100));
-  }
-  
-  DrawBus(emu, ImVec2(p.x, p.y + header_height), content_width, row_height);
-  
-  DrawSignal(emu, 1, ImVec2(p.x, p.y + header_height + row_height), content_width, row_height);
-  
+    if (i % 4 == 0) {
+      auto s = FormatValue(buf, static_cast<uint32_t>(i), true, 2);
+      dl->AddText(ImVec2(p.x + i * dx, p.y), IM_COL32(150, 150, 150, 255), s.data(), s.data() + s.size());
+    }
+    dl->AddLine(ImVec2(p.x + i*dx, p.y + header_height), ImVec2(p.x + i*dx, p.y + avail.y), IM_COL32(50, 50, 50, 100));
+  }
+
+  DrawBus(view, ImVec2(p.x, p.y + header_height), content_width, row_height);
+
+  DrawSignal(view, 1, ImVec2(p.x, p.y + header_height + row_height), content_width, row_height);
+
   for (int c : std::views::iota(2, kSignals)) {
-      DrawSignal(emu, c, ImVec2(p.x, p.y + header_height + c * row_height), content_width, row_height);
+    DrawSignal(view, c, ImVec2(p.x, p.y + header_height + c * row_height), content_width, row_height);
+  }
+
+  if (trigger_state_ == TriggerState::kDone && view.frame == trigger_hit_.frame &&
+      view.line == trigger_hit_.line) {
+    float x_trig = p.x + trigger_hit_.hpos * dx;
+    dl->AddLine(ImVec2(x_trig, p.y), ImVec2(x_trig, p.y + avail.y), IM_COL32(255, 80, 80, 220), 2.0f);
   }
-  
-  long hpos = emu.agnus.getInfo().hpos;
-  float x_beam = p.x + hpos * dx;
-  dl->AddLine(ImVec2(x_beam, p.y), ImVec2(x_beam, p.y + avail.y), IM_COL32(255, 255, 0, 200), 2.0f);
 
   ImGui::Dummy(ImVec2(content_width, avail.y));
   ImGui::EndChild();
@@ -1,6 +1,8 @@
 #ifndef LINUXGUI_COMPONENTS_LOGIC_ANALYZER_H_
 #define LINUXGUI_COMPONENTS_LOGIC_ANALYZER_H_
 #include <array>
+#include <cstdint>
+#include <filesystem>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -9,34 +11,170 @@
 #undef unreachable
 #define unreachable std::unreachable()
 #include "imgui.h"
+#include "services/vcd_writer.h"
 namespace gui {
 class LogicAnalyzer {
  public:
+  static constexpr int kSegments = 228;
+  static constexpr int kLines = 313;
+  // The core only exposes the line the beam is on, so a capture advances
+  // the paused emulator one line at a time and stores every line. The ring
+  // holds the last kFrames frames.
+  static constexpr int kFrames = 4;
+  static constexpr int kDepth = kFrames * kLines;
+  static constexpr int kProbes = 4;
+  static constexpr uint8_t kNoOwner = 0xFF;
+  static constexpr int32_t kNoValue = -1;
+
+  // Read-only view of one captured line. Cycles at or beyond `cycles` have
+  // not been observed.
+  struct LineView {
+    int64_t frame = -1;
+    int line = 0;
+    int64_t cycle = 0;  // Absolute DMA cycle of hpos 0.
+    int cycles = 0;
+    const uint8_t* owner = nullptr;
+    const uint32_t* addr = nullptr;
+    const uint16_t* data = nullptr;
+    std::array<const int32_t*, kProbes> probe{};
+  };
+
+  // Bus owners folded into the groups shown in the Dashboard.
+  enum BusGroup {
+    kBusCpu, kBusBitplane, kBusCopper, kBusBlitter, kBusSprite,
+    kBusDisk, kBusAudio, kBusRefresh, kBusFree, kBusGroups
+  };
+  static constexpr int kBusHistory = 150;
+
+  // Share of the DMA cycles per group for one frame captured from its first
+  // to its last line.
+  struct BusUsage {
+    int64_t frame = -1;
+    uint32_t samples = 0;
+    std::array<float, kBusGroups> share{};
+  };
+
   static LogicAnalyzer& Instance();
+  static std::string_view BusGroupName(int group);
+  static ImU32 BusGroupColor(int group);
   void Draw(vamiga::VAmiga& emu);
+  // Advances a running capture. Call every GUI frame.
   void Update(vamiga::VAmiga& emu);
+  bool StartCapture(vamiga::VAmiga& emu);
+  // Resumes the emulator if it was running when the capture started.
+  void StopCapture(vamiga::VAmiga& emu, bool resume = true);
+  bool IsCapturing() const { return capturing_; }
+  // Age 0 is the most recently captured line.
+  LineView GetLine(int age) const;
+  // Age of a captured line, or -1 if it is not in the ring.
+  int FindLine(int64_t frame, int line) const;
+  int CapturedLines() const { return count_; }
+  bool StartVcd(vamiga::VAmiga& emu, const std::filesystem::path& path);
+  void StopVcd();
+  // Oldest entry first.
+  const std::vector<BusUsage>& BusHistory() const { return bus_history_; }
  private:
   LogicAnalyzer();
+  bool StepLine(vamiga::VAmiga& emu);
+  void CaptureLine(vamiga::VAmiga& emu);
+  void TrackFrame(vamiga::VAmiga& emu, int64_t line_cycle, long vpos);
+  // Points the view at a captured line.
+  void ShowLine(int64_t frame, int line);
   void DrawControls(vamiga::VAmiga& emu);
-  void DrawBus(vamiga::VAmiga& emu, ImVec2 pos, float width, float height);
-  void DrawSignal(vamiga::VAmiga& emu, int channel, ImVec2 pos, float width, float height);
-  void DrawLabels(vamiga::VAmiga& emu, ImVec2 pos, float width, float height);
+  void DrawOverview(ImVec2 pos, float width, float height);
+  void DrawBus(const LineView& view, ImVec2 pos, float width, float height);
+  void DrawSignal(const LineView& view, int channel, ImVec2 pos, float width, float height);
   void UpdateProbe(vamiga::VAmiga& emu, int channel, int probe_type, uint32_t addr);
+  // Marks every signal unknown from the end of the last written line on.
+  void EndVcdLine();
+  void FoldBusCounts();
+  void DrawTrigger(vamiga::VAmiga& emu);
+  void CheckTrigger(vamiga::VAmiga& emu, std::size_t base, int from, int to,
+                    int64_t line_cycle, int line);
   struct ProbePreset {
     std::string_view name;
     int type;
     uint32_t addr;
   };
   static const std::vector<ProbePreset> kPresets;
-  static constexpr int kSegments = 228;
   static constexpr int kSignals = 6;
+
+  // Structure-of-arrays ring holding the last kDepth captured lines.
+  struct CaptureRing {
+    CaptureRing();
+    std::size_t Offset(int slot) const {
+      return static_cast<std::size_t>(slot) * kSegments;
+    }
+    std::vector<uint8_t> owner;
+    std::vector<uint32_t> addr;
+    std::vector<uint16_t> data;
+    std::array<std::vector<int32_t>, kProbes> probe;
+    std::array<int64_t, kDepth> frame{};
+    std::array<int64_t, kDepth> cycle{};
+    std::array<int16_t, kDepth> line{};
+    std::array<int16_t, kDepth> cycles{};
+  };
+  enum class TriggerKind { kAddress, kOwner, kProbe, kIplChange };
+  enum class TriggerAction { kFreeze, kPause };
+  enum class TriggerState { kIdle, kArmed, kFired, kDone };
+  struct TriggerConfig {
+    TriggerKind kind = TriggerKind::kAddress;
+    TriggerAction action = TriggerAction::kFreeze;
+    uint32_t value = 0;
+    uint32_t mask = 0xFFFFFF;
+    int probe = 0;
+    // Both windows count captured lines.
+    int pre_lines = 16;
+    int post_lines = 16;
+  };
+  struct TriggerHit {
+    int64_t cycle = 0;
+    int64_t frame = 0;
+    int line = 0;
+    int hpos = 0;
+    int64_t sample = 0;
+  };
+  TriggerConfig trigger_;
+  TriggerState trigger_state_ = TriggerState::kIdle;
+  TriggerHit trigger_hit_;
+  std::array<int32_t, kProbes> last_probe_{};
+  // Captured lines counted from here fill the pre-trigger window.
+  int64_t armed_sample_ = 0;
+
+  bool capturing_ = false;
+  // First cycle after the last captured line, or -1.
+  int64_t capture_next_cycle_ = -1;
+  bool resume_after_capture_ = false;
+  std::string capture_status_;
+
+  CaptureRing ring_;
+  int head_slot_ = 0;
+  int count_ = 0;
+  int64_t samples_ = 0;
+  // Frames are counted from the CPU clock, so frames skipped while no
+  // capture ran are not lost.
+  int64_t frame_ = -1;
+  int64_t frame_start_ = 0;
+
+  std::array<uint32_t, 256> bus_counts_{};
+  // Every line of the current frame so far has been captured.
+  bool bus_frame_whole_ = false;
+  std::vector<BusUsage> bus_history_;
+
+  VcdWriter vcd_;
+  uint64_t vcd_ps_per_cycle_ = 0;
+  // First cycle after the last line written to the VCD, or -1.
+  int64_t vcd_next_cycle_ = -1;
+  std::string vcd_status_;
+
   float zoom_ = 1.0f;
   bool visible_ = true;
   bool hex_mode_ = true;
   bool symbolic_ = false;
-  std::array<std::array<int, kSegments>, kSignals> data_;
-  std::array<std::string, kSegments> labels_;
-  std::array<ImU32, kSegments> colors_;
+  bool follow_beam_ = true;
+  // Frames back from the latest captured frame, and the line within it.
+  int view_frame_ = 0;
+  int view_line_ = 0;
   int probe_types_[4] = {0, 0, 0, 0};
   uint32_t probe_addrs_[4] = {0, 0, 0, 0};
 };
@@ -0,0 +1,319 @@
+#include "movie_player.h"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iterator>
+
+#include "components/file_picker.h"
+#include "components/warp_mode.h"
+#include "imgui.h"
+#include "Infrastructure/Option.h"
+#include "resources/IconsFontAwesome6.h"
+
+namespace gui {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr auto kStepTimeout = std::chrono::seconds(5);
+constexpr auto kStepPoll = std::chrono::microseconds(50);
+
+std::filesystem::path TempSnapshotPath() {
+  return std::filesystem::temp_directory_path() / "vamiga_movie.vsn";
+}
+
+double FrameRate(vamiga::VAmiga& emu) {
+  const bool ntsc = emu.get(vamiga::Opt::AMIGA_VIDEO_FORMAT) ==
+                    static_cast<vamiga::i64>(vamiga::TV::NTSC);
+  return ntsc ? 60.0 : 50.0;
+}
+
+}  // namespace
+
+MoviePlayer& MoviePlayer::Instance() {
+  static MoviePlayer instance;
+  return instance;
+}
+
+MoviePlayer::~MoviePlayer() { Stop(); }
+
+void MoviePlayer::Apply(vamiga::VAmiga& emu, const InputAction& action) {
+  using Type = InputAction::Type;
+  auto& port = action.port == 2 ? emu.controlPort2 : emu.controlPort1;
+  const auto pad = static_cast<vamiga::GamePadAction>(action.code);
+  switch (action.type) {
+    case Type::kKeyPress:
+      emu.keyboard.press(static_cast<vamiga::KeyCode>(action.code));
+      break;
+    case Type::kKeyRelease:
+      emu.keyboard.release(static_cast<vamiga::KeyCode>(action.code));
+      break;
+    case Type::kJoystick:
+      port.joystick.trigger(pad);
+      break;
+    case Type::kMouseButton:
+      port.mouse.trigger(pad);
+      break;
+    case Type::kMouseMove:
+      port.mouse.setDxDy(action.dx, action.dy);
+      break;
+  }
+}
+
+bool MoviePlayer::Capture(const InputAction& action) {
+  if (state_ != State::kRecording) return false;
+  pending_.push_back(action);
+  return true;
+}
+
+void MoviePlayer::SetStatus(std::string status) {
+  std::lock_guard lock(mutex_);
+  status_ = std::move(status);
+}
+
+uint64_t MoviePlayer::HashFrame(vamiga::VAmiga& emu) {
+  emu.videoPort.lockTexture();
+  const uint32_t* pixels = emu.videoPort.getTexture();
+  const uint64_t hash =
+      pixels ? InputMovie::HashFrame({pixels, static_cast<std::size_t>(vamiga::HPIXELS * vamiga::VPIXELS)})
+             : 0;
+  emu.videoPort.unlockTexture();
+  return hash;
+}
+
+void MoviePlayer::StartRecording(vamiga::VAmiga& emu) {
+  if (state_ != State::kIdle) return;
+  emu.pause();
+  const auto tmp = TempSnapshotPath();
+  try {
+    emu.amiga.saveSnapshot(tmp);
+  } catch (...) {
+    SetStatus("Recording failed: could not take the start snapshot");
+    return;
+  }
+  std::ifstream file(tmp, std::ios::binary);
+  recording_ = {};
+  recording_.snapshot.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  file.close();
+  std::error_code ec;
+  std::filesystem::remove(tmp, ec);
+
+  pending_.clear();
+  frame_ = 0;
+  stepping_ = false;
+  next_step_ = Clock::now();
+  state_ = State::kRecording;
+  SetStatus("Recording");
+}
+
+void MoviePlayer::StopRecording(vamiga::VAmiga& emu) {
+  if (state_ != State::kRecording) return;
+  state_ = State::kIdle;
+  // Input that arrived after the last boundary is not part of the movie,
+  // but it must still reach the emulator or keys would stay stuck.
+  for (const auto& action : pending_) Apply(emu, action);
+  pending_.clear();
+  emu.run();
+  SetStatus(std::format("Recorded {} frames, {} actions", frame_, recording_.events.size()));
+
+  PickerOptions opts;
+  opts.title = "Save Input Movie";
+  opts.mode = PickerMode::kSaveFile;
+  opts.filters = "Input Movies (*.vmv){.vmv}";
+  FilePicker::Instance().Open("MovieSave", opts, [this](auto p) {
+    SetStatus(recording_.Save(p) ? std::format("Saved {}", p.filename().string())
+                                 : std::format("Could not write {}", p.string()));
+  });
+}
+
+void MoviePlayer::Update(vamiga::VAmiga& emu) {
+  if (state_ != State::kRecording) return;
+  if (stepping_) {
+    // finishFrame() is queued; the frame is done once the emulator has
+    // moved and is paused again.
+    if (emu.isRunning() || emu.cpu.getInfo().clock == step_clock_) return;
+    recording_.checksums.push_back({frame_, HashFrame(emu)});
+    ++frame_;
+    stepping_ = false;
+  }
+
+  // Pace the recording at the machine's frame rate.
+  const auto now = Clock::now();
+  if (now < next_step_) return;
+  const auto period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / FrameRate(emu)));
+  next_step_ = std::max(next_step_ + period, now - period);
+
+  for (const auto& action : pending_) {
+    Apply(emu, action);
+    recording_.events.push_back({frame_, action});
+  }
+  pending_.clear();
+  step_clock_ = emu.cpu.getInfo().clock;
+  stepping_ = true;
+  emu.finishFrame();
+}
+
+bool MoviePlayer::StartReplay(const std::filesystem::path& path, vamiga::VAmiga& emu) {
+  if (state_ != State::kIdle) return false;
+  if (worker_.joinable()) worker_.join();
+  if (!replay_.Load(path)) {
+    SetStatus(std::format("{} is not an input movie", path.filename().string()));
+    return false;
+  }
+  abort_ = false;
+  replay_ok_ = false;
+  replay_frame_ = 0;
+  mismatches_ = 0;
+  first_mismatch_ = -1;
+  state_ = State::kReplaying;
+  SetStatus("Replaying");
+  worker_ = std::thread(&MoviePlayer::RunReplay, this, &emu);
+  return true;
+}
+
+int MoviePlayer::ReplayHeadless(const std::filesystem::path& path, std::ostream& out) {
+  vamiga::VAmiga emu;
+  emu.set(vamiga::ConfigScheme::A500_OCS_1MB);
+  emu.set(vamiga::Opt::AMIGA_VSYNC, 0);
+  emu.launch();
+
+  auto& player = Instance();
+  const bool started = player.StartReplay(path, emu);
+  if (player.worker_.joinable()) player.worker_.join();
+  {
+    std::lock_guard lock(player.mutex_);
+    out << player.status_ << '\n';
+  }
+  return started && player.replay_ok_ ? 0 : 1;
+}
+
+void MoviePlayer::Stop() {
+  abort_ = true;
+  if (worker_.joinable()) worker_.join();
+}
+
+bool MoviePlayer::StepFrame(vamiga::VAmiga& emu) {
+  const int64_t before = emu.cpu.getInfo().clock;
+  emu.finishFrame();
+  const auto deadline = Clock::now() + kStepTimeout;
+  while (emu.isRunning() || emu.cpu.getInfo().clock == before) {
+    if (Clock::now() > deadline) return false;
+    emu.wakeUp();
+    std::this_thread::sleep_for(kStepPoll);
+  }
+  return true;
+}
+
+void MoviePlayer::RunReplay(vamiga::VAmiga* emu) {
+  emu->pause();
+  const auto tmp = TempSnapshotPath();
+  {
+    std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(replay_.snapshot.data()),
+               static_cast<std::streamsize>(replay_.snapshot.size()));
+  }
+  bool loaded = true;
+  try {
+    emu->amiga.loadSnapshot(tmp);
+  } catch (...) {
+    loaded = false;
+  }
+  std::error_code ec;
+  std::filesystem::remove(tmp, ec);
+  if (!loaded) {
+    SetStatus("Replay failed: the movie's snapshot could not be restored");
+    state_ = State::kIdle;
+    return;
+  }
+
+  const auto saved_warp = emu->get(vamiga::Opt::AMIGA_WARP_MODE);
+  emu->set(vamiga::Opt::AMIGA_WARP_MODE, WarpAlways());
+
+  const auto& events = replay_.events;
+  const auto& checksums = replay_.checksums;
+  const uint32_t frames = replay_.FrameCount();
+  std::size_t next_event = 0, next_checksum = 0;
+  bool timed_out = false;
+  for (uint32_t f = 0; f < frames && !abort_; ++f) {
+    while (next_event < events.size() && events[next_event].frame == f) {
+      Apply(*emu, events[next_event++].action);
+    }
+    if (!StepFrame(*emu)) {
+      timed_out = true;
+      break;
+    }
+    if (next_checksum < checksums.size() && checksums[next_checksum].frame == f) {
+      if (HashFrame(*emu) != checksums[next_checksum].hash) {
+        if (mismatches_++ == 0) first_mismatch_ = f;
+      }
+      ++next_checksum;
+    }
+    replay_frame_ = f + 1;
+  }
+  emu->set(vamiga::Opt::AMIGA_WARP_MODE, saved_warp);
+
+  const uint32_t done = replay_frame_;
+  if (timed_out) {
+    SetStatus(std::format("Replay stalled at frame {}", done));
+  } else if (abort_) {
+    SetStatus(std::format("Replay aborted at frame {}", done));
+  } else if (mismatches_ == 0) {
+    SetStatus(std::format("Replay matched all {} checksummed frames", next_checksum));
+    replay_ok_ = true;
+  } else {
+    SetStatus(std::format("Replay diverged at frame {} ({} of {} frames differ)",
+                          first_mismatch_.load(), mismatches_.load(), next_checksum));
+  }
+  state_ = State::kIdle;
+}
+
+void MoviePlayer::Draw(bool* p_open, vamiga::VAmiga& emu) {
+  if (!p_open || !*p_open) return;
+  ImGui::SetNextWindowSize(ImVec2(380, 170), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Input Movie", p_open)) {
+    ImGui::End();
+    return;
+  }
+
+  switch (state_.load()) {
+    case State::kIdle:
+      if (ImGui::Button(ICON_FA_CIRCLE " Record")) StartRecording(emu);
+      ImGui::SameLine();
+      if (ImGui::Button(ICON_FA_PLAY " Replay...")) {
+        PickerOptions opts;
+        opts.title = "Replay Input Movie";
+        opts.filters = "Input Movies (*.vmv){.vmv}";
+        FilePicker::Instance().Open("MovieLoad", opts,
+                                    [this, &emu](auto p) { StartReplay(p, emu); });
+      }
+      break;
+    case State::kRecording:
+      if (ImGui::Button(ICON_FA_STOP " Stop & Save...")) StopRecording(emu);
+      ImGui::Text("Frame %u, %zu actions", frame_, recording_.events.size());
+      break;
+    case State::kReplaying: {
+      if (ImGui::Button(ICON_FA_XMARK " Abort")) Abort();
+      const uint32_t frames = std::max<uint32_t>(replay_.FrameCount(), 1);
+      const uint32_t done = replay_frame_;
+      ImGui::ProgressBar(static_cast<float>(done) / static_cast<float>(frames), ImVec2(-1, 0),
+                         std::format("{} / {} frames", done, frames).c_str());
+      if (mismatches_ > 0) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "First mismatch at frame %lld",
+                           static_cast<long long>(first_mismatch_.load()));
+      }
+      break;
+    }
+  }
+
+  std::string status;
+  {
+    std::lock_guard lock(mutex_);
+    status = status_;
+  }
+  if (!status.empty()) ImGui::TextWrapped("%s", status.c_str());
+  ImGui::End();
+}
+
+}
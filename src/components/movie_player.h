@@ -0,0 +1,90 @@
+#ifndef LINUXGUI_COMPONENTS_MOVIE_PLAYER_H_
+#define LINUXGUI_COMPONENTS_MOVIE_PLAYER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include "VAmiga.h"
+#undef unreachable
+#define unreachable std::unreachable()
+#include "services/input_movie.h"
+
+namespace gui {
+
+// Records input as a movie and replays it frame-exactly. While a movie is
+// recorded or replayed the emulator advances one frame at a time via
+// finishFrame(); input is only handed to the emulator while it is paused
+// between two frames, so a replay applies every action at the very same
+// emulated cycle as the recording did.
+class MoviePlayer {
+ public:
+  enum class State : uint8_t { kIdle, kRecording, kReplaying };
+
+  static MoviePlayer& Instance();
+  ~MoviePlayer();
+
+  // The single place where input actions reach the emulator.
+  static void Apply(vamiga::VAmiga& emu, const InputAction& action);
+
+  // Returns true if the recorder took the action over; it is applied and
+  // logged at the next frame boundary.
+  bool Capture(const InputAction& action);
+
+  State GetState() const { return state_; }
+  bool IsReplaying() const { return state_ == State::kReplaying; }
+
+  void StartRecording(vamiga::VAmiga& emu);
+  void StopRecording(vamiga::VAmiga& emu);
+  bool StartReplay(const std::filesystem::path& path, vamiga::VAmiga& emu);
+  // Replays a movie on a fresh emulator without a window and prints the
+  // outcome. Returns 0 if the replay ran to the end and every checksummed
+  // frame matched.
+  static int ReplayHeadless(const std::filesystem::path& path, std::ostream& out);
+  void Abort() { abort_ = true; }
+  // Aborts a replay and joins its thread.
+  void Stop();
+
+  // Advances a recording by one frame when one is due. Call every GUI frame.
+  void Update(vamiga::VAmiga& emu);
+  void Draw(bool* p_open, vamiga::VAmiga& emu);
+
+ private:
+  MoviePlayer() = default;
+  void RunReplay(vamiga::VAmiga* emu);
+  void SetStatus(std::string status);
+  static bool StepFrame(vamiga::VAmiga& emu);
+  static uint64_t HashFrame(vamiga::VAmiga& emu);
+
+  std::atomic<State> state_ = State::kIdle;
+
+  // Recording; only touched on the GUI thread.
+  InputMovie recording_;
+  std::vector<InputAction> pending_;
+  uint32_t frame_ = 0;
+  bool stepping_ = false;
+  int64_t step_clock_ = 0;
+  std::chrono::steady_clock::time_point next_step_;
+
+  // Replay.
+  InputMovie replay_;
+  std::thread worker_;
+  std::atomic<bool> abort_ = false;
+  std::atomic<uint32_t> replay_frame_ = 0;
+  std::atomic<uint32_t> mismatches_ = 0;
+  std::atomic<int64_t> first_mismatch_ = -1;
+  std::atomic<bool> replay_ok_ = false;
+
+  mutable std::mutex mutex_;
+  std::string status_;
+};
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include "rewind_controller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "components/movie_player.h"
+#include "services/motion_coalescer.h"
+
+namespace gui {
+
+RewindController& RewindController::Instance() {
+  static RewindController instance;
+  return instance;
+}
+
+void RewindController::Configure(const Options& options) {
+  options_ = options;
+  options_.interval_frames = std::clamp(options_.interval_frames, 1, 250);
+  options_.budget_mb = std::clamp(options_.budget_mb, 8, 1024);
+  buffer_.SetBudget(static_cast<std::size_t>(options_.budget_mb) << 20);
+  if (!options_.enabled) buffer_.Clear();
+}
+
+double RewindController::HistorySeconds() const {
+  if (cpu_hz_ <= 0.0) return 0.0;
+  return static_cast<double>(buffer_.CurrentStamp() - buffer_.OldestStamp()) / cpu_hz_;
+}
+
+bool RewindController::Restore(vamiga::VAmiga& emu, const std::vector<uint8_t>& snapshot) {
+  try {
+    std::unique_ptr<vamiga::MediaFile> file(vamiga::MediaFile::make(
+        snapshot.data(), static_cast<vamiga::isize>(snapshot.size()), vamiga::FileType::SNAPSHOT));
+    if (!file) return false;
+    emu.amiga.loadSnapshot(*file);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+void RewindController::SetRewinding(bool rewinding, vamiga::VAmiga& emu) {
+  if (rewinding == rewinding_) return;
+  if (rewinding) {
+    if (!options_.enabled || buffer_.Empty()) return;
+    rewinding_ = true;
+    resume_ = emu.isRunning();
+    emu.pause();
+    // Start from the latest capture; Update() then walks further back.
+    Restore(emu, buffer_.Current());
+  } else {
+    rewinding_ = false;
+    if (resume_) emu.run();
+  }
+}
+
+void RewindController::Update(vamiga::VAmiga& emu) {
+  if (!options_.enabled) return;
+  if (rewinding_) {
+    if (const auto* snapshot = buffer_.StepBack()) Restore(emu, *snapshot);
+    return;
+  }
+  // A movie owns the timeline while it records or replays.
+  if (!emu.isRunning() || MoviePlayer::Instance().GetState() != MoviePlayer::State::kIdle) return;
+
+  const bool ntsc = emu.get(vamiga::Opt::AMIGA_VIDEO_FORMAT) ==
+                    static_cast<vamiga::i64>(vamiga::TV::NTSC);
+  frame_cycles_ = ntsc ? MotionCoalescer::kNtscFrameCycles : MotionCoalescer::kPalFrameCycles;
+  cpu_hz_ = static_cast<double>(frame_cycles_) * (ntsc ? 60.0 : 50.0);
+
+  const int64_t clock = emu.cpu.getInfo().clock;
+  // Going backwards without us means a reset or a loaded snapshot: the
+  // history no longer leads to the present.
+  if (!buffer_.Empty() && clock < buffer_.CurrentStamp()) buffer_.Clear();
+  if (!buffer_.Empty() && clock - buffer_.CurrentStamp() < options_.interval_frames * frame_cycles_) {
+    return;
+  }
+  Capture(emu, clock);
+}
+
+void RewindController::Capture(vamiga::VAmiga& emu, int64_t clock) {
+  const auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<vamiga::MediaFile> snapshot(emu.amiga.takeSnapshot());
+  if (!snapshot) return;
+  buffer_.Push({snapshot->getData(), static_cast<std::size_t>(snapshot->getSize())}, clock);
+  last_capture_ms_ = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start).count();
+}
+
+}
@@ -0,0 +1,54 @@
+#ifndef LINUXGUI_COMPONENTS_REWIND_CONTROLLER_H_
+#define LINUXGUI_COMPONENTS_REWIND_CONTROLLER_H_
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include "VAmiga.h"
+#undef unreachable
+#define unreachable std::unreachable()
+#include "services/rewind_buffer.h"
+
+namespace gui {
+
+// Keeps a rolling history of snapshots, one every few emulated frames, so
+// that holding the rewind hotkey walks the machine back in time.
+class RewindController {
+ public:
+  struct Options {
+    bool enabled = true;
+    int interval_frames = 10;
+    int budget_mb = 64;
+  };
+
+  static RewindController& Instance();
+
+  void Configure(const Options& options);
+  // Call every GUI frame; captures when due, or steps back while rewinding.
+  void Update(vamiga::VAmiga& emu);
+  void SetRewinding(bool rewinding, vamiga::VAmiga& emu);
+  bool IsRewinding() const { return rewinding_; }
+  void Clear() { buffer_.Clear(); }
+
+  std::size_t Depth() const { return buffer_.Depth(); }
+  std::size_t MemoryBytes() const { return buffer_.MemoryBytes(); }
+  double HistorySeconds() const;
+  double LastCaptureMs() const { return last_capture_ms_; }
+
+ private:
+  RewindController() = default;
+  void Capture(vamiga::VAmiga& emu, int64_t clock);
+  static bool Restore(vamiga::VAmiga& emu, const std::vector<uint8_t>& snapshot);
+
+  Options options_;
+  RewindBuffer buffer_;
+  bool rewinding_ = false;
+  bool resume_ = false;
+  int64_t frame_cycles_ = 0;
+  double cpu_hz_ = 0.0;
+  double last_capture_ms_ = 0.0;
+};
+
+}
+
+#endif
@@ -0,0 +1,314 @@
+#include "script_runner.h"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <string_view>
+
+#include "Infrastructure/Option.h"
+#include "components/warp_mode.h"
+#include "imgui.h"
+#include "resources/IconsFontAwesome6.h"
+
+namespace gui {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+std::string_view Trim(std::string_view s) {
+  const auto first = s.find_first_not_of(" \t\r");
+  if (first == std::string_view::npos) return {};
+  const auto last = s.find_last_not_of(" \t\r");
+  return s.substr(first, last - first + 1);
+}
+
+// CPU cycles per emulated second; the CPU runs at twice the colour clock.
+double CpuHz(vamiga::VAmiga& emu) {
+  const bool ntsc = emu.get(vamiga::Opt::AMIGA_VIDEO_FORMAT) ==
+                    static_cast<vamiga::i64>(vamiga::TV::NTSC);
+  return ntsc ? 7159090.0 : 7093790.0;
+}
+
+double Milliseconds(Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+}  // namespace
+
+ScriptRunner& ScriptRunner::Instance() {
+  static ScriptRunner instance;
+  return instance;
+}
+
+ScriptRunner::~ScriptRunner() {
+  Stop();
+}
+
+bool ScriptRunner::Load(const std::filesystem::path& path) {
+  if (running_) return false;
+  Stop();
+
+  std::ifstream file(path);
+  if (!file) return false;
+
+  std::vector<Step> steps;
+  std::string line;
+  for (int nr = 1; std::getline(file, line); ++nr) {
+    std::string_view text = Trim(line);
+    if (text.empty() || text.front() == '#') continue;
+
+    Step step;
+    step.line = nr;
+    step.text = text;
+    if (text.starts_with("wait ") || text == "wait") {
+      std::string_view arg = Trim(text.substr(4));
+      double seconds = 1.0;
+      if (!arg.empty()) {
+        auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), seconds);
+        if (ec != std::errc{}) seconds = 1.0;
+      }
+      step.is_wait = true;
+      step.wait_seconds = std::max(seconds, 0.0);
+    }
+    steps.push_back(std::move(step));
+  }
+
+  std::lock_guard lock(mutex_);
+  path_ = path;
+  steps_ = std::move(steps);
+  current_ = -1;
+  return true;
+}
+
+void ScriptRunner::Start(vamiga::VAmiga& emu) {
+  if (running_ || steps_.empty()) return;
+  Stop();
+  {
+    std::lock_guard lock(mutex_);
+    for (auto& step : steps_) {
+      step.status = Status::kPending;
+      step.wall_ms = step.emulated_ms = 0.0;
+    }
+    current_ = -1;
+    started_ = finished_ = Clock::now();
+    shell_state_ = ShellState::kIdle;
+  }
+  transcript_.Reset();
+  abort_ = false;
+  running_ = true;
+  worker_ = std::thread(&ScriptRunner::Run, this, &emu);
+}
+
+void ScriptRunner::Abort() {
+  {
+    std::lock_guard lock(mutex_);
+    abort_ = true;
+  }
+  cv_.notify_all();
+}
+
+void ScriptRunner::Stop() {
+  Abort();
+  if (worker_.joinable()) worker_.join();
+}
+
+bool ScriptRunner::Sleep(std::chrono::milliseconds duration) {
+  std::unique_lock lock(mutex_);
+  return !cv_.wait_for(lock, duration, [this] { return abort_.load(); });
+}
+
+bool ScriptRunner::RunCommand(const std::string& command) {
+  std::unique_lock lock(mutex_);
+  shell_command_ = command;
+  shell_state_ = ShellState::kQueued;
+  const bool finished = cv_.wait_for(lock, kCommandTimeout, [this] {
+    return abort_.load() || shell_state_ == ShellState::kFinished;
+  });
+  shell_state_ = ShellState::kIdle;
+  return finished && !abort_;
+}
+
+void ScriptRunner::Update(vamiga::VAmiga& emu) {
+  if (!running_) return;
+  const char* text = emu.retroShell.text();
+  transcript_.Update(text ? text : "");
+  const int console = static_cast<int>(emu.retroShell.getInfo().console);
+
+  std::lock_guard lock(mutex_);
+  switch (shell_state_) {
+    case ShellState::kQueued:
+      shell_prompt_.assign(transcript_.OpenLine());
+      shell_lines_ = transcript_.CompleteLines();
+      shell_console_ = console;
+      emu.retroShell.press(shell_command_);
+      emu.retroShell.press(vamiga::RSKey::RETURN, false);
+      shell_state_ = ShellState::kTyped;
+      break;
+    case ShellState::kTyped:
+      // The echoed command completes a line even if it prints nothing; a
+      // command that switches consoles comes back with another prompt.
+      if (console != shell_console_ ||
+          (transcript_.CompleteLines() > shell_lines_ && transcript_.OpenLine() == shell_prompt_)) {
+        shell_state_ = ShellState::kFinished;
+        cv_.notify_all();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+bool ScriptRunner::RunWait(vamiga::VAmiga& emu, double seconds) {
+  const auto saved_warp = emu.get(vamiga::Opt::AMIGA_WARP_MODE);
+  if (use_warp_) emu.set(vamiga::Opt::AMIGA_WARP_MODE, WarpAlways());
+  // A wait means emulated time, so a paused machine runs for it.
+  const bool was_paused = !emu.isRunning();
+  if (was_paused) emu.run();
+
+  const auto target = static_cast<int64_t>(seconds * CpuHz(emu));
+  const int64_t start = emu.cpu.getInfo().clock;
+  int64_t last_clock = start;
+  auto last_progress = Clock::now();
+  bool completed = true;
+  while (true) {
+    const int64_t clock = emu.cpu.getInfo().clock;
+    if (clock - start >= target) break;
+    if (clock != last_clock) {
+      last_clock = clock;
+      last_progress = Clock::now();
+    } else if (Clock::now() - last_progress > kCommandTimeout) {
+      // The emulator did not start or stopped on its own.
+      completed = false;
+      break;
+    }
+    if (!Sleep(kPollInterval)) {
+      completed = false;
+      break;
+    }
+  }
+
+  if (was_paused) emu.pause();
+  if (use_warp_) emu.set(vamiga::Opt::AMIGA_WARP_MODE, saved_warp);
+  return completed;
+}
+
+void ScriptRunner::Run(vamiga::VAmiga* emu) {
+  const double hz = CpuHz(*emu);
+  for (std::size_t i = 0; i < steps_.size() && !abort_; ++i) {
+    std::string text;
+    bool is_wait = false;
+    double seconds = 0.0;
+    {
+      std::lock_guard lock(mutex_);
+      current_ = static_cast<int>(i);
+      steps_[i].status = Status::kRunning;
+      text = steps_[i].text;
+      is_wait = steps_[i].is_wait;
+      seconds = steps_[i].wait_seconds;
+    }
+
+    const auto wall_start = Clock::now();
+    const int64_t clock_start = emu->cpu.getInfo().clock;
+    const bool ok = is_wait ? RunWait(*emu, seconds) : RunCommand(text);
+    const int64_t clock_end = emu->cpu.getInfo().clock;
+
+    std::lock_guard lock(mutex_);
+    auto& step = steps_[i];
+    step.wall_ms = Milliseconds(Clock::now() - wall_start);
+    step.emulated_ms = static_cast<double>(clock_end - clock_start) * 1000.0 / hz;
+    step.status = ok ? Status::kDone : abort_ ? Status::kAborted : Status::kTimeout;
+    finished_ = Clock::now();
+  }
+
+  std::lock_guard lock(mutex_);
+  for (auto& step : steps_) {
+    if (step.status == Status::kPending) step.status = Status::kAborted;
+  }
+  finished_ = Clock::now();
+  running_ = false;
+}
+
+void ScriptRunner::Draw(vamiga::VAmiga& emu) {
+  if (!visible_) return;
+  ImGui::SetNextWindowSize(ImVec2(560, 420), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Script Runner", &visible_)) {
+    ImGui::End();
+    return;
+  }
+
+  bool start = false;
+  {
+    std::lock_guard lock(mutex_);
+    ImGui::TextUnformatted(path_.filename().string().c_str());
+    ImGui::SameLine();
+    ImGui::TextDisabled("(%zu steps)", steps_.size());
+
+    if (running_) {
+      if (ImGui::Button(ICON_FA_STOP " Abort")) {
+        abort_ = true;
+        cv_.notify_all();
+      }
+    } else {
+      start = ImGui::Button(ICON_FA_PLAY " Run");
+    }
+    ImGui::SameLine();
+    if (running_) ImGui::BeginDisabled();
+    ImGui::Checkbox("Warp during waits", &use_warp_);
+    if (running_) ImGui::EndDisabled();
+
+    const int done = current_ < 0 ? 0 : current_ + (running_ ? 0 : 1);
+    const double total_ms = Milliseconds((running_ ? Clock::now() : finished_) - started_);
+    std::string overlay = std::format("{}/{}  {:.0f} ms", done, steps_.size(), total_ms);
+    ImGui::ProgressBar(steps_.empty() ? 0.0f : static_cast<float>(done) / steps_.size(),
+                       ImVec2(-1, 0), overlay.c_str());
+
+    static constexpr ImGuiTableFlags kFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+                                              ImGuiTableFlags_BordersInnerV |
+                                              ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("Steps", 5, kFlags)) {
+      ImGui::TableSetupScrollFreeze(0, 1);
+      ImGui::TableSetupColumn("Line", ImGuiTableColumnFlags_WidthFixed, 40);
+      ImGui::TableSetupColumn("Command");
+      ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthFixed, 70);
+      ImGui::TableSetupColumn("Wall", ImGuiTableColumnFlags_WidthFixed, 80);
+      ImGui::TableSetupColumn("Emulated", ImGuiTableColumnFlags_WidthFixed, 80);
+      ImGui::TableHeadersRow();
+
+      ImGuiListClipper clipper;
+      clipper.Begin(static_cast<int>(steps_.size()));
+      if (running_ && current_ >= 0) clipper.IncludeItemByIndex(current_);
+      while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+          const auto& step = steps_[static_cast<std::size_t>(i)];
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::Text("%d", step.line);
+          ImGui::TableNextColumn();
+          ImGui::TextUnformatted(step.text.c_str());
+          ImGui::TableNextColumn();
+          switch (step.status) {
+            case Status::kPending: ImGui::TextDisabled("pending"); break;
+            case Status::kRunning:
+              ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "running");
+              ImGui::SetScrollHereY();
+              break;
+            case Status::kDone: ImGui::TextColored(ImVec4(0.3f, 1.0f, 0.3f, 1.0f), "done"); break;
+            case Status::kTimeout: ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "timeout"); break;
+            case Status::kAborted: ImGui::TextDisabled("aborted"); break;
+          }
+          ImGui::TableNextColumn();
+          if (step.status != Status::kPending) ImGui::Text("%.1f ms", step.wall_ms);
+          ImGui::TableNextColumn();
+          if (step.status != Status::kPending) ImGui::Text("%.1f ms", step.emulated_ms);
+        }
+      }
+      ImGui::EndTable();
+    }
+  }
+  ImGui::End();
+
+  if (start) Start(emu);
+  if (!visible_) Abort();
+}
+
+}
@@ -0,0 +1,95 @@
+#ifndef LINUXGUI_COMPONENTS_SCRIPT_RUNNER_H_
+#define LINUXGUI_COMPONENTS_SCRIPT_RUNNER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include "VAmiga.h"
+#undef unreachable
+#define unreachable std::unreachable()
+#include "services/shell_transcript.h"
+
+namespace gui {
+
+// Feeds a command file into RetroShell one line at a time from a worker
+// thread. The worker hands each command to Update(), which types it on the
+// GUI thread, the only thread that touches the shell. A command is finished
+// once the shell has completed at least one new line and shows its prompt
+// again; "wait <seconds>" lines let the emulator run for that much emulated
+// time, optionally in warp mode.
+class ScriptRunner {
+ public:
+  enum class Status { kPending, kRunning, kDone, kTimeout, kAborted };
+
+  struct Step {
+    int line = 0;
+    std::string text;
+    bool is_wait = false;
+    double wait_seconds = 0.0;
+    Status status = Status::kPending;
+    double wall_ms = 0.0;
+    double emulated_ms = 0.0;
+  };
+
+  static ScriptRunner& Instance();
+  ~ScriptRunner();
+
+  bool Load(const std::filesystem::path& path);
+  void Start(vamiga::VAmiga& emu);
+  void Abort();
+  // Aborts and joins the worker; call before the emulator goes away.
+  void Stop();
+  bool IsRunning() const { return running_; }
+
+  // Types queued commands and watches the shell; call once per frame.
+  void Update(vamiga::VAmiga& emu);
+  void Open() { visible_ = true; }
+  void Draw(vamiga::VAmiga& emu);
+
+ private:
+  ScriptRunner() = default;
+
+  enum class ShellState { kIdle, kQueued, kTyped, kFinished };
+
+  void Run(vamiga::VAmiga* emu);
+  bool RunCommand(const std::string& command);
+  bool RunWait(vamiga::VAmiga& emu, double seconds);
+  bool Sleep(std::chrono::milliseconds duration);
+
+  static constexpr auto kPollInterval = std::chrono::milliseconds(2);
+  static constexpr auto kCommandTimeout = std::chrono::seconds(30);
+
+  std::filesystem::path path_;
+  std::vector<Step> steps_;
+  int current_ = -1;
+  bool use_warp_ = true;
+  bool visible_ = false;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread worker_;
+  std::atomic<bool> running_ = false;
+  std::atomic<bool> abort_ = false;
+  std::chrono::steady_clock::time_point started_;
+  std::chrono::steady_clock::time_point finished_;
+
+  // Command hand-over between the worker and Update(), guarded by mutex_.
+  ShellState shell_state_ = ShellState::kIdle;
+  std::string shell_command_;
+  std::string shell_prompt_;
+  uint64_t shell_lines_ = 0;
+  int shell_console_ = 0;
+  // Only touched by Update() on the GUI thread.
+  ShellTranscript transcript_;
+};
+
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "components/settings_window.h"
 #include "input_manager.h"
+#include <algorithm>
 #include <array>
 #include <exception>
 #include <format>
@@ -10,6 +11,8 @@
 #include "Infrastructure/Option.h"
 #include "components/file_picker.h"
 #include "components/hard_disk_creator.h"
+#include "components/rewind_controller.h"
+#include "services/log_writer.h"
 #include "imgui.h"
 namespace ImGui {
 inline bool InputText(const char* label, std::string* str,
@@ -305,7 +308,24 @@ void SettingsWindow::DrawInputs(vamiga::VAmiga& emulator, const SettingsContext&
   ImGui::Separator();
   ImGui::Text("Mouse Release");
   if (ImGui::Checkbox("Release mouse by shaking", ctx.release_mouse_by_shaking)) changed = true;
+  ImGui::Separator();
+  ImGui::Text("Mouse Motion");
+  static constexpr std::array<int, 4> kDeliveries = {0, 1, 2, 4};
+  static constexpr std::array kDeliveryNames = {"Every event", "Once per frame",
+                                                "Twice per frame", "4x per frame"};
+  const auto it = std::ranges::find(kDeliveries, *ctx.mouse_deliveries);
+  int delivery = it == kDeliveries.end() ? 1 : static_cast<int>(it - kDeliveries.begin());
+  if (ImGui::Combo("Delivery", &delivery, kDeliveryNames.data(),
+                   static_cast<int>(kDeliveryNames.size()))) {
+    *ctx.mouse_deliveries = kDeliveries[static_cast<std::size_t>(delivery)];
+    changed = true;
+  }
+  ImGui::TextDisabled("Coalesces host mouse events, paced by emulated time");
   ImGui::TextDisabled("Note: You can always release the mouse by pressing Ctrl+G");
+  ImGui::Separator();
+  ImGui::Text("Gamepads");
+  if (ImGui::Checkbox("Poll gamepads at 1 kHz", ctx.gamepad_polling)) changed = true;
+  ImGui::TextDisabled("Reads controllers on a separate thread instead of once per frame");
   if (changed && ctx.on_save_config) ctx.on_save_config();
 }
 void SettingsWindow::DrawROMs(vamiga::VAmiga& emulator, const SettingsContext& ctx) {
@@ -513,7 +533,25 @@ void SettingsWindow::DrawCaptures(vamiga::VAmiga& emulator, const SettingsContex
             *ctx.snapshot_auto_delete = auto_del;
             if (ctx.on_save_config) ctx.on_save_config();
         }
-        ImGui::TextDisabled("Limits snapshots to %d.", gui::Defaults::kSnapshotLimit);
+        ImGui::TextDisabled("Keeps the newest %d snapshots in the library.", gui::Defaults::kSnapshotLimit);
+    }
+    if (ctx.snapshot_compress) {
+        if (ImGui::Checkbox("Compress Snapshots", ctx.snapshot_compress)) {
+            if (ctx.on_save_config) ctx.on_save_config();
+        }
+        ImGui::SetItemTooltip("LZ-compressed snapshots load in this frontend only.");
+    }
+    if (ctx.snapshot_dedup) {
+        if (ImGui::Checkbox("Deduplicate Library Snapshots", ctx.snapshot_dedup)) {
+            if (ctx.on_save_config) ctx.on_save_config();
+        }
+        ImGui::SetItemTooltip("Library snapshots share identical chunks; they load in this frontend only.");
+    }
+    if (ctx.slots_persist) {
+        if (ImGui::Checkbox("Keep Quick Slots on Disk", ctx.slots_persist)) {
+            if (ctx.on_save_config) ctx.on_save_config();
+        }
+        ImGui::TextDisabled("Ctrl+Shift+F1..F10 saves a slot, Ctrl+F1..F10 restores it.");
     }
     
     ImGui::Spacing();
@@ -530,6 +568,53 @@ void SettingsWindow::DrawCaptures(vamiga::VAmiga& emulator, const SettingsContex
         static constexpr std::array sources = { "Framebuffer" };
         ImGui::Combo("Source", ctx.screenshot_source, sources.data(), sources.size());
     }
+
+    ImGui::Spacing();
+    ImGui::Text("Console Log");
+    ImGui::Separator();
+
+    if (ctx.log_enabled && ctx.log_max_kb && ctx.log_max_files && ctx.log_compress) {
+        bool changed = ImGui::Checkbox("Write RetroShell output to file", ctx.log_enabled);
+        if (!*ctx.log_enabled) ImGui::BeginDisabled();
+        // Reopening the log restarts its writer thread, so numeric fields
+        // apply once editing ends rather than on every keystroke.
+        ImGui::SetNextItemWidth(150);
+        ImGui::InputInt("Max Size (KB)", ctx.log_max_kb, 256, 1024);
+        changed |= ImGui::IsItemDeactivatedAfterEdit();
+        ImGui::SetNextItemWidth(150);
+        ImGui::SliderInt("Rotated Files", ctx.log_max_files, 1, 20);
+        changed |= ImGui::IsItemDeactivatedAfterEdit();
+        if (!LogWriter::CompressionAvailable()) ImGui::BeginDisabled();
+        changed |= ImGui::Checkbox("Compress Rotated Files", ctx.log_compress);
+        if (!LogWriter::CompressionAvailable()) {
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            ImGui::TextDisabled("(built without zlib)");
+        }
+        if (!*ctx.log_enabled) ImGui::EndDisabled();
+        *ctx.log_max_kb = std::max(*ctx.log_max_kb, 16);
+        if (changed && ctx.on_log_changed) ctx.on_log_changed();
+    }
+
+    ImGui::Spacing();
+    ImGui::Text("Rewind");
+    ImGui::Separator();
+
+    if (ctx.rewind_enabled && ctx.rewind_interval && ctx.rewind_budget_mb) {
+        bool changed = ImGui::Checkbox("Keep rewind history (hold F11)", ctx.rewind_enabled);
+        if (!*ctx.rewind_enabled) ImGui::BeginDisabled();
+        ImGui::SetNextItemWidth(150);
+        changed |= ImGui::SliderInt("Snapshot Every (frames)", ctx.rewind_interval, 1, 50);
+        ImGui::SetNextItemWidth(150);
+        changed |= ImGui::SliderInt("Memory Budget (MB)", ctx.rewind_budget_mb, 8, 512);
+        const auto& rewind = RewindController::Instance();
+        ImGui::TextDisabled("%zu steps, %.1f s, %.1f MB, last capture %.2f ms", rewind.Depth(),
+                            rewind.HistorySeconds(),
+                            static_cast<double>(rewind.MemoryBytes()) / (1024.0 * 1024.0),
+                            rewind.LastCaptureMs());
+        if (!*ctx.rewind_enabled) ImGui::EndDisabled();
+        if (changed && ctx.on_rewind_changed) ctx.on_rewind_changed();
+    }
 }
 
 void SettingsWindow::DrawPeripherals(vamiga::VAmiga& emulator, const SettingsContext& ctx) {
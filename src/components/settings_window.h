@@ -24,13 +24,25 @@ struct SettingsContext {
   bool* retain_mouse_by_click;
   bool* retain_mouse_by_entering;
   bool* release_mouse_by_shaking;
+  bool* gamepad_polling;
+  int* mouse_deliveries;
   int* volume;
   int* scale_mode;
   bool* is_fullscreen;
   bool* video_as_background;
   bool* snapshot_auto_delete;
+  bool* snapshot_compress;
+  bool* snapshot_dedup;
+  bool* slots_persist;
   int* screenshot_format;
   int* screenshot_source;
+  bool* log_enabled;
+  int* log_max_kb;
+  int* log_max_files;
+  bool* log_compress;
+  bool* rewind_enabled;
+  int* rewind_interval;
+  int* rewind_budget_mb;
   int* port1_device;
   int* port2_device;
   ::InputManager* input_manager;
@@ -45,6 +57,8 @@ struct SettingsContext {
   std::function<void()> on_save_config;
   std::function<void()> on_toggle_fullscreen;
   std::function<void()> on_port_changed;
+  std::function<void()> on_log_changed;
+  std::function<void()> on_rewind_changed;
 };
 class SettingsWindow {
  public:
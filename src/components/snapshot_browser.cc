@@ -0,0 +1,120 @@
+#include "snapshot_browser.h"
+
+#include <SDL_opengl.h>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#include "imgui.h"
+#include "resources/IconsFontAwesome6.h"
+
+namespace gui {
+
+namespace {
+std::string FormatTime(int64_t seconds) {
+  const std::time_t t = static_cast<std::time_t>(seconds);
+  std::tm local{};
+  localtime_r(&t, &local);
+  char buf[32];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &local);
+  return buf;
+}
+}  // namespace
+
+SnapshotBrowser& SnapshotBrowser::Instance() {
+  static SnapshotBrowser instance;
+  return instance;
+}
+
+void SnapshotBrowser::ReleaseTextures() {
+  for (auto& [name, texture] : textures_) glDeleteTextures(1, &texture.id);
+  textures_.clear();
+  lru_.clear();
+}
+
+unsigned int SnapshotBrowser::Texture(const SnapshotLibrary::Entry& entry) {
+  if (auto it = textures_.find(entry.file); it != textures_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    if (it->second.time == entry.time) return it->second.id;
+    // The snapshot was saved again under the same name.
+    glDeleteTextures(1, &it->second.id);
+    lru_.erase(it->second.lru);
+    textures_.erase(it);
+  }
+  std::vector<uint32_t> pixels;
+  if (!SnapshotLibrary::UnpackThumbnail(entry.thumbnail, pixels)) return 0;
+
+  if (textures_.size() >= kMaxTextures) {
+    auto oldest = textures_.find(lru_.back());
+    glDeleteTextures(1, &oldest->second.id);
+    textures_.erase(oldest);
+    lru_.pop_back();
+  }
+  GLuint id = 0;
+  glGenTextures(1, &id);
+  glBindTexture(GL_TEXTURE_2D, id);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SnapshotLibrary::kThumbWidth,
+               SnapshotLibrary::kThumbHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  lru_.push_front(entry.file);
+  textures_[entry.file] = {id, entry.time, lru_.begin()};
+  return id;
+}
+
+void SnapshotBrowser::Draw(bool* p_open, SnapshotLibrary& library, const LoadCallback& on_load,
+                           const RemoveCallback& on_remove) {
+  if (!p_open || !*p_open) return;
+  ImGui::SetNextWindowSize(ImVec2(520, 480), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Snapshot Library", p_open)) {
+    ImGui::End();
+    return;
+  }
+  const auto& entries = library.Entries();
+  ImGui::Text("%zu snapshots in %s", entries.size(), library.Dir().string().c_str());
+  ImGui::Separator();
+
+  const ImVec2 thumb(SnapshotLibrary::kThumbWidth, SnapshotLibrary::kThumbHeight);
+  const float row_height = thumb.y + ImGui::GetStyle().ItemSpacing.y;
+  std::string remove;
+  if (ImGui::BeginChild("SnapshotList")) {
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(entries.size()), row_height);
+    while (clipper.Step()) {
+      for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+        const auto& entry = entries[entries.size() - 1 - static_cast<std::size_t>(row)];
+        ImGui::PushID(entry.file.c_str());
+        if (const unsigned int tex = Texture(entry)) {
+          ImGui::Image((void*)(intptr_t)tex, thumb);
+        } else {
+          ImGui::Dummy(thumb);
+        }
+        ImGui::SameLine();
+        ImGui::BeginGroup();
+        ImGui::TextUnformatted(entry.title.empty() ? entry.file.c_str() : entry.title.c_str());
+        ImGui::TextDisabled("%s, %llu KB", FormatTime(entry.time).c_str(),
+                            static_cast<unsigned long long>(entry.bytes / 1024));
+        if (ImGui::SmallButton(ICON_FA_UPLOAD " Load")) on_load(library.PathOf(entry));
+        ImGui::SameLine();
+        if (ImGui::SmallButton(ICON_FA_TRASH " Delete")) remove = entry.file;
+        ImGui::EndGroup();
+        ImGui::PopID();
+      }
+    }
+  }
+  ImGui::EndChild();
+  ImGui::End();
+
+  if (!remove.empty()) {
+    if (auto it = textures_.find(remove); it != textures_.end()) {
+      glDeleteTextures(1, &it->second.id);
+      lru_.erase(it->second.lru);
+      textures_.erase(it);
+    }
+    if (library.Remove(remove) && on_remove) on_remove();
+  }
+}
+
+}
@@ -0,0 +1,48 @@
+#ifndef LINUXGUI_COMPONENTS_SNAPSHOT_BROWSER_H_
+#define LINUXGUI_COMPONENTS_SNAPSHOT_BROWSER_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "services/snapshot_library.h"
+
+namespace gui {
+
+// Lists the snapshot library, newest first, straight from its index. Only
+// rows that are on screen are drawn, and thumbnails are uploaded to
+// textures the first time they become visible; a bounded cache keeps the
+// most recently shown ones.
+class SnapshotBrowser {
+ public:
+  using LoadCallback = std::function<void(const std::filesystem::path&)>;
+  // Runs after a snapshot was deleted from the library.
+  using RemoveCallback = std::function<void()>;
+
+  static constexpr std::size_t kMaxTextures = 128;
+
+  static SnapshotBrowser& Instance();
+
+  void Draw(bool* p_open, SnapshotLibrary& library, const LoadCallback& on_load,
+            const RemoveCallback& on_remove);
+  // Needs a current GL context.
+  void ReleaseTextures();
+
+ private:
+  SnapshotBrowser() = default;
+  unsigned int Texture(const SnapshotLibrary::Entry& entry);
+
+  struct CachedTexture {
+    unsigned int id = 0;
+    int64_t time = 0;
+    std::list<std::string>::iterator lru;
+  };
+  std::unordered_map<std::string, CachedTexture> textures_;
+  std::list<std::string> lru_;  // most recently used first
+};
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "Components/AmigaTypes.h"
+#include "components/input_manager.h"
 
 namespace gui {
 
@@ -12,14 +13,15 @@ VirtualKeyboard& VirtualKeyboard::Instance() {
   return instance;
 }
 
-void VirtualKeyboard::DrawKey(vamiga::VAmiga& emu, std::string_view label, int width,
+void VirtualKeyboard::DrawKey(InputManager& input, std::string_view label, int width,
                               int code) {
-  if (ImGui::Button(label.data(), ImVec2(width == 0 ? 40 : width, 40))) {
-    emu.keyboard.press((vamiga::KeyCode)code, 0.0, 0.05);
-  }
+  // The key stays down while the button is held.
+  ImGui::Button(label.data(), ImVec2(width == 0 ? 40 : width, 40));
+  if (ImGui::IsItemActivated()) input.PressKey(static_cast<vamiga::KeyCode>(code));
+  if (ImGui::IsItemDeactivated()) input.ReleaseKey(static_cast<vamiga::KeyCode>(code));
 }
 
-void VirtualKeyboard::Draw(bool* p_open, vamiga::VAmiga& emu) {
+void VirtualKeyboard::Draw(bool* p_open, InputManager& input) {
   if (!p_open || !*p_open) return;
 
   ImGui::SetNextWindowSize(ImVec2(800, 300), ImGuiCond_FirstUseEver);
@@ -31,127 +33,127 @@ void VirtualKeyboard::Draw(bool* p_open, vamiga::VAmiga& emu) {
   const int kw = 40;
   ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(2, 2));
 
-  DrawKey(emu, "ESC", kw, 0x45);
+  DrawKey(input, "ESC", kw, 0x45);
   ImGui::SameLine();
   for (int i = 0; i < 10; i++) {
     std::string buf = std::format("F{{}}", i + 1);
-    DrawKey(emu, buf.c_str(), kw, 0x50 + i);
+    DrawKey(input, buf.c_str(), kw, 0x50 + i);
     ImGui::SameLine();
   }
-  DrawKey(emu, "DEL", kw, 0x46);
+  DrawKey(input, "DEL", kw, 0x46);
   ImGui::NewLine();
 
-  DrawKey(emu, "`", kw, 0x00);
+  DrawKey(input, "`", kw, 0x00);
   ImGui::SameLine();
   for (int i = 1; i <= 9; i++) {
     char c = static_cast<char>('0' + i);
     std::string buf = std::format("{}", c);
-    DrawKey(emu, buf.c_str(), kw, i);
+    DrawKey(input, buf.c_str(), kw, i);
     ImGui::SameLine();
   }
-  DrawKey(emu, "0", kw, 0x0A);
+  DrawKey(input, "0", kw, 0x0A);
   ImGui::SameLine();
-  DrawKey(emu, "-", kw, 0x0B);
+  DrawKey(input, "-", kw, 0x0B);
   ImGui::SameLine();
-  DrawKey(emu, "=", kw, 0x0C);
+  DrawKey(input, "=", kw, 0x0C);
   ImGui::SameLine();
-  DrawKey(emu, "\\", kw, 0x0D);
+  DrawKey(input, "\\", kw, 0x0D);
   ImGui::SameLine();
-  DrawKey(emu, "<-", kw * 2, 0x41);
+  DrawKey(input, "<-", kw * 2, 0x41);
   ImGui::NewLine();
 
-  DrawKey(emu, "TAB", static_cast<int>(kw * 1.5), 0x42);
+  DrawKey(input, "TAB", static_cast<int>(kw * 1.5), 0x42);
   ImGui::SameLine();
-  DrawKey(emu, "Q", kw, 0x10);
+  DrawKey(input, "Q", kw, 0x10);
   ImGui::SameLine();
-  DrawKey(emu, "W", kw, 0x11);
+  DrawKey(input, "W", kw, 0x11);
   ImGui::SameLine();
-  DrawKey(emu, "E", kw, 0x12);
+  DrawKey(input, "E", kw, 0x12);
   ImGui::SameLine();
-  DrawKey(emu, "R", kw, 0x13);
+  DrawKey(input, "R", kw, 0x13);
   ImGui::SameLine();
-  DrawKey(emu, "T", kw, 0x14);
+  DrawKey(input, "T", kw, 0x14);
   ImGui::SameLine();
-  DrawKey(emu, "Y", kw, 0x15);
+  DrawKey(input, "Y", kw, 0x15);
   ImGui::SameLine();
-  DrawKey(emu, "U", kw, 0x16);
+  DrawKey(input, "U", kw, 0x16);
   ImGui::SameLine();
-  DrawKey(emu, "I", kw, 0x17);
+  DrawKey(input, "I", kw, 0x17);
   ImGui::SameLine();
-  DrawKey(emu, "O", kw, 0x18);
+  DrawKey(input, "O", kw, 0x18);
   ImGui::SameLine();
-  DrawKey(emu, "P", kw, 0x19);
+  DrawKey(input, "P", kw, 0x19);
   ImGui::SameLine();
-  DrawKey(emu, "[", kw, 0x1A);
+  DrawKey(input, "[", kw, 0x1A);
   ImGui::SameLine();
-  DrawKey(emu, "]", kw, 0x1B);
+  DrawKey(input, "]", kw, 0x1B);
   ImGui::SameLine();
-  DrawKey(emu, "RET", static_cast<int>(kw * 1.5), 0x44);
+  DrawKey(input, "RET", static_cast<int>(kw * 1.5), 0x44);
   ImGui::NewLine();
 
-  DrawKey(emu, "CTRL", static_cast<int>(kw * 1.8), 0x63);
+  DrawKey(input, "CTRL", static_cast<int>(kw * 1.8), 0x63);
   ImGui::SameLine();
-  DrawKey(emu, "A", kw, 0x20);
+  DrawKey(input, "A", kw, 0x20);
   ImGui::SameLine();
-  DrawKey(emu, "S", kw, 0x21);
+  DrawKey(input, "S", kw, 0x21);
   ImGui::SameLine();
-  DrawKey(emu, "D", kw, 0x22);
+  DrawKey(input, "D", kw, 0x22);
   ImGui::SameLine();
-  DrawKey(emu, "F", kw, 0x23);
+  DrawKey(input, "F", kw, 0x23);
   ImGui::SameLine();
-  DrawKey(emu, "G", kw, 0x24);
+  DrawKey(input, "G", kw, 0x24);
   ImGui::SameLine();
-  DrawKey(emu, "H", kw, 0x25);
+  DrawKey(input, "H", kw, 0x25);
   ImGui::SameLine();
-  DrawKey(emu, "J", kw, 0x26);
+  DrawKey(input, "J", kw, 0x26);
   ImGui::SameLine();
-  DrawKey(emu, "K", kw, 0x27);
+  DrawKey(input, "K", kw, 0x27);
   ImGui::SameLine();
-  DrawKey(emu, "L", kw, 0x28);
+  DrawKey(input, "L", kw, 0x28);
   ImGui::SameLine();
-  DrawKey(emu, ";", kw, 0x29);
+  DrawKey(input, ";", kw, 0x29);
   ImGui::SameLine();
-  DrawKey(emu, "'", kw, 0x2A);
+  DrawKey(input, "'", kw, 0x2A);
   ImGui::SameLine();
-  DrawKey(emu, "#", kw, 0x2B);
+  DrawKey(input, "#", kw, 0x2B);
   ImGui::NewLine();
 
-  DrawKey(emu, "SHIFT", static_cast<int>(kw * 2.3), 0x60);
+  DrawKey(input, "SHIFT", static_cast<int>(kw * 2.3), 0x60);
   ImGui::SameLine();
-  DrawKey(emu, "<", kw, 0x30);
+  DrawKey(input, "<", kw, 0x30);
   ImGui::SameLine();
-  DrawKey(emu, "Z", kw, 0x31);
+  DrawKey(input, "Z", kw, 0x31);
   ImGui::SameLine();
-  DrawKey(emu, "X", kw, 0x32);
+  DrawKey(input, "X", kw, 0x32);
   ImGui::SameLine();
-  DrawKey(emu, "C", kw, 0x33);
+  DrawKey(input, "C", kw, 0x33);
   ImGui::SameLine();
-  DrawKey(emu, "V", kw, 0x34);
+  DrawKey(input, "V", kw, 0x34);
   ImGui::SameLine();
-  DrawKey(emu, "B", kw, 0x35);
+  DrawKey(input, "B", kw, 0x35);
   ImGui::SameLine();
-  DrawKey(emu, "N", kw, 0x36);
+  DrawKey(input, "N", kw, 0x36);
   ImGui::SameLine();
-  DrawKey(emu, "M", kw, 0x37);
+  DrawKey(input, "M", kw, 0x37);
   ImGui::SameLine();
-  DrawKey(emu, ",", kw, 0x38);
+  DrawKey(input, ",", kw, 0x38);
   ImGui::SameLine();
-  DrawKey(emu, ".", kw, 0x39);
+  DrawKey(input, ".", kw, 0x39);
   ImGui::SameLine();
-  DrawKey(emu, "/", kw, 0x3A);
+  DrawKey(input, "/", kw, 0x3A);
   ImGui::SameLine();
-  DrawKey(emu, "SHIFT", static_cast<int>(kw * 2.3), 0x61);
+  DrawKey(input, "SHIFT", static_cast<int>(kw * 2.3), 0x61);
   ImGui::NewLine();
 
-  DrawKey(emu, "ALT", static_cast<int>(kw * 1.5), 0x64);
+  DrawKey(input, "ALT", static_cast<int>(kw * 1.5), 0x64);
   ImGui::SameLine();
-  DrawKey(emu, "L-A", static_cast<int>(kw * 1.5), 0x66);
+  DrawKey(input, "L-A", static_cast<int>(kw * 1.5), 0x66);
   ImGui::SameLine();
-  DrawKey(emu, "SPACE", kw * 7, 0x40);
+  DrawKey(input, "SPACE", kw * 7, 0x40);
   ImGui::SameLine();
-  DrawKey(emu, "R-A", static_cast<int>(kw * 1.5), 0x67);
+  DrawKey(input, "R-A", static_cast<int>(kw * 1.5), 0x67);
   ImGui::SameLine();
-  DrawKey(emu, "ALT", static_cast<int>(kw * 1.5), 0x65);
+  DrawKey(input, "ALT", static_cast<int>(kw * 1.5), 0x65);
 
   ImGui::PopStyleVar();
   ImGui::End();
@@ -6,14 +6,16 @@
 #undef unreachable
 #define unreachable std::unreachable()
 #include "imgui.h"
+class InputManager;
 namespace gui {
 class VirtualKeyboard {
  public:
   static VirtualKeyboard& Instance();
-  void Draw(bool* p_open, vamiga::VAmiga& emu);
+  // Keys go through the InputManager so that movies record them.
+  void Draw(bool* p_open, InputManager& input);
  private:
   VirtualKeyboard() = default;
-  void DrawKey(vamiga::VAmiga& emu, std::string_view label, int width, int code);
+  void DrawKey(InputManager& input, std::string_view label, int width, int code);
 };
 }
 #endif
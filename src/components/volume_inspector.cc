@@ -1,5 +1,10 @@
 #include "volume_inspector.h"
 #include "../compat.h"
+#include <SDL_opengl.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <format>
 #include <ranges>
 #include <string_view>
@@ -86,55 +91,162 @@ VolumeInspector& VolumeInspector::Instance() {
   return instance;
 }
 
+VolumeInspector::~VolumeInspector() { Stop(); }
+
+void VolumeInspector::Stop() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+    ++generation_;
+  }
+  cv_.notify_one();
+  if (worker_.joinable()) worker_.join();
+  StopExtraction();
+  ReleaseTextures();
+}
+
 void VolumeInspector::Open(int drive_nr, bool is_hd, vamiga::VAmiga& emu, int partition) {
   drive_nr_ = drive_nr;
   is_hd_ = is_hd;
   part_ = partition;
+  if (extract_dir_[0] == '\0') {
+    const char* home = std::getenv("HOME");
+    std::snprintf(extract_dir_.data(), extract_dir_.size(), "%s", home ? home : ".");
+  }
   Refresh(emu);
   open_ = true;
 }
 
-void VolumeInspector::Refresh(vamiga::VAmiga& emu) {
-  fs_.reset();
-  usage_map_.clear();
-  alloc_map_.clear();
-  health_map_.clear();
-  type_counts_.fill(0);
+void VolumeInspector::Refresh(vamiga::VAmiga& emu) { Submit(emu, nullptr, false); }
+
+void VolumeInspector::Submit(vamiga::VAmiga& emu, std::unique_ptr<Analysis> reuse, bool rectify) {
+  // The extraction reads the mounted volume, which is about to change.
+  StopExtraction();
+  volume_.reset();
+  dir_cache_.clear();
+  current_.reset();
+  analyzing_ = true;
+  cancelled_ = false;
+  stage_ = 0;
+  {
+    std::lock_guard lock(mutex_);
+    // Bumping the generation makes a running analysis give up at its next
+    // stage; a request that has not been picked up yet is replaced.
+    job_ = Job{++generation_, &emu, drive_nr_, is_hd_, part_, std::move(reuse), rectify};
+    ready_.reset();
+  }
+  cv_.notify_one();
+  if (!worker_.joinable()) worker_ = std::thread(&VolumeInspector::Run, this);
+}
 
-  try {
-    if (is_hd_) {
-      auto hd_info = emu.hd[drive_nr_]->getInfo();
-      if (hd_info.hasDisk && emu.hd[drive_nr_]->drive) {
-        fs_ = std::make_unique<vamiga::MutableFileSystem>(*emu.hd[drive_nr_]->drive,
-                                                          part_);
-      }
-    } else {
-      auto df_info = emu.df[drive_nr_]->getInfo();
-      if (df_info.hasDisk && emu.df[drive_nr_]->drive) {
-        fs_ = std::make_unique<vamiga::MutableFileSystem>(*emu.df[drive_nr_]->drive);
-      }
+void VolumeInspector::Cancel() {
+  StopExtraction();
+  {
+    std::lock_guard lock(mutex_);
+    ++generation_;
+    job_.reset();
+  }
+  analyzing_ = false;
+  cancelled_ = true;
+}
+
+void VolumeInspector::Poll() {
+  std::lock_guard lock(mutex_);
+  if (!ready_ || ready_generation_ != generation_) return;
+  current_ = std::move(ready_);
+  analyzing_ = false;
+  for (auto& map : maps_) map.dirty = true;
+  selected_block_ = std::clamp(
+      selected_block_, 0,
+      static_cast<int>(current_->info.numBlocks > 0 ? current_->info.numBlocks - 1 : 0));
+  if (!current_->fs || current_->info.numBlocks <= 0) return;
+
+  // Blocks are copied out one at a time, so the tree and the extraction
+  // never hold more than a block of a file in memory.
+  const auto traits = current_->fs->getTraits();
+  auto* fs = current_->fs.get();
+  const auto blocks = static_cast<uint32_t>(current_->info.numBlocks);
+  volume_ = std::make_unique<AmigaVolume>(
+      [fs](uint32_t nr, std::span<uint8_t> out) {
+        auto* blk = fs->read(static_cast<vamiga::Block>(nr));
+        if (!blk || !blk->data()) return false;
+        std::memcpy(out.data(), blk->data(), out.size());
+        return true;
+      },
+      blocks, static_cast<uint32_t>(traits.bsize), vamiga::isOFSVolumeType(traits.dos));
+  root_block_ = AmigaVolume::RootBlock(blocks);
+  if (!volume_->IsDirectory(root_block_)) volume_.reset();
+}
+
+void VolumeInspector::Run() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || job_.has_value(); });
+      if (stop_) return;
+      job = std::move(*job_);
+      job_.reset();
+    }
+    auto result = Analyze(job);
+    std::lock_guard lock(mutex_);
+    if (result && !Superseded(job)) {
+      ready_ = std::move(result);
+      ready_generation_ = job.generation;
     }
-  } catch (...) {
-    fs_.reset();
   }
+}
 
-  if (fs_) {
-    info_ = fs_->getInfo();
-    const size_t block_count = static_cast<size_t>(info_.numBlocks);
-    usage_map_.resize(block_count);
-    alloc_map_.resize(block_count);
-    health_map_.resize(block_count);
-    if (!usage_map_.empty()) {
-      fs_->createUsageMap(usage_map_.data(), static_cast<vamiga::isize>(usage_map_.size()));
-      fs_->createAllocationMap(alloc_map_.data(), static_cast<vamiga::isize>(alloc_map_.size()));
-      fs_->createHealthMap(health_map_.data(), static_cast<vamiga::isize>(health_map_.size()));
-      for (auto v : usage_map_) {
-        auto idx = static_cast<size_t>(v);
-        if (idx < type_counts_.size()) type_counts_[idx]++;
+std::unique_ptr<VolumeInspector::Analysis> VolumeInspector::Analyze(Job& job) {
+  auto stage = [this](Stage s) { stage_ = static_cast<int>(s); };
+  auto a = std::move(job.reuse);
+  stage(Stage::kMount);
+  if (!a) {
+    // The drive is read while the emulator keeps running, as before.
+    a = std::make_unique<Analysis>();
+    try {
+      if (job.is_hd) {
+        auto& hd = *job.emu->hd[job.drive_nr];
+        if (hd.getInfo().hasDisk && hd.drive) {
+          a->fs = std::make_unique<vamiga::MutableFileSystem>(*hd.drive, job.part);
+        }
+      } else {
+        auto& df = *job.emu->df[job.drive_nr];
+        if (df.getInfo().hasDisk && df.drive) {
+          a->fs = std::make_unique<vamiga::MutableFileSystem>(*df.drive);
+        }
       }
+    } catch (...) {
+      a->fs.reset();
     }
-    selected_block_ = std::clamp(selected_block_, 0, static_cast<int>(info_.numBlocks > 0 ? info_.numBlocks - 1 : 0));
+  } else if (job.rectify && a->fs) {
+    a->fs->rectifyAllocationMap();
   }
+  if (!a->fs) return a;
+  if (Superseded(job)) return nullptr;
+
+  a->info = a->fs->getInfo();
+  const auto blocks = static_cast<size_t>(std::max<vamiga::isize>(a->info.numBlocks, 0));
+  const auto n = static_cast<vamiga::isize>(blocks);
+  a->usage_map.assign(blocks, 0);
+  a->alloc_map.assign(blocks, 0);
+  a->health_map.assign(blocks, 0);
+  a->type_counts.fill(0);
+  if (blocks == 0) return a;
+
+  stage(Stage::kUsage);
+  a->fs->createUsageMap(a->usage_map.data(), n);
+  for (auto v : a->usage_map) {
+    auto idx = static_cast<size_t>(v);
+    if (idx < a->type_counts.size()) a->type_counts[idx]++;
+  }
+  if (Superseded(job)) return nullptr;
+  stage(Stage::kAllocation);
+  a->fs->createAllocationMap(a->alloc_map.data(), n);
+  if (Superseded(job)) return nullptr;
+  stage(Stage::kHealth);
+  a->fs->createHealthMap(a->health_map.data(), n);
+  return Superseded(job) ? nullptr : std::move(a);
 }
 
 void VolumeInspector::Draw(vamiga::VAmiga& emu) {
@@ -145,6 +257,7 @@ void VolumeInspector::Draw(vamiga::VAmiga& emu) {
   }
 
   if (ImGui::BeginPopupModal("Volume Inspector", nullptr, ImGuiWindowFlags_None)) {
+    Poll();
     int partitions = 1;
     if (is_hd_) {
       auto hd_info = emu.hd[drive_nr_]->getInfo();
@@ -152,13 +265,6 @@ void VolumeInspector::Draw(vamiga::VAmiga& emu) {
       part_ = std::clamp(part_, 0, partitions - 1);
     }
 
-    if (!fs_) {
-      ImGui::Text("No formatted volume available.");
-      if (ImGui::Button("Close")) ImGui::CloseCurrentPopup();
-      ImGui::EndPopup();
-      return;
-    }
-
     if (ImGui::Button(ICON_FA_ROTATE " Refresh")) {
       Refresh(emu);
     }
@@ -175,71 +281,275 @@ void VolumeInspector::Draw(vamiga::VAmiga& emu) {
       }
     }
 
-    DrawInfo();
-    ImGui::Separator();
-    DrawUsage();
-    ImGui::Separator();
-    DrawAllocation();
-    ImGui::Separator();
-    DrawHealth(emu);
-    ImGui::Separator();
-    DrawBlockView();
+    if (analyzing_) {
+      DrawProgress();
+    } else if (cancelled_) {
+      ImGui::TextDisabled("Analysis cancelled.");
+    } else if (!current_ || !current_->fs) {
+      ImGui::Text("No formatted volume available.");
+    } else {
+      DrawInfo();
+      ImGui::Separator();
+      DrawFiles();
+      ImGui::Separator();
+      DrawUsage();
+      ImGui::Separator();
+      DrawAllocation();
+      ImGui::Separator();
+      DrawHealth(emu);
+      ImGui::Separator();
+      DrawBlockView();
+      // Both re-run the maps on the worker with the mounted volume.
+      if (rectify_requested_ || recheck_requested_) {
+        Submit(emu, std::move(current_), rectify_requested_);
+      }
+    }
+    rectify_requested_ = recheck_requested_ = false;
 
     ImGui::Separator();
-    if (ImGui::Button("Close")) ImGui::CloseCurrentPopup();
+    if (ImGui::Button("Close")) {
+      Cancel();
+      ImGui::CloseCurrentPopup();
+    }
     ImGui::EndPopup();
   }
 }
 
+void VolumeInspector::DrawProgress() {
+  static constexpr std::array<const char*, static_cast<size_t>(Stage::kCount)> kLabels = {
+      "Reading volume...", "Building usage map...", "Building allocation map...",
+      "Checking blocks..."};
+  const int stage = std::clamp(stage_.load(), 0, static_cast<int>(Stage::kCount) - 1);
+  ImGui::ProgressBar(static_cast<float>(stage) / static_cast<float>(Stage::kCount),
+                     ImVec2(-1, 0), kLabels[static_cast<size_t>(stage)]);
+  if (ImGui::Button(ICON_FA_XMARK " Cancel")) Cancel();
+}
+
+void VolumeInspector::ReleaseTextures() {
+  for (auto& map : maps_) {
+    if (map.id != 0) glDeleteTextures(1, &map.id);
+    map = {};
+  }
+}
+
+void VolumeInspector::Upload(MapTexture& texture, const std::vector<uint8_t>& map,
+                             std::span<const ImVec4> palette) {
+  // Roughly square, so even millions of blocks stay within texture limits.
+  const auto n = map.size();
+  const double side = std::ceil(std::sqrt(static_cast<double>(n)) / 64.0) * 64.0;
+  texture.columns = std::max(64, static_cast<int>(side));
+  texture.rows = static_cast<int>((n + static_cast<size_t>(texture.columns) - 1) /
+                                  static_cast<size_t>(texture.columns));
+  std::array<ImU32, 256> lut;
+  for (size_t v = 0; v < lut.size(); ++v) {
+    lut[v] = ImGui::ColorConvertFloat4ToU32(v < palette.size() ? palette[v]
+                                                               : ImVec4(0.75f, 0.75f, 0.75f, 1.0f));
+  }
+  std::vector<ImU32> pixels(static_cast<size_t>(texture.columns) * static_cast<size_t>(texture.rows),
+                            0);
+  for (size_t i = 0; i < n; ++i) pixels[i] = lut[map[i]];
+
+  if (texture.id == 0) glGenTextures(1, &texture.id);
+  glBindTexture(GL_TEXTURE_2D, texture.id);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture.columns, texture.rows, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, pixels.data());
+  texture.dirty = false;
+}
+
+int VolumeInspector::DrawBlockMap(const char* id, MapTexture& texture,
+                                  const std::vector<uint8_t>& map,
+                                  std::span<const ImVec4> palette) {
+  if (texture.dirty) Upload(texture, map, palette);
+  if (texture.id == 0 || texture.columns == 0) return -1;
+
+  const float avail = ImGui::GetContentRegionAvail().x;
+  // Never less than a pixel per block: nearest sampling of a minified map
+  // would drop lone error or conflict blocks. Wider maps scroll instead.
+  auto cell_at = [&](float zoom) {
+    return std::max(avail / static_cast<float>(texture.columns) * zoom, 1.0f);
+  };
+  const float cell = cell_at(zoom_);
+  const ImVec2 size(cell * static_cast<float>(texture.columns),
+                    cell * static_cast<float>(texture.rows));
+  const float height = std::min(size.y, kMaxMapHeight) + ImGui::GetStyle().ScrollbarSize;
+  int hovered = -1;
+  if (ImGui::BeginChild(id, ImVec2(0, height), false,
+                        ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoScrollWithMouse)) {
+    ImGui::Image((void*)(intptr_t)texture.id, size);
+    if (ImGui::IsItemHovered()) {
+      ImGuiIO& io = ImGui::GetIO();
+      // Ctrl+wheel zooms around the pointer, the wheel alone scrolls and
+      // dragging with the right button pans.
+      if (io.KeyCtrl && io.MouseWheel != 0.0f) {
+        zoom_ = std::clamp(zoom_ * (io.MouseWheel > 0 ? 1.25f : 0.8f), 1.0f, kMaxZoom);
+        const ImVec2 local(io.MousePos.x - ImGui::GetItemRectMin().x,
+                           io.MousePos.y - ImGui::GetItemRectMin().y);
+        const float k = cell_at(zoom_) / cell;
+        ImGui::SetScrollX(ImGui::GetScrollX() + local.x * (k - 1.0f));
+        ImGui::SetScrollY(ImGui::GetScrollY() + local.y * (k - 1.0f));
+      } else if (io.MouseWheel != 0.0f) {
+        ImGui::SetScrollY(ImGui::GetScrollY() - io.MouseWheel * cell * 4.0f);
+      }
+      if (ImGui::IsMouseDragging(ImGuiMouseButton_Right)) {
+        ImGui::SetScrollX(ImGui::GetScrollX() - io.MouseDelta.x);
+        ImGui::SetScrollY(ImGui::GetScrollY() - io.MouseDelta.y);
+      }
+      const ImVec2 min = ImGui::GetItemRectMin();
+      const int col = static_cast<int>((io.MousePos.x - min.x) / cell);
+      const int row = static_cast<int>((io.MousePos.y - min.y) / cell);
+      const long long index = static_cast<long long>(row) * texture.columns + col;
+      if (col >= 0 && col < texture.columns && row >= 0 &&
+          index < static_cast<long long>(map.size())) {
+        hovered = static_cast<int>(index);
+        if (ImGui::IsMouseDown(ImGuiMouseButton_Left)) selected_block_ = hovered;
+      }
+    }
+  }
+  ImGui::EndChild();
+  return hovered;
+}
+
 void VolumeInspector::DrawInfo() {
-  auto traits = fs_->getTraits();
+  auto traits = current_->fs->getTraits();
   auto row = [](std::string_view key, auto&& value) {
     std::string val = std::format("{}", std::forward<decltype(value)>(value));
     ImGui::Text("%.*s%s", static_cast<int>(key.size()), key.data(), val.c_str());
   };
-  row("Name: ", info_.name);
-  row("Created: ", info_.creationDate);
-  row("Modified: ", info_.modificationDate);
+  row("Name: ", current_->info.name);
+  row("Created: ", current_->info.creationDate);
+  row("Modified: ", current_->info.modificationDate);
 
   ImGui::Text("Format: %s (%s)",
               vamiga::FSFormatEnum::_key(traits.dos),
               vamiga::isOFSVolumeType(traits.dos) ? "OFS" : "FFS");
   ImGui::SameLine();
-  ImGui::Text("Boot: %s", BootBlockName(fs_->bootBlockType()).data());
+  ImGui::Text("Boot: %s", BootBlockName(current_->fs->bootBlockType()).data());
   ImGui::Text("Blocks: %lld  Free: %lld  Used: %lld",
-              static_cast<long long>(info_.numBlocks),
-              static_cast<long long>(info_.freeBlocks),
-              static_cast<long long>(info_.usedBlocks));
+              static_cast<long long>(current_->info.numBlocks),
+              static_cast<long long>(current_->info.freeBlocks),
+              static_cast<long long>(current_->info.usedBlocks));
   ImGui::Text("Bytes: used %.2f KB / total %.2f KB",
-              info_.usedBytes / 1024.0, info_.numBlocks * traits.bsize / 1024.0);
+              current_->info.usedBytes / 1024.0, current_->info.numBlocks * traits.bsize / 1024.0);
 }
 
-void VolumeInspector::DrawUsage() {
-  if (usage_map_.empty()) return;
+void VolumeInspector::DrawFiles() {
+  if (!ImGui::CollapsingHeader("Files")) return;
+  if (!volume_) {
+    ImGui::TextDisabled("Root block not found.");
+    return;
+  }
+  ImGui::SetNextItemWidth(-150.0f);
+  ImGui::InputText("##ExtractDir", extract_dir_.data(), extract_dir_.size());
+  ImGui::SameLine();
+  ImGui::BeginDisabled(extracting_);
+  if (ImGui::Button(ICON_FA_FILE_EXPORT " Extract All")) {
+    StartExtraction({std::format("{}", current_->info.name), root_block_,
+                     AmigaVolume::Kind::kDirectory, 0});
+  }
+  ImGui::EndDisabled();
+  DrawExtraction();
+  if (ImGui::BeginChild("FileTree", ImVec2(0, 200), true)) DrawDirectory(root_block_);
+  ImGui::EndChild();
+}
 
-  ImGui::Text("Usage Map");
-  const float cell = 10.0f;
-  int cols = std::max(1, static_cast<int>(ImGui::GetContentRegionAvail().x / cell));
-  auto draw_list = ImGui::GetWindowDrawList();
-  ImVec2 start = ImGui::GetCursorScreenPos();
-
-  for (int i = 0; i < static_cast<int>(usage_map_.size()); ++i) {
-    int row = i / cols;
-    int col = i % cols;
-    ImVec2 p0 = ImVec2(start.x + col * cell, start.y + row * cell);
-    ImVec2 p1 = ImVec2(p0.x + cell - 1, p0.y + cell - 1);
-    auto type = static_cast<vamiga::FSBlockType>(usage_map_[static_cast<size_t>(i)]);
-    draw_list->AddRectFilled(p0, p1,
-                             ImGui::GetColorU32(EnumColor(type, kFsColors)));
-    if (ImGui::IsMouseHoveringRect(p0, p1) && ImGui::IsWindowHovered()) {
-      ImGui::SetTooltip("Block %d: %s", i, vamiga::FSBlockTypeEnum::_key(type));
-      if (ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
-        selected_block_ = i;
+void VolumeInspector::DrawDirectory(uint32_t block) {
+  auto it = dir_cache_.find(block);
+  if (it == dir_cache_.end()) {
+    std::vector<AmigaVolume::Entry> entries;
+    volume_->List(block, entries);
+    it = dir_cache_.emplace(block, std::move(entries)).first;
+  }
+  // Expanding a child inserts into the cache; references stay valid.
+  const auto& entries = it->second;
+  for (const auto& entry : entries) {
+    ImGui::PushID(static_cast<int>(entry.block));
+    const bool is_dir = entry.kind == AmigaVolume::Kind::kDirectory;
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_OpenOnArrow;
+    if (!is_dir) flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+    if (selected_block_ == static_cast<int>(entry.block)) flags |= ImGuiTreeNodeFlags_Selected;
+    const char* icon = is_dir ? ICON_FA_FOLDER
+                              : entry.kind == AmigaVolume::Kind::kLink ? ICON_FA_LINK : ICON_FA_FILE;
+    const bool open = ImGui::TreeNodeEx("##Node", flags, "%s %s", icon, entry.name.c_str());
+    // Selecting an entry shows its header block below.
+    if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) {
+      selected_block_ = static_cast<int>(entry.block);
+    }
+    if (entry.kind != AmigaVolume::Kind::kLink && ImGui::BeginPopupContextItem()) {
+      if (ImGui::MenuItem(ICON_FA_FILE_EXPORT " Extract", nullptr, false, !extracting_)) {
+        StartExtraction(entry);
       }
+      ImGui::EndPopup();
+    }
+    if (entry.kind == AmigaVolume::Kind::kFile) {
+      ImGui::SameLine();
+      ImGui::TextDisabled("%u bytes", entry.size);
     }
+    if (is_dir && open) {
+      DrawDirectory(entry.block);
+      ImGui::TreePop();
+    }
+    ImGui::PopID();
+  }
+}
+
+void VolumeInspector::StartExtraction(const AmigaVolume::Entry& entry) {
+  StopExtraction();
+  extract_progress_.bytes = 0;
+  extract_progress_.files = 0;
+  extract_progress_.cancel = false;
+  extract_error_.clear();
+  extract_start_ = std::chrono::steady_clock::now();
+  extracting_ = true;
+  extract_thread_ = std::thread(
+      [this, volume = volume_.get(), entry, target = std::filesystem::path(extract_dir_.data())] {
+        std::string error;
+        extract_ok_ = volume->Extract(entry, target, extract_progress_, error);
+        extract_error_ = std::move(error);
+        extract_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                         extract_start_).count();
+        extracting_ = false;
+      });
+}
+
+void VolumeInspector::StopExtraction() {
+  extract_progress_.cancel = true;
+  if (extract_thread_.joinable()) extract_thread_.join();
+}
+
+void VolumeInspector::DrawExtraction() {
+  if (!extract_thread_.joinable()) return;
+  const bool running = extracting_;
+  const double seconds =
+      running ? std::chrono::duration<double>(std::chrono::steady_clock::now() - extract_start_).count()
+              : extract_seconds_;
+  const double mb = static_cast<double>(extract_progress_.bytes) / (1024.0 * 1024.0);
+  ImGui::Text("%s %u files, %.2f MB (%.1f MB/s)",
+              running ? "Extracting" : extract_ok_ ? "Extracted" : "Stopped after",
+              extract_progress_.files.load(), mb, seconds > 0.0 ? mb / seconds : 0.0);
+  if (running) {
+    ImGui::SameLine();
+    if (ImGui::SmallButton(ICON_FA_XMARK " Cancel##Extract")) extract_progress_.cancel = true;
+  } else if (!extract_ok_) {
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(0.90f, 0.25f, 0.25f, 1.0f), "%s", extract_error_.c_str());
+  }
+}
+
+void VolumeInspector::DrawUsage() {
+  if (current_->usage_map.empty()) return;
+
+  ImGui::Text("Usage Map");
+  ImGui::SameLine();
+  ImGui::TextDisabled("(Ctrl+wheel zooms, right-drag pans; x%.1f)", zoom_);
+  const int hovered = DrawBlockMap("UsageMap", maps_[kUsageMap], current_->usage_map, kFsColors);
+  if (hovered >= 0) {
+    auto type = static_cast<vamiga::FSBlockType>(current_->usage_map[static_cast<size_t>(hovered)]);
+    ImGui::SetTooltip("Block %d: %s", hovered, vamiga::FSBlockTypeEnum::_key(type));
   }
-  int rows = (static_cast<int>(usage_map_.size()) + cols - 1) / cols;
-  ImGui::Dummy(ImVec2(0, rows * cell));
 
   constexpr std::array usage_order = {
       vamiga::FSBlockType::BOOT,     vamiga::FSBlockType::ROOT,
@@ -249,39 +559,20 @@ void VolumeInspector::DrawUsage() {
       vamiga::FSBlockType::EMPTY,    vamiga::FSBlockType::UNKNOWN};
   DrawLegend("UsageLegend", kFsColors, std::span<const vamiga::FSBlockType>(usage_order),
              [&](vamiga::FSBlockType t) {
-               return type_counts_[static_cast<size_t>(t)];
+               return current_->type_counts[static_cast<size_t>(t)];
              });
 }
 
 void VolumeInspector::DrawAllocation() {
-  if (alloc_map_.empty()) return;
+  if (current_->alloc_map.empty()) return;
 
   ImGui::Text("Allocation Map");
   ImGui::SameLine();
   if (ImGui::Button(ICON_FA_WRENCH " Rectify")) {
-    if (fs_) {
-      fs_->rectifyAllocationMap();
-      fs_->createAllocationMap(alloc_map_.data(),
-                               static_cast<vamiga::isize>(alloc_map_.size()));
-    }
+    rectify_requested_ = true;
   }
-
-  const float cell = 10.0f;
-  int cols = std::max(1, static_cast<int>(ImGui::GetContentRegionAvail().x / cell));
-  auto draw_list = ImGui::GetWindowDrawList();
-  ImVec2 start = ImGui::GetCursorScreenPos();
-
-  for (int i = 0; i < static_cast<int>(alloc_map_.size()); ++i) {
-    int row = i / cols;
-    int col = i % cols;
-    ImVec2 p0 = ImVec2(start.x + col * cell, start.y + row * cell);
-    ImVec2 p1 = ImVec2(p0.x + cell - 1, p0.y + cell - 1);
-    auto val = static_cast<AllocationState>(alloc_map_[static_cast<size_t>(i)]);
-    draw_list->AddRectFilled(p0, p1,
-                             ImGui::GetColorU32(EnumColor(val, kAllocColors)));
-  }
-  int rows = (static_cast<int>(alloc_map_.size()) + cols - 1) / cols;
-  ImGui::Dummy(ImVec2(0, rows * cell));
+  const int hovered = DrawBlockMap("AllocMap", maps_[kAllocMap], current_->alloc_map, kAllocColors);
+  if (hovered >= 0) ImGui::SetTooltip("Block %d", hovered);
 
   if (ImGui::BeginTable("AllocLegend", 2, ImGuiTableFlags_SizingFixedFit)) {
     ImGui::TableSetupColumn("Color", ImGuiTableColumnFlags_WidthFixed, 24.0f);
@@ -306,33 +597,15 @@ void VolumeInspector::DrawAllocation() {
 }
 
 void VolumeInspector::DrawHealth(vamiga::VAmiga& emu) {
-  if (health_map_.empty()) return;
+  if (current_->health_map.empty()) return;
 
   ImGui::Text("Health Map");
   ImGui::SameLine();
   if (ImGui::Button(ICON_FA_ROTATE " Re-run Check")) {
-    if (fs_) {
-      fs_->createHealthMap(health_map_.data(),
-                           static_cast<vamiga::isize>(health_map_.size()));
-    }
-  }
-
-  const float cell = 10.0f;
-  int cols = std::max(1, static_cast<int>(ImGui::GetContentRegionAvail().x / cell));
-  auto draw_list = ImGui::GetWindowDrawList();
-  ImVec2 start = ImGui::GetCursorScreenPos();
-
-  for (int i = 0; i < static_cast<int>(health_map_.size()); ++i) {
-    int row = i / cols;
-    int col = i % cols;
-    ImVec2 p0 = ImVec2(start.x + col * cell, start.y + row * cell);
-    ImVec2 p1 = ImVec2(p0.x + cell - 1, p0.y + cell - 1);
-    auto val = static_cast<HealthState>(health_map_[static_cast<size_t>(i)]);
-    draw_list->AddRectFilled(p0, p1,
-                             ImGui::GetColorU32(EnumColor(val, kHealthColors)));
+    recheck_requested_ = true;
   }
-  int rows = (static_cast<int>(health_map_.size()) + cols - 1) / cols;
-  ImGui::Dummy(ImVec2(0, rows * cell));
+  const int hovered = DrawBlockMap("HealthMap", maps_[kHealthMap], current_->health_map, kHealthColors);
+  if (hovered >= 0) ImGui::SetTooltip("Block %d", hovered);
 
   if (ImGui::BeginTable("HealthLegend", 2, ImGuiTableFlags_SizingFixedFit)) {
     ImGui::TableSetupColumn("Color", ImGuiTableColumnFlags_WidthFixed, 24.0f);
@@ -356,17 +629,17 @@ void VolumeInspector::DrawHealth(vamiga::VAmiga& emu) {
 }
 
 void VolumeInspector::DrawBlockView() {
-  auto traits = fs_->getTraits();
+  auto traits = current_->fs->getTraits();
   selected_block_ = std::clamp(selected_block_, 0,
-                               static_cast<int>(info_.numBlocks > 0 ? info_.numBlocks - 1 : 0));
+                               static_cast<int>(current_->info.numBlocks > 0 ? current_->info.numBlocks - 1 : 0));
   ImGui::Text("Block %d", selected_block_);
   ImGui::SameLine();
   ImGui::SetNextItemWidth(180.0f);
   if (ImGui::SliderInt("##blk", &selected_block_, 0,
-                       static_cast<int>(std::max<vamiga::isize>(info_.numBlocks - 1, 0)))) {
+                       static_cast<int>(std::max<vamiga::isize>(current_->info.numBlocks - 1, 0)))) {
   }
 
-  auto* blk = fs_->read(static_cast<vamiga::Block>(selected_block_));
+  auto* blk = current_->fs->read(static_cast<vamiga::Block>(selected_block_));
   if (!blk) {
     ImGui::TextDisabled("Unable to read block.");
     return;
@@ -1,28 +1,104 @@
 #ifndef LINUXGUI_COMPONENTS_VOLUME_INSPECTOR_H_
 #define LINUXGUI_COMPONENTS_VOLUME_INSPECTOR_H_
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
 #include <utility>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "VAmiga.h"
 #include "FileSystems/MutableFileSystem.h"
 #include "imgui.h"
+#include "services/amiga_volume.h"
 
 namespace gui {
 
+// Shows the layout and health of a floppy or hard disk volume. Building
+// the file system and its block maps takes seconds on a large partition,
+// so it runs on a worker thread. Every request gets a new generation;
+// the worker gives up on a request as soon as a newer one arrives, and
+// only the result of the latest request is ever shown.
+//
+// The file tree lists a directory the first time it is expanded. Files
+// and whole trees are extracted on a second thread that streams them
+// block by block; any new analysis request cancels a running extraction.
 class VolumeInspector {
  public:
   static VolumeInspector& Instance();
+  ~VolumeInspector();
 
   void Open(int drive_nr, bool is_hd, vamiga::VAmiga& emu, int partition = 0);
   void Draw(vamiga::VAmiga& emu);
+  // Waits for the worker; call before the emulator goes away.
+  void Stop();
 
  private:
+  enum class Stage : int { kMount, kUsage, kAllocation, kHealth, kCount };
+
+  struct Analysis {
+    std::unique_ptr<vamiga::MutableFileSystem> fs;
+    vamiga::FSInfo info{};
+    std::vector<uint8_t> usage_map;
+    std::vector<uint8_t> alloc_map;
+    std::vector<uint8_t> health_map;
+    std::array<int, static_cast<size_t>(vamiga::FSBlockType::DATA_FFS) + 1> type_counts{};
+  };
+
+  struct Job {
+    uint64_t generation = 0;
+    vamiga::VAmiga* emu = nullptr;
+    int drive_nr = 0;
+    bool is_hd = false;
+    int part = 0;
+    // Set to re-analyse an already mounted volume, e.g. after rectifying.
+    std::unique_ptr<Analysis> reuse;
+    bool rectify = false;
+  };
+
+  // A block map as a texture with one texel per block, laid out row by
+  // row. It is rebuilt only when the analysis it shows changes.
+  struct MapTexture {
+    unsigned int id = 0;
+    int columns = 0;
+    int rows = 0;
+    bool dirty = true;
+  };
+  enum MapKind { kUsageMap, kAllocMap, kHealthMap, kMapCount };
+
+  static constexpr float kMaxMapHeight = 220.0f;
+  static constexpr float kMaxZoom = 32.0f;
+
   VolumeInspector() = default;
 
   void Refresh(vamiga::VAmiga& emu);
+  void Submit(vamiga::VAmiga& emu, std::unique_ptr<Analysis> reuse, bool rectify);
+  void Cancel();
+  void Poll();
+  void Run();
+  std::unique_ptr<Analysis> Analyze(Job& job);
+  bool Superseded(const Job& job) const { return generation_ != job.generation; }
+
+  // Draws a map with a single image and returns the hovered block or -1.
+  int DrawBlockMap(const char* id, MapTexture& texture, const std::vector<uint8_t>& map,
+                   std::span<const ImVec4> palette);
+  static void Upload(MapTexture& texture, const std::vector<uint8_t>& map,
+                     std::span<const ImVec4> palette);
+  void ReleaseTextures();
+  void DrawProgress();
   void DrawInfo();
+  void DrawFiles();
+  void DrawDirectory(uint32_t block);
+  void DrawExtraction();
+  void StartExtraction(const AmigaVolume::Entry& entry);
+  void StopExtraction();
   void DrawUsage();
   void DrawAllocation();
   void DrawHealth(vamiga::VAmiga& emu);
@@ -33,14 +109,41 @@ class VolumeInspector {
   bool is_hd_ = false;
   int part_ = 0;
 
-  std::unique_ptr<vamiga::MutableFileSystem> fs_;
-  vamiga::FSInfo info_{};
-  std::vector<uint8_t> usage_map_;
-  std::vector<uint8_t> alloc_map_;
-  std::vector<uint8_t> health_map_;
-  std::array<int, static_cast<size_t>(vamiga::FSBlockType::DATA_FFS) + 1> type_counts_{};
-
+  // GUI thread only.
+  std::unique_ptr<Analysis> current_;
+  bool analyzing_ = false;
+  bool cancelled_ = false;
+  bool rectify_requested_ = false;
+  bool recheck_requested_ = false;
   int selected_block_ = 0;
+  std::array<MapTexture, kMapCount> maps_{};
+  float zoom_ = 1.0f;
+  // Reads blocks of current_->fs; null when no root block was found.
+  std::unique_ptr<AmigaVolume> volume_;
+  uint32_t root_block_ = 0;
+  std::unordered_map<uint32_t, std::vector<AmigaVolume::Entry>> dir_cache_;
+  std::array<char, 512> extract_dir_{};
+
+  // Shared with the extraction thread. The result fields are written
+  // before extracting_ drops and read only once it has.
+  AmigaVolume::Progress extract_progress_;
+  std::atomic<bool> extracting_ = false;
+  bool extract_ok_ = false;
+  std::string extract_error_;
+  double extract_seconds_ = 0.0;
+  std::chrono::steady_clock::time_point extract_start_;
+  std::thread extract_thread_;
+
+  // Shared with the worker.
+  std::atomic<uint64_t> generation_ = 0;
+  std::atomic<int> stage_ = 0;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::optional<Job> job_;
+  std::unique_ptr<Analysis> ready_;
+  uint64_t ready_generation_ = 0;
+  bool stop_ = false;
+  std::thread worker_;
 };
 
 }  // namespace gui
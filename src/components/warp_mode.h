@@ -0,0 +1,21 @@
+#ifndef LINUXGUI_COMPONENTS_WARP_MODE_H_
+#define LINUXGUI_COMPONENTS_WARP_MODE_H_
+
+#include "VAmiga.h"
+#undef unreachable
+#define unreachable std::unreachable()
+#include "Infrastructure/Option.h"
+
+namespace gui {
+
+// The AMIGA_WARP_MODE value that keeps warp on for unattended runs.
+inline vamiga::i64 WarpAlways() {
+  for (const auto& [name, value] : vamiga::OptionParser::pairs(vamiga::Opt::AMIGA_WARP_MODE)) {
+    if (name == "ALWAYS") return value;
+  }
+  return 0;
+}
+
+}
+
+#endif
@@ -28,11 +28,16 @@ namespace Defaults {
     static constexpr std::string_view kConfigFileName = "vamiga.config";
     static constexpr std::string_view kScreenshotsDir = "screenshots";
     static constexpr std::string_view kSnapshotsDir = "snapshots";
+    static constexpr std::string_view kSlotsDir = "slots";
+    static constexpr std::string_view kLogsDir = "logs";
+    static constexpr std::string_view kLogFileName = "console.log";
     
     static constexpr bool kPauseInBackground = true;
     static constexpr bool kRetainMouseClick = true;
     static constexpr bool kRetainMouseEnter = false;
     static constexpr bool kReleaseMouseShake = true;
+    static constexpr bool kGamepadPolling = true;
+    static constexpr int kMouseDeliveries = 1;
     
     static constexpr int kAudioVolume = 100;
     static constexpr int kAudioSeparation = 100;
@@ -48,8 +53,21 @@ namespace Defaults {
 
     static constexpr bool kSnapshotAutoDelete = true;
     static constexpr int kSnapshotLimit = 100;
+    static constexpr bool kSnapshotCompress = false;
+    static constexpr bool kSnapshotDedup = false;
+    static constexpr std::string_view kChunksDir = "chunks";
+    static constexpr bool kSlotsPersist = false;
     static constexpr int kScreenshotFormat = 0;
     static constexpr int kScreenshotSource = 0;
+
+    static constexpr bool kLogEnabled = false;
+    static constexpr int kLogMaxKb = 4096;
+    static constexpr int kLogMaxFiles = 5;
+    static constexpr bool kLogCompress = true;
+
+    static constexpr bool kRewindEnabled = true;
+    static constexpr int kRewindInterval = 10;
+    static constexpr int kRewindBudgetMb = 64;
 }
 
 }
@@ -1,6 +1,20 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 #include "application.h"
+#include "components/movie_player.h"
+#include "services/disk_verifier.h"
 
 int main(int argc, char** argv) {
+  // Batch verification runs without a window: --verify <dir> [threads]
+  if (argc >= 3 && std::strcmp(argv[1], "--verify") == 0) {
+    const int threads = argc >= 4 ? std::atoi(argv[3]) : 0;
+    return gui::DiskVerifier::VerifyDirectory(argv[2], std::cout, threads) == 0 ? 0 : 1;
+  }
+  // Headless movie replay: --replay <movie.vmv>
+  if (argc >= 3 && std::strcmp(argv[1], "--replay") == 0) {
+    return gui::MoviePlayer::ReplayHeadless(argv[2], std::cout);
+  }
   Application app(argc, argv);
   app.Run();
   return 0;
@@ -0,0 +1,176 @@
+#include "amiga_volume.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+namespace gui {
+
+namespace {
+constexpr uint32_t kTypeHeader = 2;
+constexpr uint32_t kTypeList = 16;
+constexpr int32_t kSecRoot = 1;
+constexpr int32_t kSecUserDir = 2;
+constexpr int32_t kSecFile = -3;
+constexpr std::size_t kOfsDataOffset = 24;
+constexpr std::size_t kMaxNameLength = 30;
+
+std::string HostName(const std::string& name) {
+  std::string out = name;
+  std::ranges::replace(out, '/', '_');
+  if (out.empty() || out == "." || out == "..") out = "_" + out;
+  return out;
+}
+}  // namespace
+
+AmigaVolume::AmigaVolume(BlockReader reader, uint32_t num_blocks, uint32_t block_size, bool ofs)
+    : reader_(std::move(reader)),
+      num_blocks_(num_blocks),
+      block_size_(block_size),
+      longs_(block_size / 4),
+      ofs_(ofs) {}
+
+bool AmigaVolume::Read(uint32_t nr, std::vector<uint8_t>& block) const {
+  if (nr == 0 || nr >= num_blocks_ || longs_ < 128) return false;
+  block.resize(block_size_);
+  return reader_(nr, block);
+}
+
+uint32_t AmigaVolume::Long(const std::vector<uint8_t>& block, std::size_t index) const {
+  const uint8_t* p = block.data() + index * 4;
+  return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+}
+
+int32_t AmigaVolume::SecondaryType(const std::vector<uint8_t>& block) const {
+  return static_cast<int32_t>(Long(block, longs_ - 1));
+}
+
+std::string AmigaVolume::Name(const std::vector<uint8_t>& block) const {
+  const std::size_t offset = block_size_ - 80;
+  const std::size_t length = std::min<std::size_t>(block[offset], kMaxNameLength);
+  return {reinterpret_cast<const char*>(block.data()) + offset + 1, length};
+}
+
+bool AmigaVolume::IsDirectory(uint32_t nr) const {
+  std::vector<uint8_t> block;
+  if (!Read(nr, block) || Long(block, 0) != kTypeHeader) return false;
+  const int32_t sec = SecondaryType(block);
+  return sec == kSecRoot || sec == kSecUserDir;
+}
+
+bool AmigaVolume::List(uint32_t dir_block, std::vector<Entry>& entries) const {
+  entries.clear();
+  std::vector<uint8_t> dir, header;
+  if (!Read(dir_block, dir) || Long(dir, 0) != kTypeHeader) return false;
+  const std::size_t table_size = longs_ - 56;
+  // Guards against hash chains that loop.
+  std::size_t budget = num_blocks_;
+  for (std::size_t slot = 0; slot < table_size; ++slot) {
+    for (uint32_t nr = Long(dir, 6 + slot); nr != 0 && budget > 0; --budget) {
+      if (!Read(nr, header) || Long(header, 0) != kTypeHeader) break;
+      Entry e;
+      e.name = Name(header);
+      e.block = nr;
+      const int32_t sec = SecondaryType(header);
+      if (sec == kSecFile) {
+        e.size = Long(header, longs_ - 47);
+      } else {
+        e.kind = sec == kSecUserDir ? Kind::kDirectory : Kind::kLink;
+      }
+      entries.push_back(std::move(e));
+      nr = Long(header, longs_ - 4);
+    }
+  }
+  std::ranges::sort(entries, [](const Entry& a, const Entry& b) {
+    if ((a.kind == Kind::kDirectory) != (b.kind == Kind::kDirectory)) {
+      return a.kind == Kind::kDirectory;
+    }
+    return std::ranges::lexicographical_compare(a.name, b.name, [](char x, char y) {
+      return std::tolower(static_cast<unsigned char>(x)) < std::tolower(static_cast<unsigned char>(y));
+    });
+  });
+  return true;
+}
+
+bool AmigaVolume::Stream(uint32_t file_block, const Sink& sink) const {
+  std::vector<uint8_t> table, data;
+  if (!Read(file_block, table) || SecondaryType(table) != kSecFile) return false;
+  uint64_t remaining = Long(table, longs_ - 47);
+  const std::size_t table_size = longs_ - 56;
+  std::size_t budget = num_blocks_;
+  // The header and its extension (list) blocks each hold a table of data
+  // block pointers, stored back to front.
+  while (remaining > 0 && budget-- > 0) {
+    const std::size_t used = std::min<std::size_t>(Long(table, 2), table_size);
+    for (std::size_t i = 0; i < used && remaining > 0; ++i) {
+      if (!Read(Long(table, 6 + table_size - 1 - i), data)) return false;
+      std::span<const uint8_t> payload(data);
+      if (ofs_) {
+        payload = payload.subspan(kOfsDataOffset,
+                                  std::min<std::size_t>(Long(data, 3), block_size_ - kOfsDataOffset));
+      }
+      payload = payload.first(std::min<uint64_t>(payload.size(), remaining));
+      if (!sink(payload)) return false;
+      remaining -= payload.size();
+    }
+    if (remaining == 0) break;
+    const uint32_t next = Long(table, longs_ - 2);
+    if (!Read(next, table) || Long(table, 0) != kTypeList) return false;
+  }
+  return remaining == 0;
+}
+
+bool AmigaVolume::Extract(const Entry& entry, const std::filesystem::path& target_dir,
+                          Progress& progress, std::string& error) const {
+  std::unordered_set<uint32_t> visited;
+  return Extract(entry, target_dir, progress, error, visited);
+}
+
+bool AmigaVolume::Extract(const Entry& entry, const std::filesystem::path& target_dir,
+                          Progress& progress, std::string& error,
+                          std::unordered_set<uint32_t>& visited) const {
+  if (progress.cancel) return false;
+  const auto target = target_dir / HostName(entry.name);
+  std::error_code ec;
+  if (entry.kind == Kind::kDirectory) {
+    // A damaged volume can link a directory back to one of its ancestors.
+    if (!visited.insert(entry.block).second) {
+      error = "directory loop at " + entry.name;
+      return false;
+    }
+    std::filesystem::create_directories(target, ec);
+    if (ec) {
+      error = ec.message();
+      return false;
+    }
+    std::vector<Entry> children;
+    if (!List(entry.block, children)) {
+      error = "unreadable directory " + entry.name;
+      return false;
+    }
+    for (const auto& child : children) {
+      if (!Extract(child, target, progress, error, visited)) return false;
+    }
+    return true;
+  }
+  if (entry.kind != Kind::kFile) return true;
+
+  std::ofstream file(target, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    error = "cannot create " + target.string();
+    return false;
+  }
+  const bool ok = Stream(entry.block, [&](std::span<const uint8_t> data) {
+    if (progress.cancel) return false;
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    progress.bytes += data.size();
+    return static_cast<bool>(file);
+  });
+  if (!ok) {
+    if (error.empty()) error = progress.cancel ? "cancelled" : "damaged file " + entry.name;
+    return false;
+  }
+  ++progress.files;
+  return true;
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef LINUXGUI_SERVICES_AMIGA_VOLUME_H_
+#define LINUXGUI_SERVICES_AMIGA_VOLUME_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <vector>
+namespace gui {
+// Read-only walker for OFS/FFS volumes that works on raw blocks. Blocks
+// are fetched one at a time through a caller-supplied reader, so listing
+// a directory touches only its header blocks and extracting a file only
+// ever holds a single block in memory.
+class AmigaVolume {
+ public:
+  // Copies block `nr` into `out` (block_size bytes).
+  using BlockReader = std::function<bool(uint32_t nr, std::span<uint8_t> out)>;
+  // Receives file data in order; returning false aborts the transfer.
+  using Sink = std::function<bool(std::span<const uint8_t> data)>;
+  enum class Kind : uint8_t { kFile, kDirectory, kLink };
+  struct Entry {
+    std::string name;
+    uint32_t block = 0;  // header block
+    Kind kind = Kind::kFile;
+    uint32_t size = 0;   // files only
+  };
+  struct Progress {
+    std::atomic<uint64_t> bytes = 0;
+    std::atomic<uint32_t> files = 0;
+    std::atomic<bool> cancel = false;
+  };
+  AmigaVolume(BlockReader reader, uint32_t num_blocks, uint32_t block_size, bool ofs);
+  // Root block of a volume with the usual two reserved boot blocks.
+  static uint32_t RootBlock(uint32_t num_blocks) { return (num_blocks + 1) / 2; }
+  bool IsDirectory(uint32_t block) const;
+  // Directories first, then files, each sorted by name.
+  bool List(uint32_t dir_block, std::vector<Entry>& entries) const;
+  bool Stream(uint32_t file_block, const Sink& sink) const;
+  // Copies a file, or a directory recursively, into `target_dir`. Fails on
+  // a directory that contains itself.
+  bool Extract(const Entry& entry, const std::filesystem::path& target_dir, Progress& progress,
+               std::string& error) const;
+ private:
+  bool Extract(const Entry& entry, const std::filesystem::path& target_dir, Progress& progress,
+               std::string& error, std::unordered_set<uint32_t>& visited) const;
+  bool Read(uint32_t nr, std::vector<uint8_t>& block) const;
+  uint32_t Long(const std::vector<uint8_t>& block, std::size_t index) const;
+  std::string Name(const std::vector<uint8_t>& block) const;
+  int32_t SecondaryType(const std::vector<uint8_t>& block) const;
+  BlockReader reader_;
+  uint32_t num_blocks_ = 0;
+  uint32_t block_size_ = 512;
+  uint32_t longs_ = 128;
+  bool ofs_ = false;
+};
+}
+#endif
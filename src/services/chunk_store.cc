@@ -0,0 +1,338 @@
+#include "chunk_store.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include "services/lz_codec.h"
+#include "services/snapshot_writer.h"
+
+namespace gui {
+
+namespace {
+constexpr uint32_t kManifestVersion = 1;
+constexpr std::size_t kManifestHeader = 20;  // magic, version, size, count
+constexpr std::size_t kManifestEntry = 12;
+constexpr std::size_t kChunksPerReader = 64;
+constexpr uint8_t kStoredRaw = 0;
+constexpr uint8_t kStoredLz = 1;
+
+// Normalised chunking: boundaries are harder to hit before the average
+// size and easier after it, which narrows the size distribution.
+constexpr int kBitsSmall = std::countr_zero(ChunkStore::kAvgChunk) + 2;
+constexpr int kBitsLarge = std::countr_zero(ChunkStore::kAvgChunk) - 2;
+// A gear hash shifts left once per byte, so its high bits depend on the
+// most bytes; the masks test those.
+constexpr uint64_t TopBits(int n) { return ~uint64_t{0} << (64 - n); }
+
+constexpr std::array<uint64_t, 256> MakeGear() {
+  std::array<uint64_t, 256> table{};
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  for (auto& entry : table) {
+    // splitmix64
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    entry = z ^ (z >> 31);
+  }
+  return table;
+}
+constexpr auto kGear = MakeGear();
+
+std::size_t CutPoint(std::span<const uint8_t> data) {
+  const std::size_t n = data.size();
+  if (n <= ChunkStore::kMinChunk) return n;
+  const std::size_t end = std::min(n, ChunkStore::kMaxChunk);
+  const std::size_t normal = std::min(end, ChunkStore::kAvgChunk);
+  uint64_t h = 0;
+  std::size_t i = ChunkStore::kMinChunk;
+  for (; i < normal; ++i) {
+    h = (h << 1) + kGear[data[i]];
+    if ((h & TopBits(kBitsSmall)) == 0) return i + 1;
+  }
+  for (; i < end; ++i) {
+    h = (h << 1) + kGear[data[i]];
+    if ((h & TopBits(kBitsLarge)) == 0) return i + 1;
+  }
+  return end;
+}
+
+uint64_t Load64(const uint8_t* p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+  return v;
+}
+uint32_t Load32(const uint8_t* p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+  return v;
+}
+void Store(std::vector<uint8_t>& out, uint64_t value, int size) {
+  for (int i = 0; i < size; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+bool ParseManifest(std::span<const uint8_t> data, uint64_t& size,
+                   std::vector<ChunkStore::Chunk>& chunks) {
+  if (!ChunkStore::IsManifest(data) || Load32(data.data() + 4) != kManifestVersion) return false;
+  size = Load64(data.data() + 8);
+  const uint32_t count = Load32(data.data() + 16);
+  if (data.size() != kManifestHeader + count * kManifestEntry) return false;
+  chunks.resize(count);
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint8_t* p = data.data() + kManifestHeader + i * kManifestEntry;
+    chunks[i] = {Load64(p), Load32(p + 8)};
+    total += chunks[i].size;
+  }
+  return total == size;
+}
+
+std::vector<uint8_t> ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+}  // namespace
+
+ChunkStore::~ChunkStore() {
+  if (collector_.joinable()) collector_.join();
+}
+
+bool ChunkStore::Open(const std::filesystem::path& dir, const std::filesystem::path& manifest_dir) {
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (!std::filesystem::is_directory(dir, ec)) return false;
+  std::unique_lock lock(mutex_);
+  dir_ = dir;
+  manifest_dir_ = manifest_dir;
+  known_.clear();
+  return true;
+}
+
+uint64_t ChunkStore::Hash(std::span<const uint8_t> data, uint64_t seed) {
+  // XXH64.
+  constexpr uint64_t kP1 = 11400714785074694791ULL;
+  constexpr uint64_t kP2 = 14029467366897019727ULL;
+  constexpr uint64_t kP3 = 1609587929392839161ULL;
+  constexpr uint64_t kP4 = 9650029242287828579ULL;
+  constexpr uint64_t kP5 = 2870177450012600261ULL;
+  auto round = [](uint64_t acc, uint64_t input) {
+    return std::rotl(acc + input * kP2, 31) * kP1;
+  };
+  auto merge = [&](uint64_t acc, uint64_t v) { return (acc ^ round(0, v)) * kP1 + kP4; };
+
+  const uint8_t* p = data.data();
+  const uint8_t* const end = p + data.size();
+  uint64_t h;
+  if (data.size() >= 32) {
+    uint64_t v1 = seed + kP1 + kP2, v2 = seed + kP2, v3 = seed, v4 = seed - kP1;
+    for (; end - p >= 32; p += 32) {
+      v1 = round(v1, Load64(p));
+      v2 = round(v2, Load64(p + 8));
+      v3 = round(v3, Load64(p + 16));
+      v4 = round(v4, Load64(p + 24));
+    }
+    h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+    h = merge(merge(merge(merge(h, v1), v2), v3), v4);
+  } else {
+    h = seed + kP5;
+  }
+  h += data.size();
+  for (; end - p >= 8; p += 8) h = std::rotl(h ^ round(0, Load64(p)), 27) * kP1 + kP4;
+  if (end - p >= 4) {
+    h = std::rotl(h ^ (Load32(p) * kP1), 23) * kP2 + kP3;
+    p += 4;
+  }
+  for (; p < end; ++p) h = std::rotl(h ^ (*p * kP5), 11) * kP1;
+  h ^= h >> 33;
+  h *= kP2;
+  h ^= h >> 29;
+  h *= kP3;
+  h ^= h >> 32;
+  return h;
+}
+
+std::vector<ChunkStore::Chunk> ChunkStore::Split(std::span<const uint8_t> data) {
+  std::vector<Chunk> chunks;
+  chunks.reserve(data.size() / kAvgChunk + 1);
+  while (!data.empty()) {
+    const std::size_t len = CutPoint(data);
+    chunks.push_back({Hash(data.first(len)), static_cast<uint32_t>(len)});
+    data = data.subspan(len);
+  }
+  return chunks;
+}
+
+bool ChunkStore::IsManifest(std::span<const uint8_t> data) {
+  return data.size() >= kManifestHeader && Load32(data.data()) == kManifestMagic;
+}
+
+std::filesystem::path ChunkStore::ChunkPath(uint64_t hash) const {
+  char name[17];
+  std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+  return dir_ / std::string_view(name, 2) / name;
+}
+
+bool ChunkStore::StoreChunk(uint64_t hash, std::span<const uint8_t> data, std::size_t& written,
+                            std::string& error) {
+  written = 0;
+  if (known_.contains(hash)) return true;
+  const auto path = ChunkPath(hash);
+  std::error_code ec;
+  if (std::filesystem::exists(path, ec)) {
+    known_.insert(hash);
+    return true;
+  }
+  std::filesystem::create_directories(path.parent_path(), ec);
+  auto packed = LzCompress(data);
+  std::vector<uint8_t> file;
+  file.reserve(1 + std::min(packed.size(), data.size()));
+  if (packed.size() < data.size()) {
+    file.push_back(kStoredLz);
+    file.insert(file.end(), packed.begin(), packed.end());
+  } else {
+    file.push_back(kStoredRaw);
+    file.insert(file.end(), data.begin(), data.end());
+  }
+  if (!SnapshotWriter::WriteAtomically(path, file, error)) return false;
+  known_.insert(hash);
+  written = file.size();
+  return true;
+}
+
+bool ChunkStore::Write(std::span<const uint8_t> snapshot, const std::filesystem::path& manifest,
+                       std::string& error, WriteStats* stats) {
+  std::shared_lock lock(mutex_);
+  if (!IsOpen()) {
+    error = "chunk store is not open";
+    return false;
+  }
+  WriteStats local;
+  const auto chunks = Split(snapshot);
+  std::vector<uint8_t> out;
+  out.reserve(kManifestHeader + chunks.size() * kManifestEntry);
+  Store(out, kManifestMagic, 4);
+  Store(out, kManifestVersion, 4);
+  Store(out, snapshot.size(), 8);
+  Store(out, chunks.size(), 4);
+  std::size_t offset = 0;
+  for (const auto& chunk : chunks) {
+    std::size_t written = 0;
+    if (!StoreChunk(chunk.hash, snapshot.subspan(offset, chunk.size), written, error)) {
+      return false;
+    }
+    if (written > 0) {
+      ++local.new_chunks;
+      local.new_bytes += written;
+    }
+    offset += chunk.size;
+    Store(out, chunk.hash, 8);
+    Store(out, chunk.size, 4);
+  }
+  if (!SnapshotWriter::WriteAtomically(manifest, out, error)) return false;
+  local.manifest_bytes = out.size();
+  if (stats) *stats = local;
+  return true;
+}
+
+bool ChunkStore::LoadChunk(const Chunk& chunk, std::span<uint8_t> out) const {
+  const int fd = ::open(ChunkPath(chunk.hash).c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  std::vector<uint8_t> file(1 + kMaxChunk + kMaxChunk / 128 + 64);
+  std::size_t size = 0;
+  for (;;) {
+    if (size == file.size()) file.resize(file.size() * 2);
+    const ssize_t n = ::read(fd, file.data() + size, file.size() - size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    size += static_cast<std::size_t>(n);
+  }
+  ::close(fd);
+  if (size == 0) return false;
+  const std::span<const uint8_t> payload(file.data() + 1, size - 1);
+  if (file[0] == kStoredRaw) {
+    if (payload.size() != out.size()) return false;
+    std::memcpy(out.data(), payload.data(), out.size());
+  } else if (file[0] != kStoredLz || !LzDecompress(payload, out)) {
+    return false;
+  }
+  return Hash(out) == chunk.hash;
+}
+
+bool ChunkStore::Read(std::span<const uint8_t> manifest, std::vector<uint8_t>& snapshot) {
+  uint64_t size = 0;
+  std::vector<Chunk> chunks;
+  if (!ParseManifest(manifest, size, chunks)) return false;
+  std::shared_lock lock(mutex_);
+  if (!IsOpen()) return false;
+  snapshot.resize(size);
+  std::vector<std::size_t> offsets(chunks.size());
+  for (std::size_t i = 1; i < chunks.size(); ++i) offsets[i] = offsets[i - 1] + chunks[i - 1].size;
+
+  std::atomic<bool> ok = true;
+  auto load_range = [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last && ok; ++i) {
+      if (!LoadChunk(chunks[i], {snapshot.data() + offsets[i], chunks[i].size})) ok = false;
+    }
+  };
+  const std::size_t readers = std::clamp<std::size_t>(
+      chunks.size() / kChunksPerReader, 1, std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  const std::size_t per = (chunks.size() + readers - 1) / readers;
+  for (std::size_t r = 1; r < readers; ++r) {
+    threads.emplace_back(load_range, r * per, std::min(chunks.size(), (r + 1) * per));
+  }
+  load_range(0, std::min(chunks.size(), per));
+  for (auto& t : threads) t.join();
+  return ok;
+}
+
+std::size_t ChunkStore::Collect() {
+  std::unique_lock lock(mutex_);
+  if (!IsOpen()) return 0;
+  std::unordered_set<uint64_t> live;
+  std::error_code ec;
+  for (const auto& item : std::filesystem::directory_iterator(manifest_dir_, ec)) {
+    if (!item.is_regular_file(ec)) continue;
+    uint8_t head[4];
+    {
+      std::ifstream probe(item.path(), std::ios::binary);
+      if (!probe.read(reinterpret_cast<char*>(head), sizeof(head))) continue;
+    }
+    if (Load32(head) != kManifestMagic) continue;
+    uint64_t size = 0;
+    std::vector<Chunk> chunks;
+    if (!ParseManifest(ReadFile(item.path()), size, chunks)) continue;
+    for (const auto& chunk : chunks) live.insert(chunk.hash);
+  }
+
+  std::size_t removed = 0;
+  for (const auto& item : std::filesystem::recursive_directory_iterator(dir_, ec)) {
+    if (!item.is_regular_file(ec)) continue;
+    const auto name = item.path().filename().string();
+    uint64_t hash = 0;
+    const auto [end, err] = std::from_chars(name.data(), name.data() + name.size(), hash, 16);
+    const bool is_chunk = err == std::errc() && end == name.data() + name.size() && name.size() == 16;
+    // Leftover .part files are from writes that never completed.
+    if (is_chunk && live.contains(hash)) continue;
+    if (std::filesystem::remove(item.path(), ec)) ++removed;
+    if (is_chunk) known_.erase(hash);
+  }
+  return removed;
+}
+
+void ChunkStore::CollectAsync() {
+  if (collecting_.exchange(true)) return;
+  if (collector_.joinable()) collector_.join();
+  collector_ = std::thread([this] {
+    Collect();
+    collecting_ = false;
+  });
+}
+
+}
@@ -0,0 +1,80 @@
+#ifndef LINUXGUI_SERVICES_CHUNK_STORE_H_
+#define LINUXGUI_SERVICES_CHUNK_STORE_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+namespace gui {
+// Content-addressed storage for snapshots. A snapshot is cut into chunks at
+// content-defined boundaries (a gear rolling hash, as in FastCDC), so an
+// edit only changes the chunks around it. Each chunk is stored once, under
+// its 64-bit XXH64 hash, and the snapshot file itself becomes a manifest
+// that lists its chunks.
+//
+// Write() may run on one thread at a time. Read() may run concurrently
+// with it; Collect() excludes both.
+class ChunkStore {
+ public:
+  struct Chunk {
+    uint64_t hash = 0;
+    uint32_t size = 0;
+  };
+  struct WriteStats {
+    std::size_t manifest_bytes = 0;
+    std::size_t new_chunks = 0;
+    std::size_t new_bytes = 0;  // chunk data actually written
+  };
+
+  static constexpr uint32_t kManifestMagic = 0x4D534356;  // "VCSM"
+  static constexpr std::size_t kMinChunk = 2 * 1024;
+  static constexpr std::size_t kAvgChunk = 8 * 1024;
+  static constexpr std::size_t kMaxChunk = 64 * 1024;
+
+  ChunkStore() = default;
+  ~ChunkStore();
+  ChunkStore(const ChunkStore&) = delete;
+  ChunkStore& operator=(const ChunkStore&) = delete;
+
+  // `dir` holds the chunks, `manifest_dir` the snapshots referring to them.
+  bool Open(const std::filesystem::path& dir, const std::filesystem::path& manifest_dir);
+  bool IsOpen() const { return !dir_.empty(); }
+
+  // Stores the chunks that are not known yet, then writes the manifest
+  // atomically. New chunks are synced before the manifest is renamed into
+  // place.
+  bool Write(std::span<const uint8_t> snapshot, const std::filesystem::path& manifest,
+             std::string& error, WriteStats* stats = nullptr);
+  // Reassembles a snapshot, reading its chunks on several threads.
+  bool Read(std::span<const uint8_t> manifest, std::vector<uint8_t>& snapshot);
+
+  // Deletes chunks that no manifest in the manifest directory refers to.
+  // Returns the number of chunks deleted.
+  std::size_t Collect();
+  // Runs Collect() on a background thread unless one is already running.
+  void CollectAsync();
+
+  static std::vector<Chunk> Split(std::span<const uint8_t> data);
+  static uint64_t Hash(std::span<const uint8_t> data, uint64_t seed = 0);
+  static bool IsManifest(std::span<const uint8_t> data);
+
+ private:
+  std::filesystem::path ChunkPath(uint64_t hash) const;
+  bool StoreChunk(uint64_t hash, std::span<const uint8_t> data, std::size_t& written,
+                  std::string& error);
+  bool LoadChunk(const Chunk& chunk, std::span<uint8_t> out) const;
+
+  std::filesystem::path dir_;
+  std::filesystem::path manifest_dir_;
+  std::shared_mutex mutex_;
+  std::unordered_set<uint64_t> known_;  // chunks on disk; writer thread only
+  std::thread collector_;
+  std::atomic<bool> collecting_ = false;
+};
+}
+#endif
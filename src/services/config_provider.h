@@ -17,6 +17,8 @@ struct ConfigKeys {
   static constexpr std::string_view kRetainClick   = "Input.RetainMouseByClick";
   static constexpr std::string_view kRetainEnter   = "Input.RetainMouseByEntering";
   static constexpr std::string_view kShakeRelease  = "Input.ReleaseMouseByShaking";
+  static constexpr std::string_view kGamepadPoll   = "Input.GamepadPolling";
+  static constexpr std::string_view kMouseRate     = "Input.MouseDeliveriesPerFrame";
   static constexpr std::string_view kAudioVolume   = "Audio.Volume";
   static constexpr std::string_view kAudioSep      = "Audio.Separation";
   static constexpr std::string_view kUiFullscreen    = "UI.Fullscreen";
@@ -55,8 +57,20 @@ struct ConfigKeys {
   static constexpr std::string_view kAudBufferSize   = "Audio.BufferSize";
 
   static constexpr std::string_view kSnapAutoDelete  = "Snapshot.AutoDelete";
+  static constexpr std::string_view kSnapCompress    = "Snapshot.Compress";
+  static constexpr std::string_view kSnapDedup       = "Snapshot.Deduplicate";
+  static constexpr std::string_view kSlotsPersist    = "Snapshot.PersistSlots";
   static constexpr std::string_view kScrnFormat      = "Screenshot.Format";
   static constexpr std::string_view kScrnSource      = "Screenshot.Source";
+
+  static constexpr std::string_view kLogEnabled  = "Log.Enabled";
+  static constexpr std::string_view kLogMaxKb    = "Log.MaxSizeKB";
+  static constexpr std::string_view kLogMaxFiles = "Log.MaxFiles";
+  static constexpr std::string_view kLogCompress = "Log.Compress";
+
+  static constexpr std::string_view kRewindEnabled  = "Rewind.Enabled";
+  static constexpr std::string_view kRewindInterval = "Rewind.IntervalFrames";
+  static constexpr std::string_view kRewindBudgetMb = "Rewind.BudgetMB";
 };
 class ConfigProvider {
  public:
@@ -0,0 +1,369 @@
+#include "disk_verifier.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include "services/amiga_volume.h"
+#include "services/mfm_track.h"
+
+namespace gui {
+
+namespace {
+constexpr std::size_t kBlockSize = 512;
+constexpr uint32_t kTypeHeader = 2;
+constexpr uint32_t kTypeList = 16;
+constexpr uint32_t kTypeData = 8;
+constexpr uint32_t kSecRoot = 1;
+constexpr uint32_t kRdsk = 0x5244534B;
+constexpr uint32_t kPart = 0x50415254;
+constexpr int kRdbSearchBlocks = 16;
+constexpr int kMaxPartitions = 16;
+constexpr std::size_t kMaxProblems = 32;
+constexpr std::size_t kAdfDD = 901120;
+constexpr std::size_t kAdfHD = 1802240;
+
+uint32_t Long(const uint8_t* p) {
+  return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+}
+
+struct Volume {
+  std::size_t first = 0;  // absolute block
+  uint32_t blocks = 0;
+  uint32_t bsize = kBlockSize;
+  bool ofs = false;
+};
+
+// Collects problems from several threads, keeping the first few.
+class Problems {
+ public:
+  explicit Problems(std::vector<std::string>& out) : out_(out) {}
+  void Add(std::string text) {
+    std::lock_guard lock(mutex_);
+    if (out_.size() < kMaxProblems) out_.push_back(std::move(text));
+  }
+
+ private:
+  std::vector<std::string>& out_;
+  std::mutex mutex_;
+};
+
+class Image {
+ public:
+  explicit Image(std::span<const uint8_t> data) : data_(data) {}
+  std::size_t Blocks() const { return data_.size() / kBlockSize; }
+  const uint8_t* Block(std::size_t nr, uint32_t bsize = kBlockSize) const {
+    return (nr + 1) * bsize <= data_.size() ? data_.data() + nr * bsize : nullptr;
+  }
+  uint32_t At(std::size_t nr, std::size_t index) const { return Long(data_.data() + nr * kBlockSize + index * 4); }
+
+  // Partitions from the rigid disk block, or the whole image as one.
+  std::vector<Volume> Volumes() const {
+    std::vector<Volume> volumes;
+    for (int rdb = 0; rdb < kRdbSearchBlocks && rdb < static_cast<int>(Blocks()); ++rdb) {
+      if (At(rdb, 0) != kRdsk) continue;
+      uint32_t part = At(rdb, 7);
+      for (int n = 0; n < kMaxPartitions && part < Blocks() && At(part, 0) == kPart; ++n) {
+        const uint32_t bsize = At(part, 33) * 4;
+        const uint64_t per_cyl = uint64_t{At(part, 35)} * At(part, 37);
+        const uint64_t low = At(part, 41), high = At(part, 42);
+        Volume v;
+        v.bsize = bsize == 0 ? kBlockSize : bsize;
+        v.first = static_cast<std::size_t>(low * per_cyl * v.bsize / kBlockSize);
+        v.blocks = static_cast<uint32_t>(std::min<uint64_t>((high - low + 1) * per_cyl, UINT32_MAX));
+        if (high >= low && v.first < Blocks()) volumes.push_back(v);
+        part = At(part, 4);
+      }
+      break;
+    }
+    if (volumes.empty()) volumes.push_back({0, static_cast<uint32_t>(Blocks()), kBlockSize, false});
+    for (auto& v : volumes) {
+      const uint8_t* boot = Block(v.first);
+      v.ofs = boot && (boot[3] & 1) == 0;
+      // Clip partitions that claim more than the image holds.
+      v.blocks = static_cast<uint32_t>(
+          std::min<std::size_t>(v.blocks, (data_.size() / v.bsize) - v.first * kBlockSize / v.bsize));
+    }
+    return volumes;
+  }
+
+  std::span<const uint8_t> data_;
+};
+
+std::string Extension(const std::filesystem::path& path) {
+  std::string ext = path.extension().string();
+  std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return std::tolower(c); });
+  return ext;
+}
+
+bool IsDos(const uint8_t* boot) {
+  return boot && boot[0] == 'D' && boot[1] == 'O' && boot[2] == 'S' && boot[3] <= 7;
+}
+
+// Sum of all longwords; zero for an intact block.
+uint32_t BlockSum(const uint8_t* block, uint32_t bsize) {
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < bsize; i += 4) sum += Long(block + i);
+  return sum;
+}
+
+// Whether `block` is file system metadata that carries a checksum: the
+// own block number in a header or list block is a strong signature.
+bool HasChecksum(const uint8_t* block, uint32_t rel, const Volume& v) {
+  const uint32_t type = Long(block);
+  if (type == kTypeHeader || type == kTypeList) return Long(block + 4) == rel;
+  if (type == kTypeData && v.ofs) {
+    return Long(block + 4) < v.blocks && Long(block + 8) >= 1 && Long(block + 12) <= v.bsize - 24;
+  }
+  return false;
+}
+
+void CheckVolume(const Image& image, const Volume& v, int index, DiskVerifier::Report& report,
+                 Problems& problems, int threads, const std::atomic<bool>* cancel) {
+  const uint32_t longs = v.bsize / 4;
+  const std::size_t scale = v.bsize / kBlockSize;
+  auto block = [&](uint32_t rel) { return image.Block(v.first / scale + rel, v.bsize); };
+  const std::string name = "volume " + std::to_string(index);
+  if (!IsDos(block(0))) return;
+  const uint32_t root = AmigaVolume::RootBlock(v.blocks);
+  const uint8_t* r = root < v.blocks ? block(root) : nullptr;
+  if (!r || Long(r) != kTypeHeader || Long(r + (longs - 1) * 4) != kSecRoot ||
+      BlockSum(r, v.bsize) != 0) {
+    problems.Add(name + ": bad root block " + std::to_string(root));
+    return;
+  }
+
+  // Bitmap pages are listed in the root and then in extension blocks.
+  std::vector<uint32_t> pages;
+  for (uint32_t i = 0; i < 25; ++i) pages.push_back(Long(r + (longs - 49 + i) * 4));
+  for (uint32_t ext = Long(r + (longs - 24) * 4), n = 0; ext != 0 && ext < v.blocks && n < 1024; ++n) {
+    const uint8_t* e = block(ext);
+    for (uint32_t i = 0; i + 1 < longs; ++i) pages.push_back(Long(e + i * 4));
+    ext = Long(e + (longs - 1) * 4);
+  }
+  for (const uint32_t page : pages) {
+    if (page == 0) continue;
+    if (page >= v.blocks || BlockSum(block(page), v.bsize) != 0) {
+      problems.Add(name + ": bad bitmap block " + std::to_string(page));
+    }
+  }
+
+  // Walk the tree on this thread, then stream the files in parallel.
+  AmigaVolume volume(
+      [&](uint32_t nr, std::span<uint8_t> out) {
+        const uint8_t* b = block(nr);
+        if (!b) return false;
+        std::memcpy(out.data(), b, out.size());
+        return true;
+      },
+      v.blocks, v.bsize, v.ofs);
+  struct File {
+    std::string path;
+    uint32_t block;
+  };
+  std::vector<File> files;
+  std::vector<std::pair<std::string, uint32_t>> dirs = {{"", root}};
+  std::vector<AmigaVolume::Entry> entries;
+  std::size_t budget = v.blocks;
+  while (!dirs.empty() && budget-- > 0) {
+    auto [path, dir] = std::move(dirs.back());
+    dirs.pop_back();
+    if (!volume.List(dir, entries)) {
+      problems.Add(name + ": unreadable directory " + path + "/");
+      continue;
+    }
+    for (const auto& e : entries) {
+      if (e.kind == AmigaVolume::Kind::kDirectory) dirs.emplace_back(path + "/" + e.name, e.block);
+      if (e.kind == AmigaVolume::Kind::kFile) files.push_back({path + "/" + e.name, e.block});
+    }
+  }
+  DiskVerifier::ParallelFor(
+      static_cast<int>(files.size()), threads,
+      [&](int i) {
+        const auto& f = files[static_cast<std::size_t>(i)];
+        if (!volume.Stream(f.block, [](std::span<const uint8_t>) { return true; })) {
+          problems.Add(name + ": broken block chain in " + f.path);
+        }
+      },
+      cancel);
+  report.files += static_cast<int>(files.size());
+}
+
+struct Mapping {
+  void* data = MAP_FAILED;
+  std::size_t size = 0;
+  ~Mapping() {
+    if (data != MAP_FAILED) ::munmap(data, size);
+  }
+};
+}  // namespace
+
+void DiskVerifier::ParallelFor(int count, int threads, const std::function<void(int)>& task,
+                               const std::atomic<bool>* cancel) {
+  if (count <= 0) return;
+  if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  threads = std::min(threads, count);
+  std::atomic<int> next = 0;
+  auto worker = [&] {
+    for (int i; (i = next++) < count;) {
+      if (cancel && *cancel) return;
+      task(i);
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+  worker();
+  for (auto& thread : pool) thread.join();
+}
+
+DiskVerifier::Report DiskVerifier::VerifyImage(std::span<const uint8_t> data, int blocks_per_track,
+                                               int threads, const std::atomic<bool>* cancel,
+                                               int tracks) {
+  Report report;
+  Problems problems(report.problems);
+  const Image image(data);
+  report.blocks_per_track = std::max(blocks_per_track, 1);
+  report.sector_image = !data.empty();
+  const auto per_track = static_cast<std::size_t>(report.blocks_per_track);
+  report.tracks.assign(tracks > 0 ? static_cast<std::size_t>(tracks)
+                                  : (image.Blocks() + per_track - 1) / per_track,
+                       Status::kUnchecked);
+
+  const uint8_t* boot = image.Block(0);
+  report.dos = IsDos(boot);
+  if (report.dos && image.Blocks() >= 2) {
+    // End-around carry sum over both boot blocks.
+    uint32_t sum = 0;
+    for (std::size_t i = 0; i < 2 * kBlockSize; i += 4) {
+      const uint32_t before = sum;
+      sum += Long(boot + i);
+      if (sum < before) ++sum;
+    }
+    report.bootable = sum == 0xFFFFFFFF;
+  }
+
+  const auto volumes = image.Volumes();
+  report.volumes = static_cast<int>(volumes.size());
+  std::atomic<int> bad_blocks = 0;
+  ParallelFor(
+      static_cast<int>(report.tracks.size()), threads,
+      [&](int t) {
+        bool ok = true;
+        const std::size_t first = static_cast<std::size_t>(t) * per_track;
+        if (first >= image.Blocks()) return;
+        for (std::size_t nr = first; nr < std::min(first + per_track, image.Blocks()); ++nr) {
+          for (const auto& v : volumes) {
+            const std::size_t scale = v.bsize / kBlockSize;
+            if (nr < v.first || nr >= v.first + std::size_t{v.blocks} * scale) continue;
+            // Larger blocks are checked once, at their first sector.
+            if ((nr - v.first) % scale != 0 || !IsDos(image.Block(v.first))) break;
+            const auto rel = static_cast<uint32_t>((nr - v.first) / scale);
+            const uint8_t* b = image.Block(v.first / scale + rel, v.bsize);
+            if (b && HasChecksum(b, rel, v) && BlockSum(b, v.bsize) != 0) {
+              ++bad_blocks;
+              ok = false;
+              problems.Add("checksum error in block " + std::to_string(nr));
+            }
+            break;
+          }
+        }
+        report.tracks[static_cast<std::size_t>(t)] = ok ? Status::kOk : Status::kError;
+      },
+      cancel);
+  report.bad_blocks = bad_blocks;
+
+  for (std::size_t i = 0; i < volumes.size(); ++i) {
+    CheckVolume(image, volumes[i], static_cast<int>(i), report, problems, threads, cancel);
+  }
+  return report;
+}
+
+void DiskVerifier::VerifyTracks(Report& report,
+                                std::span<const std::shared_ptr<const MfmTrack>> tracks) {
+  if (report.tracks.size() < tracks.size()) report.tracks.resize(tracks.size(), Status::kUnchecked);
+  Problems problems(report.problems);
+  for (std::size_t t = 0; t < tracks.size(); ++t) {
+    if (!tracks[t]) continue;
+    const auto& track = *tracks[t];
+    const int bad = track.BadSectors();
+    if (bad == 0 && !track.Sectors().empty()) {
+      // Without a sector image the MFM check is the only one a track gets.
+      if (report.tracks[t] == Status::kUnchecked) report.tracks[t] = Status::kOk;
+      continue;
+    }
+    report.bad_sectors += bad;
+    report.tracks[t] = Status::kError;
+    problems.Add(track.Sectors().empty()
+                     ? "track " + std::to_string(t) + ": no sectors found"
+                     : "track " + std::to_string(t) + ": " + std::to_string(bad) +
+                           " sector checksum errors");
+  }
+}
+
+int DiskVerifier::VerifyDirectory(const std::filesystem::path& dir, std::ostream& out, int threads) {
+  std::vector<std::filesystem::path> images;
+  std::error_code ec;
+  for (auto it = std::filesystem::recursive_directory_iterator(dir, ec);
+       !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+    const std::string ext = Extension(it->path());
+    if (it->is_regular_file(ec) && (ext == ".adf" || ext == ".hdf" || ext == ".ipf")) {
+      images.push_back(it->path());
+    }
+  }
+  std::ranges::sort(images);
+
+  // One image per thread scales better than splitting single images.
+  std::vector<std::string> lines(images.size());
+  std::atomic<int> failed = 0;
+  std::atomic<uint64_t> bytes = 0;
+  const auto start = std::chrono::steady_clock::now();
+  ParallelFor(static_cast<int>(images.size()), threads, [&](int i) {
+    const auto& path = images[static_cast<std::size_t>(i)];
+    auto& line = lines[static_cast<std::size_t>(i)];
+    if (Extension(path) == ".ipf") {
+      line = "SKIP " + path.string() + ": IPF needs a drive, verify it from the Disk Inspector";
+      return;
+    }
+    Mapping map;
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st {};
+    if (fd >= 0 && ::fstat(fd, &st) == 0 && st.st_size > 0) {
+      map.size = static_cast<std::size_t>(st.st_size);
+      map.data = ::mmap(nullptr, map.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (fd >= 0) ::close(fd);
+    if (map.data == MAP_FAILED) {
+      line = "FAIL " + path.string() + ": cannot read";
+      ++failed;
+      return;
+    }
+    const std::span<const uint8_t> data(static_cast<const uint8_t*>(map.data), map.size);
+    const int per_track = map.size == kAdfDD ? 11 : map.size == kAdfHD ? 22 : 32;
+    const auto report = VerifyImage(data, per_track, 1);
+    bytes += map.size;
+    if (report.Ok()) {
+      line = "OK   " + path.string() + " (" + std::to_string(report.files) + " files" +
+             (report.dos ? "" : ", not a DOS disk") + ")";
+    } else {
+      ++failed;
+      line = "FAIL " + path.string();
+      for (const auto& problem : report.problems) line += "\n     " + problem;
+    }
+  });
+  for (const auto& line : lines) out << line << '\n';
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  out << images.size() << " images, " << failed << " damaged, "
+      << static_cast<uint64_t>(static_cast<double>(bytes) / (1024.0 * 1024.0) /
+                               std::max(seconds, 1e-6))
+      << " MB/s\n";
+  return failed;
+}
+
+}
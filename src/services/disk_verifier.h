@@ -0,0 +1,54 @@
+#ifndef LINUXGUI_SERVICES_DISK_VERIFIER_H_
+#define LINUXGUI_SERVICES_DISK_VERIFIER_H_
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+namespace gui {
+class MfmTrack;
+// Checks disk images for damage: the boot block, every block that carries
+// an AmigaDOS checksum, bitmaps and every file's block chain, plus the
+// MFM sector checksums when raw tracks are available. Tracks and files
+// are independent, so both passes are spread over a pool of threads.
+class DiskVerifier {
+ public:
+  enum class Status : uint8_t { kUnchecked, kOk, kError };
+  struct Report {
+    std::vector<Status> tracks;
+    int blocks_per_track = 11;
+    bool dos = false;
+    bool bootable = false;
+    int volumes = 0;
+    int files = 0;
+    int bad_blocks = 0;
+    int bad_sectors = 0;
+    // False when there was no sector image and only raw tracks were checked.
+    bool sector_image = true;
+    std::vector<std::string> problems;
+    bool Ok() const { return problems.empty(); }
+  };
+  // `image` is a raw sector image (ADF, or HDF with or without an RDB), or
+  // empty if there is none. `tracks` is the disk's track count; zero or
+  // less derives it from the image size. Tracks the image does not cover
+  // stay unchecked.
+  static Report VerifyImage(std::span<const uint8_t> image, int blocks_per_track, int threads,
+                            const std::atomic<bool>* cancel = nullptr, int tracks = 0);
+  // Checks the sector header and data checksums of decoded tracks, one
+  // entry per track; null entries stay unchecked.
+  static void VerifyTracks(Report& report,
+                           std::span<const std::shared_ptr<const MfmTrack>> tracks);
+  // Verifies every ADF and HDF below `dir`, one image per thread, and
+  // prints a line per image. Returns the number of damaged images.
+  static int VerifyDirectory(const std::filesystem::path& dir, std::ostream& out, int threads);
+  // Runs task(0) .. task(count - 1) on up to `threads` threads; zero or
+  // less means one per core.
+  static void ParallelFor(int count, int threads, const std::function<void(int)>& task,
+                          const std::atomic<bool>* cancel = nullptr);
+};
+}
+#endif
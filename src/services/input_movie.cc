@@ -0,0 +1,183 @@
+#include "input_movie.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+namespace gui {
+
+namespace {
+// File layout (all integers LEB128 varints unless noted):
+//   u32 magic, u16 version (little endian)
+//   snapshot size, snapshot bytes
+//   event count, per event: frame delta, type, then port+code or zigzag dx/dy
+//   checksum count, per checksum: frame delta, u64 hash (little endian)
+void PutVarint(std::vector<uint8_t>& out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+void PutFixed(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+uint64_t ZigZag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t UnZigZag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+class Reader {
+ public:
+  explicit Reader(std::span<const uint8_t> data) : data_(data) {}
+
+  bool Varint(uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) return false;
+      const uint8_t b = data_[pos_++];
+      v |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if (!(b & 0x80)) return true;
+    }
+    return false;
+  }
+
+  bool Fixed(uint64_t& v, int bytes) {
+    if (data_.size() - pos_ < static_cast<std::size_t>(bytes)) return false;
+    v = 0;
+    for (int i = 0; i < bytes; ++i) v |= static_cast<uint64_t>(data_[pos_++]) << (8 * i);
+    return true;
+  }
+
+  bool Bytes(std::vector<uint8_t>& out, uint64_t n) {
+    if (data_.size() - pos_ < n) return false;
+    out.assign(data_.begin() + static_cast<std::ptrdiff_t>(pos_),
+               data_.begin() + static_cast<std::ptrdiff_t>(pos_ + n));
+    pos_ += n;
+    return true;
+  }
+
+  std::size_t Remaining() const { return data_.size() - pos_; }
+
+ private:
+  std::span<const uint8_t> data_;
+  std::size_t pos_ = 0;
+};
+}  // namespace
+
+std::vector<uint8_t> InputMovie::Encode() const {
+  std::vector<uint8_t> out;
+  out.reserve(snapshot.size() + events.size() * 4 + checksums.size() * 9 + 32);
+  PutFixed(out, kMagic, 4);
+  PutFixed(out, kVersion, 2);
+  PutVarint(out, snapshot.size());
+  out.insert(out.end(), snapshot.begin(), snapshot.end());
+
+  PutVarint(out, events.size());
+  uint32_t frame = 0;
+  for (const auto& e : events) {
+    PutVarint(out, e.frame - frame);
+    frame = e.frame;
+    out.push_back(static_cast<uint8_t>(e.action.type));
+    if (e.action.type == InputAction::Type::kMouseMove) {
+      out.push_back(e.action.port);
+      PutVarint(out, ZigZag(std::lround(e.action.dx * kMotionScale)));
+      PutVarint(out, ZigZag(std::lround(e.action.dy * kMotionScale)));
+    } else {
+      out.push_back(e.action.port);
+      out.push_back(e.action.code);
+    }
+  }
+
+  PutVarint(out, checksums.size());
+  frame = 0;
+  for (const auto& c : checksums) {
+    PutVarint(out, c.frame - frame);
+    frame = c.frame;
+    PutFixed(out, c.hash, 8);
+  }
+  return out;
+}
+
+bool InputMovie::Decode(std::span<const uint8_t> data) {
+  Reader in(data);
+  uint64_t magic = 0, version = 0, n = 0;
+  if (!in.Fixed(magic, 4) || magic != kMagic) return false;
+  if (!in.Fixed(version, 2) || version != kVersion) return false;
+
+  InputMovie movie;
+  if (!in.Varint(n) || !in.Bytes(movie.snapshot, n)) return false;
+
+  // Every event takes at least four bytes, which bounds the reservation.
+  if (!in.Varint(n) || n > in.Remaining() / 4) return false;
+  movie.events.reserve(n);
+  uint64_t frame = 0;
+  for (uint64_t i = 0; i < n; ++i) {
+    uint64_t delta = 0, type = 0, port = 0;
+    if (!in.Varint(delta) || !in.Fixed(type, 1) || !in.Fixed(port, 1)) return false;
+    if (type > static_cast<uint64_t>(InputAction::Type::kMouseMove)) return false;
+    frame += delta;
+    Event e;
+    e.frame = static_cast<uint32_t>(frame);
+    e.action.type = static_cast<InputAction::Type>(type);
+    e.action.port = static_cast<uint8_t>(port);
+    if (e.action.type == InputAction::Type::kMouseMove) {
+      uint64_t dx = 0, dy = 0;
+      if (!in.Varint(dx) || !in.Varint(dy)) return false;
+      e.action.dx = static_cast<float>(UnZigZag(dx)) / kMotionScale;
+      e.action.dy = static_cast<float>(UnZigZag(dy)) / kMotionScale;
+    } else {
+      uint64_t code = 0;
+      if (!in.Fixed(code, 1)) return false;
+      e.action.code = static_cast<uint8_t>(code);
+    }
+    movie.events.push_back(e);
+  }
+
+  if (!in.Varint(n) || n > in.Remaining() / 9) return false;
+  movie.checksums.reserve(n);
+  frame = 0;
+  for (uint64_t i = 0; i < n; ++i) {
+    uint64_t delta = 0, hash = 0;
+    if (!in.Varint(delta) || !in.Fixed(hash, 8)) return false;
+    frame += delta;
+    movie.checksums.push_back({static_cast<uint32_t>(frame), hash});
+  }
+  *this = std::move(movie);
+  return true;
+}
+
+bool InputMovie::Save(const std::filesystem::path& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) return false;
+  const auto bytes = Encode();
+  file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  return static_cast<bool>(file);
+}
+
+bool InputMovie::Load(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+  return Decode(bytes);
+}
+
+uint32_t InputMovie::FrameCount() const {
+  uint32_t frames = 0;
+  if (!checksums.empty()) frames = checksums.back().frame + 1;
+  if (!events.empty()) frames = std::max(frames, events.back().frame + 1);
+  return frames;
+}
+
+uint64_t InputMovie::HashFrame(std::span<const uint32_t> pixels) {
+  // FNV-1a over whole pixels; collisions only need to be unlikely, not hard.
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (uint32_t p : pixels) {
+    h ^= p;
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef LINUXGUI_SERVICES_INPUT_MOVIE_H_
+#define LINUXGUI_SERVICES_INPUT_MOVIE_H_
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+namespace gui {
+// One input action as it is handed to the emulator. `code` holds an Amiga
+// key code or a GamePadAction value depending on the type.
+struct InputAction {
+  enum class Type : uint8_t { kKeyPress, kKeyRelease, kJoystick, kMouseButton, kMouseMove };
+  Type type = Type::kKeyPress;
+  uint8_t port = 0;
+  uint8_t code = 0;
+  float dx = 0.0f;
+  float dy = 0.0f;
+
+  bool operator==(const InputAction&) const = default;
+};
+
+// A recorded session: the snapshot it starts from, the actions applied
+// before each emulated frame and a checksum of every finished frame.
+struct InputMovie {
+  struct Event {
+    uint32_t frame = 0;
+    InputAction action;
+    bool operator==(const Event&) const = default;
+  };
+  struct Checksum {
+    uint32_t frame = 0;
+    uint64_t hash = 0;
+    bool operator==(const Checksum&) const = default;
+  };
+
+  static constexpr uint32_t kMagic = 0x564D4156;  // "VAMV"
+  static constexpr uint16_t kVersion = 1;
+  // Mouse deltas are stored as fixed point with this many steps per pixel.
+  static constexpr float kMotionScale = 16.0f;
+
+  std::vector<uint8_t> snapshot;
+  std::vector<Event> events;
+  std::vector<Checksum> checksums;
+
+  // Events and checksums must be sorted by frame; both are delta encoded.
+  std::vector<uint8_t> Encode() const;
+  bool Decode(std::span<const uint8_t> data);
+  bool Save(const std::filesystem::path& path) const;
+  bool Load(const std::filesystem::path& path);
+
+  uint32_t FrameCount() const;
+  static uint64_t HashFrame(std::span<const uint32_t> pixels);
+};
+}
+#endif
@@ -0,0 +1,135 @@
+#include "log_writer.h"
+#include <algorithm>
+#include <system_error>
+#include <vector>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace gui {
+
+namespace {
+bool GzipFile(const std::filesystem::path& src, const std::filesystem::path& dst) {
+#ifdef HAVE_ZLIB
+  std::ifstream in(src, std::ios::binary);
+  if (!in) return false;
+  gzFile out = gzopen(dst.c_str(), "wb6");
+  if (!out) return false;
+  std::vector<char> buf(64 * 1024);
+  bool ok = true;
+  while (ok && in) {
+    in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+    const auto n = static_cast<int>(in.gcount());
+    if (n > 0) ok = gzwrite(out, buf.data(), static_cast<unsigned>(n)) == n;
+  }
+  return gzclose(out) == Z_OK && ok;
+#else
+  (void)src;
+  (void)dst;
+  return false;
+#endif
+}
+}  // namespace
+
+LogWriter::~LogWriter() { Close(); }
+
+bool LogWriter::CompressionAvailable() {
+#ifdef HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::filesystem::path LogWriter::RotatedPath(const std::filesystem::path& path,
+                                             int index, bool compressed) {
+  std::filesystem::path rotated = path;
+  rotated += "." + std::to_string(index);
+  if (compressed) rotated += ".gz";
+  return rotated;
+}
+
+bool LogWriter::Open(const std::filesystem::path& path, const Options& options) {
+  Close();
+  std::error_code ec;
+  if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), ec);
+  file_.open(path, std::ios::binary | std::ios::app);
+  if (!file_) return false;
+
+  path_ = path;
+  options_ = options;
+  options_.max_files = std::max(options_.max_files, 1);
+  options_.max_bytes = std::max<std::size_t>(options_.max_bytes, 1);
+  if (!CompressionAvailable()) options_.compress = false;
+  file_bytes_ = static_cast<std::size_t>(std::filesystem::file_size(path, ec));
+  if (ec) file_bytes_ = 0;
+
+  pending_ = 0;
+  stop_ = false;
+  dropped_ = 0;
+  open_ = true;
+  worker_ = std::thread(&LogWriter::Run, this);
+  return true;
+}
+
+bool LogWriter::Write(std::string line) {
+  if (!open_) return false;
+  if (!queue_.Push(std::move(line))) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  // The worker only sleeps while the counter is zero.
+  if (pending_.fetch_add(1, std::memory_order_release) == 0) pending_.notify_one();
+  return true;
+}
+
+void LogWriter::Close() {
+  if (!open_) return;
+  stop_ = true;
+  pending_.fetch_add(1, std::memory_order_release);
+  pending_.notify_one();
+  worker_.join();
+  file_.close();
+  open_ = false;
+}
+
+void LogWriter::Run() {
+  std::string line;
+  for (;;) {
+    pending_.wait(0, std::memory_order_acquire);
+    int32_t popped = 0;
+    while (queue_.Pop(line)) {
+      file_.write(line.data(), static_cast<std::streamsize>(line.size()));
+      file_bytes_ += line.size();
+      ++popped;
+      if (file_bytes_ >= options_.max_bytes) Rotate();
+    }
+    file_.flush();
+    if (popped > 0) pending_.fetch_sub(popped, std::memory_order_acq_rel);
+    if (stop_ && queue_.Empty()) break;
+  }
+}
+
+void LogWriter::Rotate() {
+  file_.close();
+  std::error_code ec;
+  const int last = options_.max_files;
+  for (bool gz : {false, true}) std::filesystem::remove(RotatedPath(path_, last, gz), ec);
+  for (int i = last - 1; i >= 1; --i) {
+    for (bool gz : {false, true}) {
+      const auto from = RotatedPath(path_, i, gz);
+      if (std::filesystem::exists(from, ec)) {
+        std::filesystem::rename(from, RotatedPath(path_, i + 1, gz), ec);
+      }
+    }
+  }
+  const auto first = RotatedPath(path_, 1, false);
+  std::filesystem::rename(path_, first, ec);
+  if (options_.compress && GzipFile(first, RotatedPath(path_, 1, true))) {
+    std::filesystem::remove(first, ec);
+  }
+  file_.open(path_, std::ios::binary | std::ios::trunc);
+  file_bytes_ = 0;
+}
+
+}
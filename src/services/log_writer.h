@@ -0,0 +1,58 @@
+#ifndef LINUXGUI_SERVICES_LOG_WRITER_H_
+#define LINUXGUI_SERVICES_LOG_WRITER_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include "services/spsc_queue.h"
+namespace gui {
+// Appends text lines to a size-rotated log file. Write() only pushes into a
+// lock-free queue and must always be called from the same thread; the file
+// is written, rotated and optionally gzip-compressed by a worker thread.
+class LogWriter {
+ public:
+  struct Options {
+    std::size_t max_bytes = 4 * 1024 * 1024;
+    int max_files = 5;
+    bool compress = false;
+  };
+  static constexpr std::size_t kQueueSize = 8192;
+
+  LogWriter() = default;
+  ~LogWriter();
+  LogWriter(const LogWriter&) = delete;
+  LogWriter& operator=(const LogWriter&) = delete;
+
+  bool Open(const std::filesystem::path& path, const Options& options);
+  bool Write(std::string line);
+  void Close();
+  bool IsOpen() const { return open_; }
+  const std::filesystem::path& Path() const { return path_; }
+  uint64_t Dropped() const { return dropped_.load(); }
+
+  static bool CompressionAvailable();
+  // Name of the n-th rotated file, e.g. console.log.2 or console.log.2.gz.
+  static std::filesystem::path RotatedPath(const std::filesystem::path& path,
+                                           int index, bool compressed);
+
+ private:
+  void Run();
+  void Rotate();
+
+  SpscQueue<std::string, kQueueSize> queue_;
+  std::atomic<int32_t> pending_ = 0;
+  std::atomic<bool> stop_ = false;
+  std::atomic<uint64_t> dropped_ = 0;
+  std::thread worker_;
+  bool open_ = false;
+
+  std::filesystem::path path_;
+  Options options_;
+  std::ofstream file_;
+  std::size_t file_bytes_ = 0;
+};
+}
+#endif
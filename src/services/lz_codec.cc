@@ -0,0 +1,111 @@
+#include "lz_codec.h"
+#include <array>
+#include <cstring>
+
+namespace gui {
+
+namespace {
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kMaxOffset = 65535;
+constexpr int kHashBits = 14;
+
+uint32_t Load32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t Hash(uint32_t v) { return (v * 2654435761u) >> (32 - kHashBits); }
+
+void PutLength(std::vector<uint8_t>& out, std::size_t len) {
+  while (len >= 255) {
+    out.push_back(255);
+    len -= 255;
+  }
+  out.push_back(static_cast<uint8_t>(len));
+}
+
+void EmitSequence(std::vector<uint8_t>& out, const uint8_t* lit, std::size_t lit_len,
+                  std::size_t match_len, std::size_t offset) {
+  const std::size_t ml = match_len ? match_len - kMinMatch : 0;
+  const uint8_t token = static_cast<uint8_t>(((lit_len < 15 ? lit_len : 15) << 4) |
+                                             (ml < 15 ? ml : 15));
+  out.push_back(token);
+  if (lit_len >= 15) PutLength(out, lit_len - 15);
+  out.insert(out.end(), lit, lit + lit_len);
+  if (!match_len) return;
+  out.push_back(static_cast<uint8_t>(offset));
+  out.push_back(static_cast<uint8_t>(offset >> 8));
+  if (ml >= 15) PutLength(out, ml - 15);
+}
+
+bool GetLength(std::span<const uint8_t> in, std::size_t& pos, std::size_t& len) {
+  uint8_t b;
+  do {
+    if (pos >= in.size()) return false;
+    b = in[pos++];
+    len += b;
+  } while (b == 255);
+  return true;
+}
+}  // namespace
+
+std::vector<uint8_t> LzCompress(std::span<const uint8_t> in) {
+  std::vector<uint8_t> out;
+  out.reserve(in.size() / 4 + 16);
+  std::array<uint32_t, 1u << kHashBits> table{};  // position + 1, 0 = empty
+  const uint8_t* base = in.data();
+  const std::size_t n = in.size();
+  std::size_t anchor = 0, pos = 0;
+  while (n >= kMinMatch && pos + kMinMatch <= n) {
+    const uint32_t seq = Load32(base + pos);
+    auto& slot = table[Hash(seq)];
+    const std::size_t cand = slot ? slot - 1 : n;
+    slot = static_cast<uint32_t>(pos + 1);
+    if (cand >= pos || pos - cand > kMaxOffset || Load32(base + cand) != seq) {
+      // Skip ahead faster the longer nothing has matched, so incompressible
+      // input does not cost a hash probe per byte.
+      pos += 1 + ((pos - anchor) >> 6);
+      continue;
+    }
+    std::size_t len = kMinMatch;
+    while (pos + len < n && base[cand + len] == base[pos + len]) ++len;
+    EmitSequence(out, base + anchor, pos - anchor, len, pos - cand);
+    pos += len;
+    anchor = pos;
+  }
+  EmitSequence(out, base + anchor, n - anchor, 0, 0);
+  return out;
+}
+
+bool LzDecompress(std::span<const uint8_t> in, std::span<uint8_t> out) {
+  std::size_t ip = 0, op = 0;
+  while (ip < in.size()) {
+    const uint8_t token = in[ip++];
+    std::size_t lit = token >> 4;
+    if (lit == 15 && !GetLength(in, ip, lit)) return false;
+    if (lit > in.size() - ip || lit > out.size() - op) return false;
+    std::memcpy(out.data() + op, in.data() + ip, lit);
+    ip += lit;
+    op += lit;
+    if (ip == in.size()) break;  // the final token has no match
+
+    if (in.size() - ip < 2) return false;
+    const std::size_t offset = in[ip] | (static_cast<std::size_t>(in[ip + 1]) << 8);
+    ip += 2;
+    std::size_t len = token & 15;
+    if (len == 15 && !GetLength(in, ip, len)) return false;
+    len += kMinMatch;
+    if (offset == 0 || offset > op || len > out.size() - op) return false;
+    if (offset >= len) {
+      std::memcpy(out.data() + op, out.data() + op - offset, len);
+      op += len;
+    } else {
+      // Overlapping copy, i.e. a run: must go byte by byte.
+      for (std::size_t i = 0; i < len; ++i, ++op) out[op] = out[op - offset];
+    }
+  }
+  return op == out.size();
+}
+
+}
@@ -0,0 +1,19 @@
+#ifndef LINUXGUI_SERVICES_LZ_CODEC_H_
+#define LINUXGUI_SERVICES_LZ_CODEC_H_
+#include <cstdint>
+#include <span>
+#include <vector>
+namespace gui {
+// Byte-oriented LZ77 in the style of LZ4: greedy matching through a hash
+// table, no entropy stage. It trades ratio for speed and is meant for data
+// with long runs and repeats, like XOR deltas of consecutive snapshots.
+//
+// A block is a sequence of tokens. Each token's high nibble is the literal
+// count and its low nibble the match length minus 4; a nibble of 15 is
+// continued with 255-valued bytes. Literals follow the token, then a
+// 16-bit little endian match offset. The final token carries literals only.
+std::vector<uint8_t> LzCompress(std::span<const uint8_t> in);
+// `out` must have the exact size of the original data.
+bool LzDecompress(std::span<const uint8_t> in, std::span<uint8_t> out);
+}
+#endif
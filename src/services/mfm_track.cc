@@ -0,0 +1,96 @@
+#include "mfm_track.h"
+#include <algorithm>
+
+namespace gui {
+
+namespace {
+constexpr uint32_t kSync = 0x44894489;
+constexpr uint32_t kDataMask = 0x55555555;
+constexpr std::size_t kSyncBits = 32;
+
+uint32_t Merge(uint32_t odd, uint32_t even) {
+  return ((odd & kDataMask) << 1) | (even & kDataMask);
+}
+}  // namespace
+
+uint32_t MfmTrack::Long(std::size_t bit) const {
+  uint32_t value = 0;
+  for (std::size_t i = 0; i < 32; ++i) value = (value << 1) | (Bit((bit + i) % count_) ? 1 : 0);
+  return value;
+}
+
+uint32_t MfmTrack::Checksum(std::size_t bit, std::size_t longs) const {
+  uint32_t sum = 0;
+  for (std::size_t i = 0; i < longs; ++i) sum ^= Long(bit + i * 32);
+  return sum & kDataMask;
+}
+
+MfmTrack MfmTrack::Decode(std::string_view bits) {
+  MfmTrack t;
+  t.count_ = bits.size();
+  t.bits_.assign((t.count_ + 7) / 8, 0);
+  for (std::size_t i = 0; i < t.count_; ++i) {
+    if (bits[i] == '1') t.bits_[i >> 3] |= static_cast<uint8_t>(0x80 >> (i & 7));
+  }
+  if (t.count_ < kSyncBits) {
+    t.spans_.push_back({0, t.count_, Region::kGap, -1});
+    return t;
+  }
+
+  // Sync words may straddle the index, so the search runs on a little
+  // past the end of the track.
+  uint32_t shift = 0;
+  std::size_t skip_until = 0;
+  for (std::size_t i = 0; i < t.count_ + kSyncBits - 1; ++i) {
+    shift = (shift << 1) | (t.Bit(i % t.count_) ? 1 : 0);
+    if (i + 1 < kSyncBits || shift != kSync || i < skip_until) continue;
+    const std::size_t sync = i + 1 - kSyncBits;
+    const std::size_t p = sync + kSyncBits;
+    Sector s;
+    s.sync_bit = sync;
+    const uint32_t info = Merge(t.Long(p), t.Long(p + 32));
+    s.track = static_cast<int>((info >> 16) & 0xFF);
+    s.sector = static_cast<int>((info >> 8) & 0xFF);
+    // Info and label are covered by the header checksum.
+    s.header_ok = Merge(t.Long(p + 320), t.Long(p + 352)) == t.Checksum(p, 10);
+    s.data_ok = Merge(t.Long(p + 384), t.Long(p + 416)) == t.Checksum(p + kHeaderBits, 256);
+    t.sectors_.push_back(s);
+    skip_until = i + kHeaderBits + kDataBits;
+  }
+
+  // Regions are clipped at the end of the track; the few bits of a
+  // sector that wrap around to the start stay part of the first gap.
+  std::size_t cursor = 0;
+  auto add = [&](std::size_t begin, std::size_t end, Region region, int sector) {
+    begin = std::max(begin, cursor);
+    end = std::min(end, t.count_);
+    if (begin >= end) return;
+    if (begin > cursor) t.spans_.push_back({cursor, begin, Region::kGap, -1});
+    t.spans_.push_back({begin, end, region, sector});
+    cursor = end;
+  };
+  for (std::size_t k = 0; k < t.sectors_.size(); ++k) {
+    const std::size_t sync = t.sectors_[k].sync_bit;
+    const int index = static_cast<int>(k);
+    add(sync, sync + kSyncBits, Region::kSync, index);
+    add(sync + kSyncBits, sync + kSyncBits + kHeaderBits, Region::kHeader, index);
+    add(sync + kSyncBits + kHeaderBits, sync + kSyncBits + kHeaderBits + kDataBits, Region::kData,
+        index);
+  }
+  if (cursor < t.count_) t.spans_.push_back({cursor, t.count_, Region::kGap, -1});
+  return t;
+}
+
+const MfmTrack::Span& MfmTrack::SpanAt(std::size_t bit) const {
+  static const Span kEmpty;
+  if (spans_.empty()) return kEmpty;
+  auto it = std::ranges::upper_bound(spans_, bit, {}, &Span::begin);
+  return it == spans_.begin() ? spans_.front() : *std::prev(it);
+}
+
+int MfmTrack::BadSectors() const {
+  return static_cast<int>(std::ranges::count_if(
+      sectors_, [](const Sector& s) { return !s.header_ok || !s.data_ok; }));
+}
+
+}
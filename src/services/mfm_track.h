@@ -0,0 +1,49 @@
+#ifndef LINUXGUI_SERVICES_MFM_TRACK_H_
+#define LINUXGUI_SERVICES_MFM_TRACK_H_
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+namespace gui {
+// An Amiga floppy track decoded once from its raw MFM bit stream. Every
+// bit belongs to exactly one span, so a viewer can colour the stream by
+// looking spans up instead of re-parsing it.
+class MfmTrack {
+ public:
+  enum class Region : uint8_t { kGap, kSync, kHeader, kData };
+  struct Span {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    Region region = Region::kGap;
+    int sector = -1;  // index into Sectors(), -1 for gaps
+  };
+  struct Sector {
+    int track = 0;
+    int sector = 0;
+    std::size_t sync_bit = 0;
+    bool header_ok = false;
+    bool data_ok = false;
+  };
+  // Header and data of one sector following the two sync words.
+  static constexpr std::size_t kHeaderBits = 56 * 8;
+  static constexpr std::size_t kDataBits = 1024 * 8;
+  // `bits` holds one '0' or '1' per bit, as the drive reports the track.
+  static MfmTrack Decode(std::string_view bits);
+  std::size_t BitCount() const { return count_; }
+  bool Bit(std::size_t i) const { return (bits_[i >> 3] >> (7 - (i & 7))) & 1; }
+  const std::vector<Span>& Spans() const { return spans_; }
+  const std::vector<Sector>& Sectors() const { return sectors_; }
+  // The span containing `bit`, found by binary search.
+  const Span& SpanAt(std::size_t bit) const;
+  int BadSectors() const;
+ private:
+  // Reads 32 bits, wrapping around the end of the track.
+  uint32_t Long(std::size_t bit) const;
+  uint32_t Checksum(std::size_t bit, std::size_t longs) const;
+  std::vector<uint8_t> bits_;
+  std::size_t count_ = 0;
+  std::vector<Span> spans_;
+  std::vector<Sector> sectors_;
+};
+}
+#endif
@@ -0,0 +1,36 @@
+#include "motion_coalescer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace gui {
+
+void MotionCoalescer::Configure(int per_frame, int64_t frame_cycles) {
+  interval_ = per_frame <= 0 ? 0 : std::max<int64_t>(frame_cycles / per_frame, 1);
+}
+
+void MotionCoalescer::Add(double dx, double dy) {
+  dx_ += dx;
+  dy_ += dy;
+}
+
+bool MotionCoalescer::Due(int64_t clock) const {
+  if (std::abs(dx_) < 1.0 && std::abs(dy_) < 1.0) return false;
+  // A clock that went backwards means a reset or a restored snapshot.
+  return interval_ == 0 || last_clock_ < 0 || clock < last_clock_ ||
+         clock - last_clock_ >= interval_;
+}
+
+MotionCoalescer::Delta MotionCoalescer::Take(int64_t clock) {
+  const Delta whole{std::trunc(dx_), std::trunc(dy_)};
+  dx_ -= whole.dx;
+  dy_ -= whole.dy;
+  last_clock_ = clock;
+  return whole;
+}
+
+void MotionCoalescer::Reset() {
+  dx_ = dy_ = 0.0;
+  last_clock_ = -1;
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef LINUXGUI_SERVICES_MOTION_COALESCER_H_
+#define LINUXGUI_SERVICES_MOTION_COALESCER_H_
+#include <cstdint>
+namespace gui {
+// Accumulates relative mouse motion and releases it in whole pixels at a
+// fixed number of deliveries per emulated frame. Progress is measured on
+// the emulator's CPU clock, so a stalled or paused machine keeps
+// accumulating instead of receiving a burst of tiny moves. Fractions that
+// do not add up to a pixel yet stay in the accumulator.
+class MotionCoalescer {
+ public:
+  struct Delta {
+    double dx = 0.0;
+    double dy = 0.0;
+  };
+
+  // CPU cycles per frame: two per DMA cycle, 313 lines of 227 DMA cycles
+  // on PAL, 262.5 lines of 227.5 on NTSC.
+  static constexpr int64_t kPalFrameCycles = 313 * 227 * 2;
+  static constexpr int64_t kNtscFrameCycles = 525 * 455 / 2;
+
+  // `per_frame` <= 0 disables pacing: motion is due once a pixel has built up.
+  void Configure(int per_frame, int64_t frame_cycles);
+  void Add(double dx, double dy);
+  bool Due(int64_t clock) const;
+  // Takes the whole-pixel part of the accumulated motion.
+  Delta Take(int64_t clock);
+  bool Empty() const { return dx_ == 0.0 && dy_ == 0.0; }
+  void Reset();
+
+ private:
+  double dx_ = 0.0;
+  double dy_ = 0.0;
+  int64_t interval_ = kPalFrameCycles;
+  int64_t last_clock_ = -1;
+};
+}
+#endif
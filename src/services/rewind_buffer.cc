@@ -0,0 +1,58 @@
+#include "rewind_buffer.h"
+#include <algorithm>
+#include "services/lz_codec.h"
+
+namespace gui {
+
+void RewindBuffer::SetBudget(std::size_t bytes) {
+  budget_ = bytes;
+  Evict();
+}
+
+void RewindBuffer::Push(std::span<const uint8_t> snapshot, int64_t stamp) {
+  if (!current_.empty()) {
+    // XOR over the longer of both; the shorter one reads as zero-padded.
+    scratch_.assign(std::max(current_.size(), snapshot.size()), 0);
+    std::copy(current_.begin(), current_.end(), scratch_.begin());
+    for (std::size_t i = 0; i < snapshot.size(); ++i) scratch_[i] ^= snapshot[i];
+    Delta d{current_stamp_, current_.size(), LzCompress(scratch_)};
+    delta_bytes_ += d.packed.size();
+    deltas_.push_back(std::move(d));
+  }
+  current_.assign(snapshot.begin(), snapshot.end());
+  current_stamp_ = stamp;
+  Evict();
+}
+
+const std::vector<uint8_t>* RewindBuffer::StepBack() {
+  if (deltas_.empty()) return nullptr;
+  const Delta& d = deltas_.back();
+  scratch_.resize(std::max(current_.size(), d.size));
+  if (!LzDecompress(d.packed, scratch_)) {
+    Clear();
+    return nullptr;
+  }
+  current_.resize(scratch_.size(), 0);
+  for (std::size_t i = 0; i < current_.size(); ++i) current_[i] ^= scratch_[i];
+  current_.resize(d.size);
+  current_stamp_ = d.stamp;
+  delta_bytes_ -= d.packed.size();
+  deltas_.pop_back();
+  return &current_;
+}
+
+void RewindBuffer::Clear() {
+  deltas_.clear();
+  delta_bytes_ = 0;
+  current_.clear();
+  current_stamp_ = 0;
+}
+
+void RewindBuffer::Evict() {
+  while (!deltas_.empty() && MemoryBytes() > budget_) {
+    delta_bytes_ -= deltas_.front().packed.size();
+    deltas_.pop_front();
+  }
+}
+
+}
@@ -0,0 +1,49 @@
+#ifndef LINUXGUI_SERVICES_REWIND_BUFFER_H_
+#define LINUXGUI_SERVICES_REWIND_BUFFER_H_
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+namespace gui {
+// Memory-bounded history of snapshots. Only the newest snapshot is kept
+// in full; each older one is stored as the LZ-compressed XOR against its
+// successor. Stepping back is therefore one decompress and XOR, and
+// dropping the oldest entry to stay within budget costs nothing.
+class RewindBuffer {
+ public:
+  explicit RewindBuffer(std::size_t budget_bytes = 64u << 20) : budget_(budget_bytes) {}
+
+  void SetBudget(std::size_t bytes);
+  // `stamp` is an arbitrary caller-defined position, e.g. a CPU clock.
+  void Push(std::span<const uint8_t> snapshot, int64_t stamp);
+  // Restores the previous snapshot and makes it current. Returns nullptr
+  // once the history is exhausted.
+  const std::vector<uint8_t>* StepBack();
+  void Clear();
+
+  bool Empty() const { return current_.empty(); }
+  const std::vector<uint8_t>& Current() const { return current_; }
+  int64_t CurrentStamp() const { return current_stamp_; }
+  int64_t OldestStamp() const { return deltas_.empty() ? current_stamp_ : deltas_.front().stamp; }
+  std::size_t Depth() const { return deltas_.size(); }
+  std::size_t MemoryBytes() const { return current_.size() + delta_bytes_; }
+
+ private:
+  struct Delta {
+    int64_t stamp = 0;
+    std::size_t size = 0;  // size of the snapshot this delta restores
+    std::vector<uint8_t> packed;
+  };
+
+  void Evict();
+
+  std::size_t budget_;
+  std::deque<Delta> deltas_;  // oldest first
+  std::size_t delta_bytes_ = 0;
+  std::vector<uint8_t> current_;
+  int64_t current_stamp_ = 0;
+  std::vector<uint8_t> scratch_;
+};
+}
+#endif
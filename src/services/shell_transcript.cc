@@ -0,0 +1,50 @@
+#include "shell_transcript.h"
+
+namespace gui {
+
+std::size_t ShellTranscript::Update(std::string_view text) {
+  if (text == text_) return 0;
+
+  std::vector<std::size_t> offsets{0};
+  for (std::size_t i = text.find('\n'); i != std::string_view::npos; i = text.find('\n', i + 1)) {
+    offsets.push_back(i + 1);
+  }
+
+  // Both sides start and end on line boundaries, so equal bytes mean equal
+  // lines in the same order.
+  const std::string_view old_text(text_);
+  const std::size_t old_end = offsets_.back();
+  std::size_t dropped = offsets_.size() - 1;
+  for (std::size_t d = 0; d + 1 < offsets_.size(); ++d) {
+    const std::size_t length = old_end - offsets_[d];
+    if (length <= offsets.back() &&
+        text.substr(0, length) == old_text.substr(offsets_[d], length)) {
+      dropped = d;
+      break;
+    }
+  }
+
+  const uint64_t before = CompleteLines();
+  first_ += dropped;
+  text_.assign(text);
+  offsets_ = std::move(offsets);
+  return static_cast<std::size_t>(CompleteLines() - before);
+}
+
+void ShellTranscript::Reset() {
+  text_.clear();
+  offsets_.assign(1, 0);
+  first_ = 0;
+}
+
+std::string_view ShellTranscript::Line(uint64_t n) const {
+  if (n < first_ || n >= CompleteLines()) return {};
+  const auto i = static_cast<std::size_t>(n - first_);
+  return std::string_view(text_).substr(offsets_[i], offsets_[i + 1] - offsets_[i]);
+}
+
+std::string_view ShellTranscript::OpenLine() const {
+  return std::string_view(text_).substr(offsets_.back());
+}
+
+}
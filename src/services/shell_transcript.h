@@ -0,0 +1,39 @@
+#ifndef LINUXGUI_SERVICES_SHELL_TRANSCRIPT_H_
+#define LINUXGUI_SERVICES_SHELL_TRANSCRIPT_H_
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace gui {
+// Numbers the lines of the RetroShell buffer across calls. The core only
+// hands out the current text, which drops its oldest lines once it is full,
+// so every snapshot is lined up against the previous one: the smallest
+// number of dropped lines that makes all remaining old lines reappear at the
+// start of the new text wins. Matching the whole overlap keeps runs of
+// identical lines from being mistaken for each other; only a buffer that is
+// entirely periodic can hide how far it scrolled. Text that shares nothing
+// with the previous snapshot (cleared, other console) counts as all new.
+class ShellTranscript {
+ public:
+  // Takes the current shell text and returns how many lines it completed.
+  std::size_t Update(std::string_view text);
+  void Reset();
+
+  // Absolute number of the oldest line still in the buffer.
+  uint64_t FirstLine() const { return first_; }
+  // Absolute number of lines completed so far, i.e. one past the newest.
+  uint64_t CompleteLines() const { return first_ + offsets_.size() - 1; }
+  // Line `n` in [FirstLine(), CompleteLines()) including its newline.
+  std::string_view Line(uint64_t n) const;
+  // The unterminated last line, usually the prompt.
+  std::string_view OpenLine() const;
+
+ private:
+  std::string text_;
+  // Start of every complete line followed by the end of the last one.
+  std::vector<std::size_t> offsets_{0};
+  uint64_t first_ = 0;
+};
+}
+#endif
@@ -0,0 +1,333 @@
+#include "snapshot_library.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include "services/lz_codec.h"
+#include "services/snapshot_writer.h"
+
+namespace gui {
+
+namespace {
+constexpr uint32_t kMagic = 0x49534C56;  // "VLSI"
+constexpr uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 8;
+constexpr std::size_t kMinStaleForCompaction = 16;
+constexpr std::string_view kSnapshotExtension = ".vsn";
+
+enum class RecordType : uint8_t { kAdd = 1, kRemove = 2 };
+
+class ByteWriter {
+ public:
+  std::vector<uint8_t> bytes;
+  void Put(uint64_t value, int size) {
+    for (int i = 0; i < size; ++i) bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+  void PutString(std::string_view s) {
+    Put(s.size(), 2);
+    bytes.insert(bytes.end(), s.begin(), s.end());
+  }
+  void PutBlob(std::span<const uint8_t> blob) {
+    Put(blob.size(), 4);
+    bytes.insert(bytes.end(), blob.begin(), blob.end());
+  }
+};
+
+class ByteReader {
+ public:
+  explicit ByteReader(std::span<const uint8_t> data) : data_(data) {}
+  bool ok() const { return ok_; }
+  std::size_t left() const { return data_.size() - pos_; }
+  uint64_t Get(int size) {
+    if (!Need(size)) return 0;
+    uint64_t value = 0;
+    for (int i = 0; i < size; ++i) value |= static_cast<uint64_t>(data_[pos_++]) << (8 * i);
+    return value;
+  }
+  std::span<const uint8_t> Take(std::size_t size) {
+    if (!Need(size)) return {};
+    auto out = data_.subspan(pos_, size);
+    pos_ += size;
+    return out;
+  }
+  std::string GetString() {
+    const auto s = Take(Get(2));
+    return {s.begin(), s.end()};
+  }
+  std::vector<uint8_t> GetBlob() {
+    const auto s = Take(Get(4));
+    return {s.begin(), s.end()};
+  }
+
+ private:
+  bool Need(std::size_t size) {
+    if (ok_ && left() >= size) return true;
+    ok_ = false;
+    return false;
+  }
+  std::span<const uint8_t> data_;
+  std::size_t pos_ = 0;
+  bool ok_ = true;
+};
+
+// Record layout: type, payload size, payload.
+std::vector<uint8_t> MakeRecord(RecordType type, const std::vector<uint8_t>& payload) {
+  ByteWriter w;
+  w.Put(static_cast<uint8_t>(type), 1);
+  w.PutBlob(payload);
+  return std::move(w.bytes);
+}
+
+std::vector<uint8_t> AddRecord(const SnapshotLibrary::Entry& e) {
+  ByteWriter w;
+  w.PutString(e.file);
+  w.PutString(e.title);
+  w.Put(static_cast<uint64_t>(e.time), 8);
+  w.Put(e.bytes, 8);
+  w.PutBlob(e.thumbnail);
+  return MakeRecord(RecordType::kAdd, w.bytes);
+}
+
+std::vector<uint8_t> RemoveRecord(std::string_view file) {
+  ByteWriter w;
+  w.PutString(file);
+  return MakeRecord(RecordType::kRemove, w.bytes);
+}
+
+bool IsSnapshot(const std::filesystem::directory_entry& item) {
+  std::error_code ec;
+  return item.is_regular_file(ec) && item.path().extension() == kSnapshotExtension;
+}
+
+// An entry for a snapshot known only from the directory listing: it has no
+// title and no thumbnail until it is saved again.
+SnapshotLibrary::Entry ListedEntry(const std::filesystem::directory_entry& item) {
+  std::error_code ec;
+  SnapshotLibrary::Entry e;
+  e.file = item.path().filename().string();
+  e.bytes = item.file_size(ec);
+  const auto written = std::chrono::file_clock::to_sys(item.last_write_time(ec));
+  e.time = std::chrono::duration_cast<std::chrono::seconds>(written.time_since_epoch()).count();
+  return e;
+}
+
+std::vector<uint8_t> Header() {
+  ByteWriter w;
+  w.Put(kMagic, 4);
+  w.Put(kVersion, 4);
+  return std::move(w.bytes);
+}
+}  // namespace
+
+bool SnapshotLibrary::Open(const std::filesystem::path& dir) {
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (!std::filesystem::is_directory(dir, ec)) return false;
+  dir_ = dir;
+  entries_.clear();
+  stale_records_ = 0;
+  if (!Load()) {
+    Rebuild();
+  } else {
+    Reconcile();
+  }
+  return true;
+}
+
+bool SnapshotLibrary::Load() {
+  std::ifstream file(dir_ / kIndexName, std::ios::binary);
+  if (!file) return false;
+  const std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
+                                  std::istreambuf_iterator<char>()};
+  ByteReader r(data);
+  if (r.Get(4) != kMagic || r.Get(4) != kVersion || !r.ok()) return false;
+
+  bool truncated = false;
+  while (r.left() > 0) {
+    const auto type = static_cast<RecordType>(r.Get(1));
+    ByteReader payload(r.Take(r.Get(4)));
+    if (!r.ok()) {
+      // A crash while appending leaves a partial record behind.
+      truncated = true;
+      break;
+    }
+    if (type == RecordType::kAdd) {
+      Entry e;
+      e.file = payload.GetString();
+      e.title = payload.GetString();
+      e.time = static_cast<int64_t>(payload.Get(8));
+      e.bytes = payload.Get(8);
+      e.thumbnail = payload.GetBlob();
+      if (!payload.ok()) return false;
+      // A snapshot saved again under the same name replaces its entry, as
+      // in Add().
+      if (std::erase_if(entries_, [&](const Entry& x) { return x.file == e.file; }) > 0) {
+        ++stale_records_;
+      }
+      entries_.push_back(std::move(e));
+    } else if (type == RecordType::kRemove) {
+      const auto name = payload.GetString();
+      std::erase_if(entries_, [&](const Entry& e) { return e.file == name; });
+      stale_records_ += 2;
+    } else {
+      return false;
+    }
+  }
+  if (truncated) Compact();
+  return true;
+}
+
+void SnapshotLibrary::Rebuild() {
+  entries_.clear();
+  std::error_code ec;
+  for (const auto& item : std::filesystem::directory_iterator(dir_, ec)) {
+    if (IsSnapshot(item)) entries_.push_back(ListedEntry(item));
+  }
+  std::ranges::sort(entries_, {}, &Entry::time);
+  Compact();
+}
+
+void SnapshotLibrary::Reconcile() {
+  std::vector<std::filesystem::directory_entry> listed;
+  std::error_code ec;
+  for (const auto& item : std::filesystem::directory_iterator(dir_, ec)) {
+    if (IsSnapshot(item)) listed.push_back(item);
+  }
+  if (ec) return;
+  std::ranges::sort(listed, {}, [](const auto& item) { return item.path().filename(); });
+  auto listed_file = [&](const std::string& file) {
+    return std::ranges::binary_search(listed, std::filesystem::path(file), {},
+                                      [](const auto& item) { return item.path().filename(); });
+  };
+
+  // Snapshots deleted behind our back.
+  bool changed = std::erase_if(entries_, [&](const Entry& e) { return !listed_file(e.file); }) > 0;
+
+  // Snapshots whose save completed without reaching Add(), e.g. one the
+  // writer finished while the application was shutting down. They go in by
+  // modification time so that Trim() still deletes the oldest first.
+  std::vector<std::string> known;
+  known.reserve(entries_.size());
+  for (const auto& e : entries_) known.push_back(e.file);
+  std::ranges::sort(known);
+  for (const auto& item : listed) {
+    if (std::ranges::binary_search(known, item.path().filename().string())) continue;
+    Entry e = ListedEntry(item);
+    const auto pos =
+        std::ranges::find_if(entries_, [&](const Entry& x) { return x.time > e.time; });
+    entries_.insert(pos, std::move(e));
+    changed = true;
+  }
+  if (changed) Compact();
+}
+
+bool SnapshotLibrary::Append(const std::vector<uint8_t>& record) {
+  const auto path = dir_ / kIndexName;
+  std::error_code ec;
+  if (!std::filesystem::exists(path, ec)) return Compact();
+  std::ofstream file(path, std::ios::binary | std::ios::app);
+  file.write(reinterpret_cast<const char*>(record.data()),
+             static_cast<std::streamsize>(record.size()));
+  file.flush();
+  return static_cast<bool>(file);
+}
+
+bool SnapshotLibrary::Compact() {
+  auto data = Header();
+  for (const auto& e : entries_) {
+    const auto record = AddRecord(e);
+    data.insert(data.end(), record.begin(), record.end());
+  }
+  std::string error;
+  if (!SnapshotWriter::WriteAtomically(dir_ / kIndexName, data, error)) return false;
+  stale_records_ = 0;
+  return true;
+}
+
+bool SnapshotLibrary::Add(Entry entry) {
+  if (!IsOpen()) return false;
+  // Saving over an existing snapshot replaces its entry.
+  if (std::erase_if(entries_, [&](const Entry& e) { return e.file == entry.file; }) > 0) {
+    ++stale_records_;
+  }
+  const auto record = AddRecord(entry);
+  entries_.push_back(std::move(entry));
+  if (stale_records_ > entries_.size() && stale_records_ >= kMinStaleForCompaction) {
+    return Compact();
+  }
+  return Append(record);
+}
+
+bool SnapshotLibrary::Remove(std::string_view file) {
+  if (std::erase_if(entries_, [&](const Entry& e) { return e.file == file; }) == 0) return false;
+  std::error_code ec;
+  std::filesystem::remove(dir_ / file, ec);
+  stale_records_ += 2;
+  if (stale_records_ > entries_.size() && stale_records_ >= kMinStaleForCompaction) {
+    return Compact();
+  }
+  return Append(RemoveRecord(file));
+}
+
+std::size_t SnapshotLibrary::Trim(std::size_t limit) {
+  if (entries_.size() <= limit) return 0;
+  const std::size_t excess = entries_.size() - limit;
+  std::vector<uint8_t> records;
+  std::error_code ec;
+  for (std::size_t i = 0; i < excess; ++i) {
+    std::filesystem::remove(dir_ / entries_[i].file, ec);
+    const auto record = RemoveRecord(entries_[i].file);
+    records.insert(records.end(), record.begin(), record.end());
+  }
+  entries_.erase(entries_.begin(), entries_.begin() + static_cast<std::ptrdiff_t>(excess));
+  stale_records_ += 2 * excess;
+  if (stale_records_ > entries_.size() && stale_records_ >= kMinStaleForCompaction) {
+    Compact();
+  } else {
+    Append(records);
+  }
+  return excess;
+}
+
+std::vector<uint32_t> SnapshotLibrary::MakeThumbnail(std::span<const uint32_t> pixels, int width,
+                                                     int height) {
+  std::vector<uint32_t> thumb(static_cast<std::size_t>(kThumbWidth * kThumbHeight), 0);
+  if (width <= 0 || height <= 0 ||
+      pixels.size() < static_cast<std::size_t>(width) * static_cast<std::size_t>(height)) {
+    return thumb;
+  }
+  for (int ty = 0; ty < kThumbHeight; ++ty) {
+    const int y0 = ty * height / kThumbHeight;
+    const int y1 = std::max(y0 + 1, (ty + 1) * height / kThumbHeight);
+    for (int tx = 0; tx < kThumbWidth; ++tx) {
+      const int x0 = tx * width / kThumbWidth;
+      const int x1 = std::max(x0 + 1, (tx + 1) * width / kThumbWidth);
+      uint32_t sum[4] = {};
+      for (int y = y0; y < y1; ++y) {
+        const uint32_t* row = pixels.data() + static_cast<std::size_t>(y) * width;
+        for (int x = x0; x < x1; ++x) {
+          for (int c = 0; c < 4; ++c) sum[c] += (row[x] >> (8 * c)) & 0xFF;
+        }
+      }
+      const uint32_t n = static_cast<uint32_t>((y1 - y0) * (x1 - x0));
+      uint32_t out = 0;
+      for (int c = 0; c < 4; ++c) out |= (sum[c] / n) << (8 * c);
+      thumb[static_cast<std::size_t>(ty * kThumbWidth + tx)] = out;
+    }
+  }
+  return thumb;
+}
+
+std::vector<uint8_t> SnapshotLibrary::PackThumbnail(std::span<const uint32_t> thumbnail) {
+  return LzCompress({reinterpret_cast<const uint8_t*>(thumbnail.data()), thumbnail.size_bytes()});
+}
+
+bool SnapshotLibrary::UnpackThumbnail(std::span<const uint8_t> packed,
+                                      std::vector<uint32_t>& thumbnail) {
+  if (packed.empty()) return false;
+  thumbnail.resize(static_cast<std::size_t>(kThumbWidth * kThumbHeight));
+  return LzDecompress(packed, {reinterpret_cast<uint8_t*>(thumbnail.data()),
+                               thumbnail.size() * sizeof(uint32_t)});
+}
+
+}
@@ -0,0 +1,67 @@
+#ifndef LINUXGUI_SERVICES_SNAPSHOT_LIBRARY_H_
+#define LINUXGUI_SERVICES_SNAPSHOT_LIBRARY_H_
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace gui {
+// Catalogue of the snapshots in one directory. Metadata and a pre-scaled
+// thumbnail of every snapshot live in an append-only index file, so the
+// library opens without touching a single snapshot. Adding or removing a
+// snapshot appends one record; the index is rewritten only once more than
+// half of it is stale.
+class SnapshotLibrary {
+ public:
+  struct Entry {
+    std::string file;   // relative to the library directory
+    std::string title;  // e.g. the disk in df0
+    int64_t time = 0;   // seconds since the epoch
+    uint64_t bytes = 0;
+    std::vector<uint8_t> thumbnail;  // packed, see UnpackThumbnail()
+  };
+
+  static constexpr int kThumbWidth = 96;
+  static constexpr int kThumbHeight = 64;
+  static constexpr std::string_view kIndexName = "index.vsi";
+
+  // Loads the index, or rebuilds it from the directory listing if it is
+  // missing or unreadable. A loaded index is checked against the listing:
+  // entries of deleted files are dropped and snapshots missing from the
+  // index are added without a thumbnail.
+  bool Open(const std::filesystem::path& dir);
+  bool IsOpen() const { return !dir_.empty(); }
+  const std::filesystem::path& Dir() const { return dir_; }
+  // Oldest first.
+  const std::vector<Entry>& Entries() const { return entries_; }
+  std::filesystem::path PathOf(const Entry& entry) const { return dir_ / entry.file; }
+
+  // Registers a snapshot that has already been written to the directory.
+  bool Add(Entry entry);
+  // Deletes the snapshot file and its entry.
+  bool Remove(std::string_view file);
+  // Deletes the oldest snapshots until at most `limit` remain. Returns the
+  // number of snapshots deleted.
+  std::size_t Trim(std::size_t limit);
+
+  // Box-filters an RGBA frame down to kThumbWidth x kThumbHeight.
+  static std::vector<uint32_t> MakeThumbnail(std::span<const uint32_t> pixels, int width,
+                                             int height);
+  static std::vector<uint8_t> PackThumbnail(std::span<const uint32_t> thumbnail);
+  static bool UnpackThumbnail(std::span<const uint8_t> packed, std::vector<uint32_t>& thumbnail);
+
+ private:
+  bool Load();
+  void Rebuild();
+  void Reconcile();
+  bool Append(const std::vector<uint8_t>& record);
+  bool Compact();
+
+  std::filesystem::path dir_;
+  std::vector<Entry> entries_;
+  std::size_t stale_records_ = 0;
+};
+}
+#endif
@@ -0,0 +1,28 @@
+#include "snapshot_slots.h"
+
+namespace gui {
+
+void SnapshotSlots::Reserve(std::size_t bytes) {
+  if (bytes <= capacity_) return;
+  capacity_ = bytes;
+  for (auto& slot : slots_) slot.data.reserve(bytes);
+}
+
+bool SnapshotSlots::Store(int slot, std::span<const uint8_t> snapshot, int64_t time) {
+  if (!IsValid(slot) || snapshot.empty()) return false;
+  // Snapshots grow with the memory configuration; leave room so that the
+  // next few do not reallocate.
+  if (snapshot.size() > capacity_) Reserve(snapshot.size() + snapshot.size() / 4);
+  slots_[slot].data.assign(snapshot.begin(), snapshot.end());
+  slots_[slot].time = time;
+  return true;
+}
+
+void SnapshotSlots::Clear(int slot) {
+  if (!IsValid(slot)) return;
+  // clear() keeps the capacity.
+  slots_[slot].data.clear();
+  slots_[slot].time = 0;
+}
+
+}
@@ -0,0 +1,36 @@
+#ifndef LINUXGUI_SERVICES_SNAPSHOT_SLOTS_H_
+#define LINUXGUI_SERVICES_SNAPSHOT_SLOTS_H_
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+namespace gui {
+// Quick-save slots held in memory. Slot buffers are allocated once, with
+// headroom, and then reused, so storing a snapshot is a single copy into
+// memory that is already there.
+class SnapshotSlots {
+ public:
+  static constexpr int kCount = 10;
+
+  // Gives every slot room for `bytes`; buffers never shrink.
+  void Reserve(std::size_t bytes);
+  bool Store(int slot, std::span<const uint8_t> snapshot, int64_t time);
+  void Clear(int slot);
+
+  bool IsValid(int slot) const { return slot >= 0 && slot < kCount; }
+  bool Empty(int slot) const { return !IsValid(slot) || slots_[slot].data.empty(); }
+  const std::vector<uint8_t>& Data(int slot) const { return slots_[slot].data; }
+  int64_t Time(int slot) const { return slots_[slot].time; }
+  std::size_t Capacity() const { return capacity_; }
+
+ private:
+  struct Slot {
+    std::vector<uint8_t> data;
+    int64_t time = 0;
+  };
+  std::array<Slot, kCount> slots_;
+  std::size_t capacity_ = 0;
+};
+}
+#endif
@@ -0,0 +1,154 @@
+#include "snapshot_writer.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include "services/chunk_store.h"
+#include "services/lz_codec.h"
+
+namespace gui {
+
+namespace {
+constexpr std::size_t kHeaderSize = 12;  // magic + 64-bit raw size
+constexpr uint64_t kMaxRawSize = 1ULL << 30;
+
+bool WriteAll(int fd, std::span<const uint8_t> data) {
+  while (!data.empty()) {
+    const ssize_t n = ::write(fd, data.data(), data.size());
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data = data.subspan(static_cast<std::size_t>(n));
+  }
+  return true;
+}
+}  // namespace
+
+SnapshotWriter::~SnapshotWriter() {
+  if (!worker_.joinable()) return;
+  // Queued saves are still written; only then does the worker exit.
+  stop_ = true;
+  queued_.fetch_add(1, std::memory_order_release);
+  queued_.notify_one();
+  worker_.join();
+}
+
+bool SnapshotWriter::Submit(std::vector<uint8_t> snapshot, std::filesystem::path path,
+                            Format format, Callback done) {
+  if (format == Format::kChunked && !chunk_store_) return false;
+  // Undelivered results occupy the result queue, so in_flight_ must never
+  // exceed its capacity.
+  if (in_flight_ >= static_cast<int>(kQueueSize)) return false;
+  if (!worker_.joinable()) worker_ = std::thread(&SnapshotWriter::Run, this);
+  if (!jobs_.Push({std::move(snapshot), std::move(path), format, std::move(done)})) return false;
+  ++in_flight_;
+  if (queued_.fetch_add(1, std::memory_order_release) == 0) queued_.notify_one();
+  return true;
+}
+
+void SnapshotWriter::DeliverResults() {
+  Done done;
+  while (results_.Pop(done)) {
+    --in_flight_;
+    if (done.done) done.done(done.result);
+  }
+}
+
+void SnapshotWriter::Run() {
+  Job job;
+  for (;;) {
+    queued_.wait(0, std::memory_order_acquire);
+    int32_t popped = 0;
+    while (jobs_.Pop(job)) {
+      ++popped;
+      const auto start = std::chrono::steady_clock::now();
+      Done done;
+      done.result.path = job.path;
+      if (job.format == Format::kChunked) {
+        ChunkStore::WriteStats stats;
+        done.result.ok = chunk_store_->Write(job.snapshot, job.path, done.result.error, &stats);
+        done.result.bytes = stats.manifest_bytes + stats.new_bytes;
+      } else {
+        const auto packed = job.format == Format::kPacked ? Pack(job.snapshot) : std::vector<uint8_t>();
+        const std::span<const uint8_t> data = job.format == Format::kPacked
+                                                  ? std::span<const uint8_t>(packed)
+                                                  : std::span<const uint8_t>(job.snapshot);
+        done.result.ok = WriteAtomically(job.path, data, done.result.error);
+        done.result.bytes = data.size();
+      }
+      done.result.ms = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start).count();
+      done.done = std::move(job.done);
+      // Submit() keeps at most kQueueSize saves undelivered, so the result
+      // queue has room. Never drop a result: its callback would be lost and
+      // Pending() would never reach zero.
+      while (!results_.Push(done)) std::this_thread::yield();
+      job = {};
+    }
+    if (popped > 0) queued_.fetch_sub(popped, std::memory_order_acq_rel);
+    if (stop_ && jobs_.Empty()) break;
+  }
+}
+
+std::vector<uint8_t> SnapshotWriter::Pack(std::span<const uint8_t> snapshot) {
+  std::vector<uint8_t> out(kHeaderSize);
+  const uint64_t size = snapshot.size();
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(kPackedMagic >> (8 * i));
+  for (int i = 0; i < 8; ++i) out[4 + i] = static_cast<uint8_t>(size >> (8 * i));
+  const auto body = LzCompress(snapshot);
+  out.insert(out.end(), body.begin(), body.end());
+  return out;
+}
+
+bool SnapshotWriter::IsPacked(std::span<const uint8_t> data) {
+  if (data.size() < kHeaderSize) return false;
+  uint32_t magic = 0;
+  for (int i = 0; i < 4; ++i) magic |= static_cast<uint32_t>(data[i]) << (8 * i);
+  return magic == kPackedMagic;
+}
+
+bool SnapshotWriter::Unpack(std::span<const uint8_t> data, std::vector<uint8_t>& snapshot) {
+  if (!IsPacked(data)) return false;
+  uint64_t size = 0;
+  for (int i = 0; i < 8; ++i) size |= static_cast<uint64_t>(data[4 + i]) << (8 * i);
+  if (size > kMaxRawSize) return false;
+  snapshot.resize(size);
+  return LzDecompress(data.subspan(kHeaderSize), snapshot);
+}
+
+bool SnapshotWriter::WriteAtomically(const std::filesystem::path& path,
+                                     std::span<const uint8_t> data, std::string& error) {
+  auto tmp = path;
+  tmp += ".part";
+  const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    error = std::strerror(errno);
+    return false;
+  }
+  bool ok = WriteAll(fd, data) && ::fsync(fd) == 0;
+  if (!ok) error = std::strerror(errno);
+  if (::close(fd) != 0 && ok) {
+    error = std::strerror(errno);
+    ok = false;
+  }
+  if (ok && ::rename(tmp.c_str(), path.c_str()) != 0) {
+    error = std::strerror(errno);
+    ok = false;
+  }
+  if (!ok) {
+    ::unlink(tmp.c_str());
+    return false;
+  }
+  // Make the rename itself durable.
+  const auto dir = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+  const int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd >= 0) {
+    ::fsync(dir_fd);
+    ::close(dir_fd);
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,86 @@
+#ifndef LINUXGUI_SERVICES_SNAPSHOT_WRITER_H_
+#define LINUXGUI_SERVICES_SNAPSHOT_WRITER_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "services/spsc_queue.h"
+namespace gui {
+class ChunkStore;
+
+// Writes snapshot images on a worker thread. The GUI thread hands over an
+// in-memory copy and returns immediately; the worker optionally packs it,
+// writes it to a temporary file, fsyncs and renames it into place, so a
+// crash never leaves a half-written snapshot behind. Submit() and
+// DeliverResults() must be called from the same thread.
+class SnapshotWriter {
+ public:
+  enum class Format : uint8_t {
+    kRaw,      // a plain vAmiga snapshot
+    kPacked,   // LZ container, see Pack()
+    kChunked,  // a manifest into the chunk store
+  };
+  struct Result {
+    std::filesystem::path path;
+    bool ok = false;
+    std::string error;
+    std::size_t bytes = 0;  // as written to disk
+    double ms = 0.0;        // time spent on the worker
+  };
+  using Callback = std::function<void(const Result&)>;
+
+  static constexpr std::size_t kQueueSize = 16;
+  static constexpr uint32_t kPackedMagic = 0x4E535A56;  // "VZSN"
+
+  SnapshotWriter() = default;
+  ~SnapshotWriter();
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+  // Returns false if kQueueSize saves are already submitted but not yet
+  // delivered.
+  bool Submit(std::vector<uint8_t> snapshot, std::filesystem::path path, Format format,
+              Callback done = {});
+  // Required for Format::kChunked. Set it before the first Submit().
+  void SetChunkStore(ChunkStore* store) { chunk_store_ = store; }
+  // Runs the callbacks of finished jobs. Call once per frame.
+  void DeliverResults();
+  // Saves submitted but not yet delivered.
+  int Pending() const { return in_flight_; }
+
+  // LZ container for snapshots; only this frontend can read it.
+  static std::vector<uint8_t> Pack(std::span<const uint8_t> snapshot);
+  static bool IsPacked(std::span<const uint8_t> data);
+  static bool Unpack(std::span<const uint8_t> data, std::vector<uint8_t>& snapshot);
+  static bool WriteAtomically(const std::filesystem::path& path, std::span<const uint8_t> data,
+                              std::string& error);
+
+ private:
+  struct Job {
+    std::vector<uint8_t> snapshot;
+    std::filesystem::path path;
+    Format format = Format::kRaw;
+    Callback done;
+  };
+  struct Done {
+    Result result;
+    Callback done;
+  };
+
+  void Run();
+
+  SpscQueue<Job, kQueueSize> jobs_;
+  SpscQueue<Done, kQueueSize> results_;
+  std::atomic<int32_t> queued_ = 0;
+  std::atomic<bool> stop_ = false;
+  std::thread worker_;
+  ChunkStore* chunk_store_ = nullptr;
+  int in_flight_ = 0;
+};
+}
+#endif
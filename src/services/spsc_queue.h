@@ -0,0 +1,67 @@
+#ifndef LINUXGUI_SERVICES_SPSC_QUEUE_H_
+#define LINUXGUI_SERVICES_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace gui {
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// Push and Pop never block; a full queue rejects the element.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+  static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+ public:
+  SpscQueue() : slots_(Capacity) {}
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Producer side.
+  bool Push(T value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ == Capacity) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ == Capacity) return false;
+    }
+    slots_[tail & kMask] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side.
+  bool Pop(T& out) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) return false;
+    }
+    out = std::move(slots_[head & kMask]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when called concurrently.
+  std::size_t Size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+  bool Empty() const { return Size() == 0; }
+
+ private:
+  static constexpr std::size_t kMask = Capacity - 1;
+  static constexpr std::size_t kLine = 64;
+
+  std::vector<T> slots_;
+  alignas(kLine) std::atomic<std::size_t> head_{0};
+  std::size_t tail_cache_ = 0;
+  alignas(kLine) std::atomic<std::size_t> tail_{0};
+  std::size_t head_cache_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "vcd_writer.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+
+namespace gui {
+
+namespace {
+std::string IdentifierFor(std::size_t index) {
+  std::string id;
+  do {
+    id.push_back(static_cast<char>('!' + index % 94));
+    index /= 94;
+  } while (index > 0);
+  return id;
+}
+
+void AppendNumber(std::string& out, uint64_t value) {
+  std::array<char, 24> buf{};
+  auto [ptr, _] = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+  out.append(buf.data(), ptr);
+}
+}  // namespace
+
+VcdWriter::~VcdWriter() { Close(); }
+
+bool VcdWriter::Open(const std::filesystem::path& path,
+                     std::vector<Signal> signals, std::string_view timescale,
+                     std::string_view scope) {
+  Close();
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) return false;
+
+  signals_ = std::move(signals);
+  stride_ = signals_.size() + 1;
+  pending_.clear();
+  pending_.reserve(kChunkSamples * stride_);
+  last_values_.assign(signals_.size(), 0);
+  have_last_ = false;
+  last_time_ = 0;
+  samples_queued_ = 0;
+  bytes_written_ = 0;
+  overflowed_ = false;
+  stop_ = false;
+  WriteHeader(timescale, scope);
+
+  open_ = true;
+  worker_ = std::thread(&VcdWriter::Run, this);
+  return true;
+}
+
+void VcdWriter::WriteHeader(std::string_view timescale, std::string_view scope) {
+  std::string out;
+  out += "$version vAmiga logic analyzer $end\n";
+  out += "$timescale ";
+  out += timescale;
+  out += " $end\n$scope module ";
+  out += scope;
+  out += " $end\n";
+  for (std::size_t i = 0; i < signals_.size(); ++i) {
+    out += "$var wire ";
+    AppendNumber(out, static_cast<uint64_t>(signals_[i].width));
+    out += ' ';
+    out += IdentifierFor(i);
+    out += ' ';
+    out += signals_[i].name;
+    out += " $end\n";
+  }
+  out += "$upscope $end\n$enddefinitions $end\n";
+  file_.write(out.data(), static_cast<std::streamsize>(out.size()));
+  bytes_written_ += out.size();
+}
+
+void VcdWriter::Sample(uint64_t time, std::span<const uint64_t> values) {
+  if (!open_ || overflowed_) return;
+  pending_.push_back(time);
+  for (std::size_t i = 0; i + 1 < stride_; ++i) {
+    pending_.push_back(i < values.size() ? values[i] : kUnknown);
+  }
+  samples_queued_++;
+  if (pending_.size() >= kChunkSamples * stride_) Submit();
+}
+
+void VcdWriter::Submit() {
+  if (pending_.empty()) return;
+  std::vector<uint64_t> next;
+  {
+    std::lock_guard lock(mutex_);
+    if (queue_.size() >= kMaxQueuedChunks) {
+      // A gap in the middle of the file would be invisible; end it here.
+      overflowed_ = true;
+      pending_.clear();
+      return;
+    }
+    queue_.push_back(std::move(pending_));
+    if (!spare_.empty()) {
+      next = std::move(spare_.back());
+      spare_.pop_back();
+    }
+  }
+  cv_.notify_one();
+  next.clear();
+  next.reserve(kChunkSamples * stride_);
+  pending_ = std::move(next);
+}
+
+void VcdWriter::Close() {
+  if (!open_) return;
+  Submit();
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  if (worker_.joinable()) worker_.join();
+  file_.close();
+  queue_.clear();
+  spare_.clear();
+  open_ = false;
+}
+
+void VcdWriter::Run() {
+  std::string out;
+  for (;;) {
+    std::vector<uint64_t> chunk;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      chunk = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    out.clear();
+    Format(chunk, out);
+    file_.write(out.data(), static_cast<std::streamsize>(out.size()));
+    bytes_written_ += out.size();
+    {
+      std::lock_guard lock(mutex_);
+      spare_.push_back(std::move(chunk));
+    }
+  }
+}
+
+void VcdWriter::AppendValue(std::string& out, std::size_t signal,
+                            uint64_t value) const {
+  const int width = signals_[signal].width;
+  if (width == 1) {
+    out += value == kUnknown ? 'x' : (value & 1 ? '1' : '0');
+  } else {
+    out += 'b';
+    if (value == kUnknown) {
+      out += 'x';
+    } else {
+      if (width < 64) value &= (uint64_t{1} << width) - 1;
+      int bits = std::max(1, static_cast<int>(std::bit_width(value)));
+      for (int b = bits - 1; b >= 0; --b) out += (value >> b) & 1 ? '1' : '0';
+    }
+    out += ' ';
+  }
+  out += IdentifierFor(signal);
+  out += '\n';
+}
+
+void VcdWriter::Format(const std::vector<uint64_t>& chunk, std::string& out) {
+  const std::size_t count = signals_.size();
+  for (std::size_t pos = 0; pos + stride_ <= chunk.size(); pos += stride_) {
+    const uint64_t time = chunk[pos];
+    const uint64_t* values = chunk.data() + pos + 1;
+    if (!have_last_) {
+      out += '#';
+      AppendNumber(out, time);
+      out += "\n$dumpvars\n";
+      for (std::size_t i = 0; i < count; ++i) AppendValue(out, i, values[i]);
+      out += "$end\n";
+      std::copy(values, values + count, last_values_.begin());
+      have_last_ = true;
+      last_time_ = time;
+      continue;
+    }
+    if (time < last_time_) continue;
+    bool stamped = false;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (values[i] == last_values_[i]) continue;
+      if (!stamped) {
+        out += '#';
+        AppendNumber(out, time);
+        out += '\n';
+        stamped = true;
+      }
+      AppendValue(out, i, values[i]);
+      last_values_[i] = values[i];
+    }
+    last_time_ = time;
+  }
+}
+
+}
@@ -0,0 +1,75 @@
+#ifndef LINUXGUI_SERVICES_VCD_WRITER_H_
+#define LINUXGUI_SERVICES_VCD_WRITER_H_
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+namespace gui {
+// Streams samples into a Value Change Dump file. Sample() only appends to
+// an in-memory chunk; formatting, change detection and file I/O happen on
+// a writer thread. If the writer falls kMaxQueuedChunks chunks behind, the
+// writer stops taking samples and Overflowed() turns true; the file ends
+// at the last chunk that made it into the queue.
+class VcdWriter {
+ public:
+  struct Signal {
+    std::string name;
+    int width = 1;
+  };
+  static constexpr uint64_t kUnknown = std::numeric_limits<uint64_t>::max();
+  static constexpr std::size_t kChunkSamples = 4096;
+  static constexpr std::size_t kMaxQueuedChunks = 64;
+
+  VcdWriter() = default;
+  ~VcdWriter();
+  VcdWriter(const VcdWriter&) = delete;
+  VcdWriter& operator=(const VcdWriter&) = delete;
+
+  bool Open(const std::filesystem::path& path, std::vector<Signal> signals,
+            std::string_view timescale = "1 ns",
+            std::string_view scope = "top");
+  void Sample(uint64_t time, std::span<const uint64_t> values);
+  void Close();
+  bool IsOpen() const { return open_; }
+  bool Overflowed() const { return overflowed_; }
+  uint64_t SamplesQueued() const { return samples_queued_; }
+  uint64_t BytesWritten() const { return bytes_written_.load(); }
+
+ private:
+  void Run();
+  void Submit();
+  void WriteHeader(std::string_view timescale, std::string_view scope);
+  void Format(const std::vector<uint64_t>& chunk, std::string& out);
+  void AppendValue(std::string& out, std::size_t signal, uint64_t value) const;
+
+  std::ofstream file_;
+  std::vector<Signal> signals_;
+  std::size_t stride_ = 0;
+  bool open_ = false;
+  bool overflowed_ = false;
+  uint64_t samples_queued_ = 0;
+  std::vector<uint64_t> pending_;
+
+  std::thread worker_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::vector<uint64_t>> queue_;
+  std::vector<std::vector<uint64_t>> spare_;
+  bool stop_ = false;
+
+  std::vector<uint64_t> last_values_;
+  bool have_last_ = false;
+  uint64_t last_time_ = 0;
+  std::atomic<uint64_t> bytes_written_ = 0;
+};
+}
+#endif
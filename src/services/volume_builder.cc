@@ -0,0 +1,454 @@
+#include "volume_builder.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <map>
+
+namespace gui {
+
+namespace {
+constexpr uint32_t kReserved = 2;
+constexpr uint32_t kTypeHeader = 2;
+constexpr uint32_t kTypeList = 16;
+constexpr uint32_t kTypeData = 8;
+constexpr uint32_t kSecRoot = 1;
+constexpr uint32_t kSecUserDir = 2;
+constexpr uint32_t kSecFile = static_cast<uint32_t>(-3);
+constexpr uint32_t kBitmapPages = 25;
+constexpr std::size_t kOfsDataOffset = 24;
+constexpr std::size_t kMaxNameLength = 30;
+constexpr int kMaxDepth = 64;
+// 1978-01-01, the AmigaDOS epoch, in Unix time.
+constexpr int64_t kAmigaEpoch = 252460800;
+
+// The AmigaDOS 1.3 boot block: find dos.library's resident init and
+// return it in a0. Runs on every Kickstart.
+constexpr std::array<uint8_t, 38> kBootCode = {
+    0x43, 0xFA, 0x00, 0x18, 0x4E, 0xAE, 0xFF, 0xA0, 0x4A, 0x80, 0x67, 0x0A, 0x20,
+    0x40, 0x20, 0x68, 0x00, 0x16, 0x70, 0x00, 0x4E, 0x75, 0x70, 0xFF, 0x60, 0xFA,
+    'd',  'o',  's',  '.',  'l',  'i',  'b',  'r',  'a',  'r',  'y',  0x00};
+
+std::string AmigaName(const std::string& host) {
+  std::string name = host.substr(0, kMaxNameLength);
+  std::ranges::replace(name, ':', '_');
+  return name;
+}
+
+bool SameName(std::string_view a, std::string_view b) {
+  return std::ranges::equal(a, b, [](char x, char y) {
+    return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+  });
+}
+
+// Orders names the way SameName() compares them, so clashes end up next
+// to each other; ties fall back to the bytes to stay deterministic.
+bool NameLess(std::string_view a, std::string_view b) {
+  const auto upper = [](char c) { return std::toupper(static_cast<unsigned char>(c)); };
+  if (!SameName(a, b)) {
+    return std::ranges::lexicographical_compare(a, b, {}, upper, upper);
+  }
+  return a < b;
+}
+
+int64_t UnixTime(const std::filesystem::path& path) {
+  std::error_code ec;
+  const auto time = std::filesystem::last_write_time(path, ec);
+  if (ec) return 0;
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::file_clock::to_sys(time).time_since_epoch())
+      .count();
+}
+}  // namespace
+
+class VolumeBuilder::Writer {
+ public:
+  Writer(const Options& options, std::vector<uint8_t>& image) : Writer(options) {
+    image_ = &image;
+    image_->assign(static_cast<std::size_t>(num_blocks_) * block_size_, 0);
+  }
+
+  // Keeps only the blocks that are written to.
+  Writer(const Options& options, std::map<uint32_t, std::vector<uint8_t>>& blocks) : Writer(options) {
+    sparse_ = &blocks;
+    sparse_->clear();
+  }
+
+  uint8_t* At(uint32_t nr) {
+    if (image_) return image_->data() + static_cast<std::size_t>(nr) * block_size_;
+    auto& block = (*sparse_)[nr];
+    if (block.empty()) block.assign(block_size_, 0);
+    return block.data();
+  }
+
+  uint32_t Get(uint32_t nr, uint32_t index) {
+    const uint8_t* p = At(nr) + index * 4;
+    return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+  }
+
+  void Put(uint32_t nr, uint32_t index, uint32_t value) {
+    uint8_t* p = At(nr) + index * 4;
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+  }
+
+  void Claim(uint32_t nr) { used_[nr] = true; }
+
+  // Walks forward from the root and wraps around to the first block
+  // after the boot block, the way AmigaDOS allocates.
+  uint32_t Next() {
+    while (used_[cursor_]) Advance();
+    const uint32_t nr = cursor_;
+    used_[nr] = true;
+    Advance();
+    return nr;
+  }
+
+  void StartAt(uint32_t nr) { cursor_ = nr; }
+
+  void SetDate(uint32_t nr, uint32_t index, int64_t unix_time) {
+    const int64_t seconds = std::max<int64_t>(unix_time - kAmigaEpoch, 0);
+    Put(nr, index, static_cast<uint32_t>(seconds / 86400));
+    Put(nr, index + 1, static_cast<uint32_t>(seconds % 86400 / 60));
+    Put(nr, index + 2, static_cast<uint32_t>(seconds % 60 * 50));
+  }
+
+  void SetName(uint32_t nr, const std::string& name) {
+    uint8_t* p = At(nr) + block_size_ - 80;
+    p[0] = static_cast<uint8_t>(name.size());
+    std::ranges::copy(name, p + 1);
+  }
+
+  // Header blocks of directories and files.
+  void Header(uint32_t nr, uint32_t sec_type, const Node& node, uint32_t parent) {
+    Put(nr, 0, kTypeHeader);
+    Put(nr, 1, nr);
+    SetDate(nr, longs_ - 23, node.time);
+    SetName(nr, node.name);
+    Put(nr, longs_ - 3, parent);
+    Put(nr, longs_ - 1, sec_type);
+    Checked(nr);
+    const uint32_t slot = 6 + Hash(node.name, table_size_);
+    Put(nr, longs_ - 4, Get(parent, slot));
+    Put(parent, slot, nr);
+  }
+
+  bool Directory(const Node& dir, uint32_t block, std::string& error) {
+    for (const auto& child : dir.children) {
+      const uint32_t nr = Next();
+      if (child.is_dir) {
+        Header(nr, kSecUserDir, child, block);
+        if (!Directory(child, nr, error)) return false;
+      } else if (!File(child, nr, block, error)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Header, then the data blocks in order, with each extension block
+  // placed just before the data it points to.
+  bool File(const Node& file, uint32_t header, uint32_t parent, std::string& error) {
+    Header(header, kSecFile, file, parent);
+    Put(header, longs_ - 47, static_cast<uint32_t>(file.size));
+    std::ifstream in(file.host, std::ios::binary);
+    if (!in) {
+      error = "cannot read " + file.host.string();
+      return false;
+    }
+    const std::size_t payload = ffs_ ? block_size_ : block_size_ - kOfsDataOffset;
+    uint64_t remaining = file.size;
+    uint32_t table = header, used = 0, previous = 0, seq = 1;
+    while (remaining > 0) {
+      if (used == table_size_) {
+        const uint32_t list = Next();
+        Put(list, 0, kTypeList);
+        Put(list, 1, list);
+        Put(list, longs_ - 3, header);
+        Put(list, longs_ - 1, kSecFile);
+        Checked(list);
+        Put(table, longs_ - 2, list);
+        table = list;
+        used = 0;
+      }
+      const uint32_t data = Next();
+      const auto n = static_cast<std::size_t>(std::min<uint64_t>(payload, remaining));
+      if (!ffs_) {
+        Put(data, 0, kTypeData);
+        Put(data, 1, header);
+        Put(data, 2, seq);
+        Put(data, 3, static_cast<uint32_t>(n));
+        if (previous != 0) Put(previous, 4, data);
+        Checked(data);
+      }
+      in.read(reinterpret_cast<char*>(At(data)) + (ffs_ ? 0 : kOfsDataOffset),
+              static_cast<std::streamsize>(n));
+      if (static_cast<std::size_t>(in.gcount()) != n) {
+        error = file.host.string() + " changed while importing";
+        return false;
+      }
+      Put(table, 6 + table_size_ - 1 - used, data);
+      Put(table, 2, ++used);
+      if (seq == 1) Put(header, 4, data);
+      previous = data;
+      ++seq;
+      remaining -= n;
+    }
+    return true;
+  }
+
+  // A set bit marks a free block; bit 0 of the first map is block 2.
+  void Bitmaps(const std::vector<uint32_t>& pages) {
+    const uint32_t bits = (longs_ - 1) * 32;
+    for (std::size_t k = 0; k < pages.size(); ++k) {
+      const uint32_t nr = pages[k];
+      uint32_t sum = 0;
+      for (uint32_t word = 0; word + 1 < longs_; ++word) {
+        uint32_t value = 0;
+        for (uint32_t bit = 0; bit < 32; ++bit) {
+          const uint64_t block = uint64_t{kReserved} + k * bits + word * 32 + bit;
+          if (block < num_blocks_ && !used_[block]) value |= 1u << bit;
+        }
+        Put(nr, 1 + word, value);
+        sum += value;
+      }
+      Put(nr, 0, ~sum + 1);
+    }
+  }
+
+  void Checksums() {
+    for (const uint32_t nr : checked_) {
+      uint32_t sum = 0;
+      Put(nr, 5, 0);
+      for (uint32_t i = 0; i < longs_; ++i) sum += Get(nr, i);
+      Put(nr, 5, ~sum + 1);
+    }
+  }
+
+  void Checked(uint32_t nr) { checked_.push_back(nr); }
+
+  uint32_t Longs() const { return longs_; }
+  uint32_t TableSize() const { return table_size_; }
+
+ private:
+  explicit Writer(const Options& options)
+      : num_blocks_(options.num_blocks),
+        block_size_(options.block_size),
+        longs_(options.block_size / 4),
+        table_size_(longs_ - 56),
+        ffs_(options.ffs),
+        used_(options.num_blocks, false) {
+    used_[0] = used_[1] = true;
+  }
+
+  void Advance() {
+    if (++cursor_ == num_blocks_) cursor_ = kReserved;
+  }
+
+  std::vector<uint8_t>* image_ = nullptr;
+  std::map<uint32_t, std::vector<uint8_t>>* sparse_ = nullptr;
+  uint32_t num_blocks_;
+  uint32_t block_size_;
+  uint32_t longs_;
+  uint32_t table_size_;
+  bool ffs_;
+  std::vector<bool> used_;
+  std::vector<uint32_t> checked_;
+  uint32_t cursor_ = kReserved;
+};
+
+uint32_t VolumeBuilder::Hash(std::string_view name, uint32_t table_size) {
+  uint32_t hash = static_cast<uint32_t>(name.size());
+  for (const char c : name) {
+    hash = (hash * 13 + static_cast<uint32_t>(std::toupper(static_cast<unsigned char>(c)))) & 0x7FF;
+  }
+  return hash % table_size;
+}
+
+bool VolumeBuilder::Scan(const std::filesystem::path& source, std::string& error) {
+  root_ = {};
+  stats_ = {};
+  std::error_code ec;
+  if (!std::filesystem::is_directory(source, ec)) {
+    error = source.string() + " is not a directory";
+    return false;
+  }
+  root_.host = source;
+  root_.is_dir = true;
+  root_.time = UnixTime(source);
+  return ScanDirectory(root_, 0, error);
+}
+
+bool VolumeBuilder::ScanDirectory(Node& dir, int depth, std::string& error) {
+  if (depth > kMaxDepth) {
+    error = dir.host.string() + " is nested too deeply";
+    return false;
+  }
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir.host, ec)) {
+    // Linked directories could loop back on themselves.
+    const bool is_dir = entry.is_directory(ec) && !entry.is_symlink(ec);
+    if (!is_dir && !entry.is_regular_file(ec)) continue;
+    Node node;
+    node.host = entry.path();
+    node.name = AmigaName(entry.path().filename().string());
+    node.is_dir = is_dir;
+    node.time = UnixTime(node.host);
+    if (!is_dir) {
+      node.size = entry.file_size(ec);
+      if (ec || node.size > UINT32_MAX) {
+        error = "cannot import " + node.host.string();
+        return false;
+      }
+    }
+    dir.children.push_back(std::move(node));
+  }
+  if (ec) {
+    error = "cannot read " + dir.host.string() + ": " + ec.message();
+    return false;
+  }
+  std::ranges::sort(dir.children,
+                    [](const Node& a, const Node& b) { return NameLess(a.name, b.name); });
+  // AmigaDOS names are case-insensitive; keep the first of a clash.
+  for (std::size_t i = 1; i < dir.children.size();) {
+    if (SameName(dir.children[i - 1].name, dir.children[i].name)) {
+      dir.children.erase(dir.children.begin() + static_cast<std::ptrdiff_t>(i));
+      ++stats_.skipped;
+    } else {
+      ++i;
+    }
+  }
+  for (auto& child : dir.children) {
+    if (child.is_dir) {
+      ++stats_.directories;
+      if (!ScanDirectory(child, depth + 1, error)) return false;
+    } else {
+      ++stats_.files;
+      stats_.bytes += child.size;
+    }
+  }
+  return true;
+}
+
+uint64_t VolumeBuilder::BlocksFor(const Node& dir, const Options& options) const {
+  const uint64_t payload = options.ffs ? options.block_size : options.block_size - kOfsDataOffset;
+  const uint64_t table = options.block_size / 4 - 56;
+  uint64_t blocks = 0;
+  for (const auto& child : dir.children) {
+    if (child.is_dir) {
+      blocks += 1 + BlocksFor(child, options);
+    } else {
+      const uint64_t data = (child.size + payload - 1) / payload;
+      const uint64_t lists = data > table ? (data + table - 1) / table - 1 : 0;
+      blocks += 1 + data + lists;
+    }
+  }
+  return blocks;
+}
+
+uint64_t VolumeBuilder::BlocksNeeded(const Options& options) const {
+  const uint64_t longs = options.block_size / 4;
+  const uint64_t bits = (longs - 1) * 32;
+  const uint64_t bitmaps = (options.num_blocks - kReserved + bits - 1) / bits;
+  const uint64_t extensions =
+      bitmaps > kBitmapPages ? (bitmaps - kBitmapPages + longs - 2) / (longs - 1) : 0;
+  return kReserved + 1 + bitmaps + extensions + BlocksFor(root_, options);
+}
+
+bool VolumeBuilder::Check(const Options& options, std::string& error) const {
+  if (options.block_size < 512 || options.block_size % 4 != 0 || options.num_blocks < 8) {
+    error = "unsupported volume geometry";
+    return false;
+  }
+  const uint64_t needed = BlocksNeeded(options);
+  if (needed > options.num_blocks) {
+    error = "needs " + std::to_string(needed) + " blocks, the volume has " +
+            std::to_string(options.num_blocks);
+    return false;
+  }
+  return true;
+}
+
+bool VolumeBuilder::Build(const Options& options, std::vector<uint8_t>& image,
+                          std::string& error) const {
+  if (!Check(options, error)) return false;
+  Writer w(options, image);
+  return Lay(w, options, error);
+}
+
+bool VolumeBuilder::Format(const Options& options, std::map<uint32_t, std::vector<uint8_t>>& blocks,
+                           std::string& error) {
+  const VolumeBuilder empty;
+  if (!empty.Check(options, error)) return false;
+  Writer w(options, blocks);
+  return empty.Lay(w, options, error);
+}
+
+bool VolumeBuilder::Lay(Writer& w, const Options& options, std::string& error) const {
+  const uint32_t longs = w.Longs();
+  const uint32_t root = (options.num_blocks + 1) / 2;
+
+  uint8_t* boot = w.At(0);
+  boot[0] = 'D';
+  boot[1] = 'O';
+  boot[2] = 'S';
+  boot[3] = options.ffs ? 1 : 0;
+  w.Put(0, 2, root);
+  if (options.bootable) {
+    // The boot block checksum spans both reserved blocks and adds with
+    // end-around carry; without it Kickstart never runs the code.
+    std::ranges::copy(kBootCode, boot + 12);
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < 1024 / 4; ++i) {
+      const uint32_t v = (uint32_t{boot[i * 4]} << 24) | (uint32_t{boot[i * 4 + 1]} << 16) |
+                         (uint32_t{boot[i * 4 + 2]} << 8) | boot[i * 4 + 3];
+      const uint32_t before = sum;
+      sum += v;
+      if (sum < before) ++sum;
+    }
+    w.Put(0, 1, ~sum);
+  }
+
+  w.Claim(root);
+  w.StartAt(root + 1);
+  const uint32_t bits = (longs - 1) * 32;
+  std::vector<uint32_t> pages((options.num_blocks - kReserved + bits - 1) / bits);
+  for (auto& page : pages) page = w.Next();
+  // Pages beyond the 25 in the root are listed in extension blocks.
+  uint32_t link_block = root, link_index = longs - 24;
+  for (std::size_t i = kBitmapPages; i < pages.size(); i += longs - 1) {
+    const uint32_t ext = w.Next();
+    w.Put(link_block, link_index, ext);
+    for (std::size_t k = 0; k < longs - 1 && i + k < pages.size(); ++k) {
+      w.Put(ext, static_cast<uint32_t>(k), pages[i + k]);
+    }
+    link_block = ext;
+    link_index = longs - 1;
+  }
+
+  const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+  w.Put(root, 0, kTypeHeader);
+  w.Put(root, 3, w.TableSize());
+  w.Put(root, longs - 50, 0xFFFFFFFF);
+  for (std::size_t i = 0; i < std::min<std::size_t>(pages.size(), kBitmapPages); ++i) {
+    w.Put(root, longs - 49 + static_cast<uint32_t>(i), pages[i]);
+  }
+  w.SetDate(root, longs - 23, now);
+  w.SetDate(root, longs - 10, now);
+  w.SetDate(root, longs - 7, now);
+  w.SetName(root, AmigaName(options.label));
+  w.Put(root, longs - 1, kSecRoot);
+  w.Checked(root);
+
+  if (!w.Directory(root_, root, error)) return false;
+  w.Bitmaps(pages);
+  w.Checksums();
+  return true;
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef LINUXGUI_SERVICES_VOLUME_BUILDER_H_
+#define LINUXGUI_SERVICES_VOLUME_BUILDER_H_
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace gui {
+// Lays out a host directory tree as a formatted OFS/FFS volume image in a
+// single pass. Blocks are handed out sequentially from behind the root
+// block, so every directory's entries and every file's data end up
+// contiguous, and file contents are read straight into the image.
+class VolumeBuilder {
+ public:
+  struct Options {
+    uint32_t num_blocks = 1760;
+    uint32_t block_size = 512;
+    bool ffs = true;
+    // Writes the standard AmigaDOS boot code.
+    bool bootable = false;
+    std::string label = "Empty";
+  };
+  struct Stats {
+    uint32_t files = 0;
+    uint32_t directories = 0;
+    // Entries whose Amiga name clashes with an earlier one.
+    uint32_t skipped = 0;
+    uint64_t bytes = 0;
+  };
+  bool Scan(const std::filesystem::path& source, std::string& error);
+  // Blocks the scanned tree needs, boot, root and bitmap blocks included.
+  uint64_t BlocksNeeded(const Options& options) const;
+  bool Build(const Options& options, std::vector<uint8_t>& image, std::string& error) const;
+  // An empty volume without materialising it: only the blocks that hold
+  // anything (boot, root, bitmaps) are returned, by block number.
+  static bool Format(const Options& options, std::map<uint32_t, std::vector<uint8_t>>& blocks,
+                     std::string& error);
+  const Stats& GetStats() const { return stats_; }
+  static uint32_t Hash(std::string_view name, uint32_t table_size);
+ private:
+  struct Node {
+    std::filesystem::path host;
+    std::string name;
+    bool is_dir = false;
+    uint64_t size = 0;
+    int64_t time = 0;  // seconds since the Unix epoch
+    std::vector<Node> children;
+  };
+  class Writer;
+  bool ScanDirectory(Node& dir, int depth, std::string& error);
+  uint64_t BlocksFor(const Node& dir, const Options& options) const;
+  bool Check(const Options& options, std::string& error) const;
+  bool Lay(Writer& w, const Options& options, std::string& error) const;
+  Node root_;
+  Stats stats_;
+};
+}
+#endif
@@ -0,0 +1,196 @@
+#include "services/amiga_volume.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kBlocks = 1760;
+constexpr uint32_t kSize = 512;
+constexpr uint32_t kLongs = kSize / 4;
+constexpr uint32_t kTable = kLongs - 56;
+
+class Image {
+ public:
+  explicit Image(bool ofs) : ofs_(ofs), data_(std::size_t{kBlocks} * kSize) {
+    Header(gui::AmigaVolume::RootBlock(kBlocks), 1, "Work");
+  }
+
+  gui::AmigaVolume Volume() {
+    return gui::AmigaVolume(
+        [this](uint32_t nr, std::span<uint8_t> out) {
+          std::memcpy(out.data(), data_.data() + std::size_t{nr} * kSize, kSize);
+          return true;
+        },
+        kBlocks, kSize, ofs_);
+  }
+
+  uint32_t Directory(uint32_t parent, const std::string& name) {
+    const uint32_t nr = next_++;
+    Header(nr, 2, name);
+    Link(parent, nr);
+    return nr;
+  }
+
+  uint32_t File(uint32_t parent, const std::vector<uint8_t>& content) {
+    const uint32_t nr = next_++;
+    Header(nr, static_cast<uint32_t>(-3), "file" + std::to_string(nr));
+    Put(nr, kLongs - 47, static_cast<uint32_t>(content.size()));
+    Link(parent, nr);
+    const std::size_t payload = ofs_ ? kSize - 24 : kSize;
+    uint32_t table = nr, used = 0;
+    for (std::size_t offset = 0; offset < content.size(); offset += payload) {
+      if (used == kTable) {
+        const uint32_t list = next_++;
+        Put(list, 0, 16);
+        Put(list, kLongs - 1, static_cast<uint32_t>(-3));
+        Put(table, kLongs - 2, list);
+        table = list;
+        used = 0;
+      }
+      const uint32_t block = next_++;
+      const std::size_t n = std::min(payload, content.size() - offset);
+      if (ofs_) {
+        Put(block, 0, 8);
+        Put(block, 3, static_cast<uint32_t>(n));
+      }
+      std::memcpy(At(block) + (ofs_ ? 24 : 0), content.data() + offset, n);
+      Put(table, 6 + kTable - 1 - used, block);
+      Put(table, 2, ++used);
+    }
+    return nr;
+  }
+
+  void Put(uint32_t block, uint32_t index, uint32_t value) {
+    uint8_t* p = At(block) + index * 4;
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+  }
+
+ private:
+  uint8_t* At(uint32_t block) { return data_.data() + std::size_t{block} * kSize; }
+
+  void Header(uint32_t nr, uint32_t sec_type, const std::string& name) {
+    Put(nr, 0, 2);
+    Put(nr, kLongs - 1, sec_type);
+    uint8_t* p = At(nr) + kSize - 80;
+    p[0] = static_cast<uint8_t>(name.size());
+    std::memcpy(p + 1, name.data(), name.size());
+  }
+
+  // Prepends to the chain in slot 0, which the walker must follow.
+  void Link(uint32_t dir, uint32_t nr) {
+    uint8_t* slot = At(dir) + 6 * 4;
+    const uint32_t head = (uint32_t{slot[0]} << 24) | (uint32_t{slot[1]} << 16) |
+                          (uint32_t{slot[2]} << 8) | slot[3];
+    Put(nr, kLongs - 4, head);
+    Put(dir, 6, nr);
+  }
+
+  bool ofs_;
+  std::vector<uint8_t> data_;
+  uint32_t next_ = 2;
+};
+
+std::vector<uint8_t> Pattern(std::size_t size) {
+  std::vector<uint8_t> out(size);
+  for (std::size_t i = 0; i < size; ++i) out[i] = static_cast<uint8_t>(i * 7 + i / 251);
+  return out;
+}
+
+void CheckStreams(bool ofs) {
+  Image image(ofs);
+  const uint32_t root = gui::AmigaVolume::RootBlock(kBlocks);
+  // Large enough to need an extension block in both formats.
+  const auto content = Pattern(45000);
+  const uint32_t file = image.File(root, content);
+  auto volume = image.Volume();
+  std::vector<uint8_t> out;
+  ASSERT_TRUE(volume.Stream(file, [&](std::span<const uint8_t> data) {
+    out.insert(out.end(), data.begin(), data.end());
+    return data.size() <= kSize;
+  }));
+  EXPECT_EQ(out, content);
+}
+
+}  // namespace
+
+TEST(AmigaVolumeTest, StreamsFfsFile) { CheckStreams(false); }
+
+TEST(AmigaVolumeTest, StreamsOfsFile) { CheckStreams(true); }
+
+TEST(AmigaVolumeTest, ListsDirectoriesFirst) {
+  Image image(false);
+  const uint32_t root = gui::AmigaVolume::RootBlock(kBlocks);
+  const uint32_t file = image.File(root, Pattern(10));
+  const uint32_t dir = image.Directory(root, "s");
+  image.File(dir, Pattern(3));
+  auto volume = image.Volume();
+  EXPECT_TRUE(volume.IsDirectory(root));
+  EXPECT_FALSE(volume.IsDirectory(file));
+
+  std::vector<gui::AmigaVolume::Entry> entries;
+  ASSERT_TRUE(volume.List(root, entries));
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0].name, "s");
+  EXPECT_EQ(entries[0].kind, gui::AmigaVolume::Kind::kDirectory);
+  EXPECT_EQ(entries[1].block, file);
+  EXPECT_EQ(entries[1].size, 10u);
+
+  // A hash chain pointing back at itself must not hang the walker.
+  image.Put(file, kLongs - 4, file);
+  EXPECT_TRUE(volume.List(root, entries));
+}
+
+TEST(AmigaVolumeTest, ExtractsTree) {
+  Image image(true);
+  const uint32_t root = gui::AmigaVolume::RootBlock(kBlocks);
+  const uint32_t dir = image.Directory(root, "devs");
+  const auto content = Pattern(2000);
+  const uint32_t file = image.File(dir, content);
+  auto volume = image.Volume();
+
+  const auto target = std::filesystem::temp_directory_path() / "vamiga_amiga_volume_test";
+  std::filesystem::remove_all(target);
+  gui::AmigaVolume::Progress progress;
+  std::string error;
+  ASSERT_TRUE(volume.Extract({"Work", root, gui::AmigaVolume::Kind::kDirectory, 0}, target,
+                             progress, error))
+      << error;
+  EXPECT_EQ(progress.files, 1u);
+  EXPECT_EQ(progress.bytes, content.size());
+  std::ifstream in(target / "Work" / "devs" / ("file" + std::to_string(file)), std::ios::binary);
+  const std::vector<uint8_t> read((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  EXPECT_EQ(read, content);
+
+  progress.cancel = true;
+  EXPECT_FALSE(volume.Extract({"Work", root, gui::AmigaVolume::Kind::kDirectory, 0}, target,
+                              progress, error));
+  std::filesystem::remove_all(target);
+}
+
+TEST(AmigaVolumeTest, ExtractStopsAtDirectoryLoop) {
+  Image image(false);
+  const uint32_t root = gui::AmigaVolume::RootBlock(kBlocks);
+  const uint32_t outer = image.Directory(root, "a");
+  const uint32_t inner = image.Directory(outer, "b");
+  // Hash slot 0 of the inner directory points back at its parent.
+  image.Put(inner, 6, outer);
+  auto volume = image.Volume();
+
+  const auto target = std::filesystem::temp_directory_path() / "vamiga_amiga_volume_loop";
+  std::filesystem::remove_all(target);
+  gui::AmigaVolume::Progress progress;
+  std::string error;
+  EXPECT_FALSE(volume.Extract({"Work", root, gui::AmigaVolume::Kind::kDirectory, 0}, target,
+                              progress, error));
+  EXPECT_NE(error.find("loop"), std::string::npos) << error;
+  EXPECT_FALSE(std::filesystem::exists(target / "Work" / "a" / "b" / "a"));
+  std::filesystem::remove_all(target);
+}
@@ -0,0 +1,99 @@
+#include "services/chunk_store.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<uint8_t> RandomBytes(std::size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> data(size);
+  for (auto& b : data) b = static_cast<uint8_t>(rng());
+  return data;
+}
+
+std::vector<uint8_t> ReadBytes(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+class ChunkStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() / "vamiga_chunk_store_test";
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+    ASSERT_TRUE(store_.Open(dir_ / "chunks", dir_));
+  }
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  std::filesystem::path dir_;
+  gui::ChunkStore store_;
+};
+}  // namespace
+
+TEST(ChunkStoreHashTest, MatchesXxh64) {
+  EXPECT_EQ(gui::ChunkStore::Hash({}), 0xEF46DB3751D8E999ULL);
+  const uint8_t abc[] = {'a', 'b', 'c'};
+  EXPECT_EQ(gui::ChunkStore::Hash(abc), 0x44BC2CF5AD770999ULL);
+}
+
+TEST(ChunkStoreSplitTest, BoundariesSurviveAnInsertion) {
+  const auto data = RandomBytes(1 << 20, 1);
+  auto shifted = data;
+  shifted.insert(shifted.begin() + 1000, {1, 2, 3, 4, 5, 6, 7});
+  const auto a = gui::ChunkStore::Split(data);
+  const auto b = gui::ChunkStore::Split(shifted);
+  std::size_t total = 0;
+  for (const auto& c : a) {
+    EXPECT_GE(c.size, 1u);
+    EXPECT_LE(c.size, gui::ChunkStore::kMaxChunk);
+    total += c.size;
+  }
+  EXPECT_EQ(total, data.size());
+  std::size_t shared = 0;
+  for (const auto& c : b) {
+    for (const auto& d : a) {
+      if (c.hash == d.hash) {
+        ++shared;
+        break;
+      }
+    }
+  }
+  EXPECT_GE(shared + 2, a.size());
+}
+
+TEST_F(ChunkStoreTest, WritesOnlyNewChunksAndReadsBack) {
+  auto snap = RandomBytes(2 << 20, 2);
+  std::fill(snap.begin() + (1 << 20), snap.end(), 0);
+  gui::ChunkStore::WriteStats first, second;
+  std::string error;
+  ASSERT_TRUE(store_.Write(snap, dir_ / "a.vsn", error, &first)) << error;
+  auto edited = snap;
+  edited[12345] ^= 0xFF;
+  ASSERT_TRUE(store_.Write(edited, dir_ / "b.vsn", error, &second)) << error;
+  EXPECT_GT(first.new_chunks, 10u);
+  EXPECT_LE(second.new_chunks, 2u);
+  EXPECT_LT(second.new_bytes, first.new_bytes / 20);
+
+  std::vector<uint8_t> out;
+  const auto manifest = ReadBytes(dir_ / "b.vsn");
+  EXPECT_TRUE(gui::ChunkStore::IsManifest(manifest));
+  ASSERT_TRUE(store_.Read(manifest, out));
+  EXPECT_EQ(out, edited);
+}
+
+TEST_F(ChunkStoreTest, CollectKeepsOnlyReferencedChunks) {
+  std::string error;
+  ASSERT_TRUE(store_.Write(RandomBytes(256 << 10, 3), dir_ / "a.vsn", error));
+  ASSERT_TRUE(store_.Write(RandomBytes(256 << 10, 4), dir_ / "b.vsn", error));
+  EXPECT_EQ(store_.Collect(), 0u);
+  std::filesystem::remove(dir_ / "a.vsn");
+  EXPECT_GT(store_.Collect(), 0u);
+  std::vector<uint8_t> out;
+  ASSERT_TRUE(store_.Read(ReadBytes(dir_ / "b.vsn"), out));
+  EXPECT_EQ(out, RandomBytes(256 << 10, 4));
+}
@@ -0,0 +1,105 @@
+#include "services/disk_verifier.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "services/volume_builder.h"
+
+namespace {
+
+// A bootable floppy with a nested directory and a multi-block file.
+std::vector<uint8_t> MakeAdf(bool ffs) {
+  const auto dir = std::filesystem::temp_directory_path() / "vamiga_disk_verifier_src";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir / "s");
+  std::ofstream(dir / "s" / "startup-sequence") << std::string(3000, 'x');
+  std::ofstream(dir / "readme") << "hello";
+  gui::VolumeBuilder builder;
+  std::string error;
+  std::vector<uint8_t> image;
+  gui::VolumeBuilder::Options options;
+  options.ffs = ffs;
+  options.bootable = true;
+  EXPECT_TRUE(builder.Scan(dir, error) && builder.Build(options, image, error)) << error;
+  std::filesystem::remove_all(dir);
+  return image;
+}
+
+// Block number of the first header block after the root's bitmap.
+std::size_t FirstHeader(const std::vector<uint8_t>& image) {
+  for (std::size_t nr = 881; nr < 1760; ++nr) {
+    if (image[nr * 512 + 3] == 2 && image[nr * 512 + 7] == nr % 256) return nr;
+  }
+  return 0;
+}
+
+}  // namespace
+
+TEST(DiskVerifierTest, AcceptsIntactImage) {
+  const auto image = MakeAdf(false);
+  const auto report = gui::DiskVerifier::VerifyImage(image, 11, 4);
+  EXPECT_TRUE(report.Ok()) << report.problems.front();
+  EXPECT_TRUE(report.dos);
+  EXPECT_TRUE(report.bootable);
+  EXPECT_EQ(report.files, 2);
+  ASSERT_EQ(report.tracks.size(), 160u);
+  for (auto status : report.tracks) EXPECT_EQ(status, gui::DiskVerifier::Status::kOk);
+}
+
+TEST(DiskVerifierTest, FlagsDamagedBlocks) {
+  auto image = MakeAdf(true);
+  const std::size_t header = FirstHeader(image);
+  ASSERT_NE(header, 0u);
+  image[header * 512 + 300] ^= 0x01;
+  image[100] ^= 0x01;
+  const auto report = gui::DiskVerifier::VerifyImage(image, 11, 0);
+  EXPECT_FALSE(report.Ok());
+  EXPECT_FALSE(report.bootable);
+  EXPECT_EQ(report.bad_blocks, 1);
+  EXPECT_EQ(report.tracks[header / 11], gui::DiskVerifier::Status::kError);
+  EXPECT_EQ(report.tracks[0], gui::DiskVerifier::Status::kOk);
+}
+
+TEST(DiskVerifierTest, LeavesTracksOutsideImageUnchecked) {
+  const auto adf = MakeAdf(false);
+  const std::vector<uint8_t> half(adf.begin(), adf.begin() + 80 * 11 * 512);
+  const auto report = gui::DiskVerifier::VerifyImage(half, 11, 0, nullptr, 160);
+  ASSERT_EQ(report.tracks.size(), 160u);
+  EXPECT_EQ(report.tracks[79], gui::DiskVerifier::Status::kOk);
+  EXPECT_EQ(report.tracks[80], gui::DiskVerifier::Status::kUnchecked);
+
+  const auto none = gui::DiskVerifier::VerifyImage({}, 11, 0, nullptr, 160);
+  EXPECT_FALSE(none.sector_image);
+  ASSERT_EQ(none.tracks.size(), 160u);
+  for (auto status : none.tracks) EXPECT_EQ(status, gui::DiskVerifier::Status::kUnchecked);
+}
+
+TEST(DiskVerifierTest, ParallelForVisitsEveryIndexOnce) {
+  std::vector<std::atomic<int>> hits(1000);
+  gui::DiskVerifier::ParallelFor(1000, 8, [&](int i) { ++hits[static_cast<std::size_t>(i)]; });
+  for (const auto& h : hits) EXPECT_EQ(h, 1);
+}
+
+TEST(DiskVerifierTest, VerifiesDirectoryInBatch) {
+  const auto dir = std::filesystem::temp_directory_path() / "vamiga_disk_verifier_batch";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir / "sub");
+  auto good = MakeAdf(true);
+  auto bad = good;
+  bad[880 * 512 + 20] ^= 0x40;  // root block
+  std::ofstream(dir / "good.adf", std::ios::binary)
+      .write(reinterpret_cast<const char*>(good.data()), static_cast<std::streamsize>(good.size()));
+  std::ofstream(dir / "sub" / "bad.ADF", std::ios::binary)
+      .write(reinterpret_cast<const char*>(bad.data()), static_cast<std::streamsize>(bad.size()));
+  std::ofstream(dir / "notes.txt") << "ignored";
+
+  std::ostringstream out;
+  EXPECT_EQ(gui::DiskVerifier::VerifyDirectory(dir, out, 2), 1);
+  EXPECT_NE(out.str().find("OK   " + (dir / "good.adf").string()), std::string::npos);
+  EXPECT_NE(out.str().find("bad root block"), std::string::npos);
+  EXPECT_NE(out.str().find("2 images, 1 damaged"), std::string::npos);
+  std::filesystem::remove_all(dir);
+}
@@ -1,5 +1,8 @@
 #include "components/hard_disk_creator.h"
+#include "services/disk_verifier.h"
 #include <fstream>
+#include <iterator>
+#include <vector>
 #include <gtest/gtest.h>
 
 TEST(HardDiskCreatorTest, CalculateGeometry_10MB) {
@@ -40,3 +43,26 @@ TEST(HardDiskCreatorTest, CreateHDF) {
     
     std::remove(temp_path.c_str());
 }
+
+TEST(HardDiskCreatorTest, CreateHDFWithRdbAndFfs) {
+    auto& creator = gui::HardDiskCreator::Instance();
+    std::string temp_path = "test_disk_rdb.hdf";
+    gui::HardDiskCreator::Options options;
+    options.rdb = true;
+    options.format = true;
+    creator.SetOptions(options);
+
+    EXPECT_TRUE(creator.CreateHDF(temp_path)) << creator.LastError();
+    creator.SetOptions({});
+
+    std::ifstream file(temp_path, std::ios::binary);
+    std::vector<uint8_t> image((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+    ASSERT_EQ(image.size(), 640u * 32 * 512);
+
+    auto report = gui::DiskVerifier::VerifyImage(image, 32, 1);
+    EXPECT_TRUE(report.Ok());
+    EXPECT_EQ(report.volumes, 1);
+
+    std::remove(temp_path.c_str());
+}
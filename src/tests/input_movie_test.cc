@@ -0,0 +1,50 @@
+#include "services/input_movie.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+gui::InputMovie SampleMovie() {
+  using Type = gui::InputAction::Type;
+  gui::InputMovie movie;
+  movie.snapshot = {1, 2, 3, 4, 5};
+  movie.events = {
+      {0, {Type::kKeyPress, 0, 0x45, 0, 0}},
+      {0, {Type::kKeyRelease, 0, 0x45, 0, 0}},
+      {3, {Type::kJoystick, 1, 7, 0, 0}},
+      {200, {Type::kMouseMove, 0, 0, -3.5f, 12.25f}},
+      {70000, {Type::kMouseButton, 0, 2, 0, 0}},
+  };
+  for (uint32_t f = 0; f < 300; ++f) movie.checksums.push_back({f, 0x9E3779B97F4A7C15ULL * (f + 1)});
+  return movie;
+}
+}  // namespace
+
+TEST(InputMovieTest, RoundTripsEventsAndChecksums) {
+  const auto movie = SampleMovie();
+  const auto bytes = movie.Encode();
+  gui::InputMovie decoded;
+  ASSERT_TRUE(decoded.Decode(bytes));
+  EXPECT_EQ(decoded.snapshot, movie.snapshot);
+  EXPECT_EQ(decoded.events, movie.events);
+  EXPECT_EQ(decoded.checksums, movie.checksums);
+  EXPECT_EQ(decoded.FrameCount(), 70001u);
+}
+
+TEST(InputMovieTest, RejectsTruncatedAndForeignData) {
+  const auto bytes = SampleMovie().Encode();
+  gui::InputMovie decoded;
+  for (std::size_t cut : {std::size_t{0}, std::size_t{5}, bytes.size() / 2, bytes.size() - 1}) {
+    EXPECT_FALSE(decoded.Decode(std::span(bytes.data(), cut))) << cut;
+  }
+  auto foreign = bytes;
+  foreign[0] ^= 0xFF;
+  EXPECT_FALSE(decoded.Decode(foreign));
+}
+
+TEST(InputMovieTest, FrameHashSeesSinglePixelChange) {
+  std::vector<uint32_t> a(1024, 0xFF000000);
+  auto b = a;
+  b[517] = 0xFF000001;
+  EXPECT_EQ(gui::InputMovie::HashFrame(a), gui::InputMovie::HashFrame(a));
+  EXPECT_NE(gui::InputMovie::HashFrame(a), gui::InputMovie::HashFrame(b));
+}
@@ -0,0 +1,94 @@
+#include "services/log_writer.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+std::filesystem::path FreshDir(const std::string& name) {
+  const auto dir = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  return dir;
+}
+}  // namespace
+
+TEST(LogWriterTest, WritesAllLinesBeforeClose) {
+  const auto dir = FreshDir("vamiga_log_test");
+  const auto path = dir / "console.log";
+  gui::LogWriter writer;
+  ASSERT_TRUE(writer.Open(path, {}));
+  std::string expected;
+  for (int i = 0; i < 1000; ++i) {
+    std::string line = "line " + std::to_string(i) + "\n";
+    expected += line;
+    ASSERT_TRUE(writer.Write(line));
+  }
+  writer.Close();
+  EXPECT_EQ(ReadFile(path), expected);
+  EXPECT_EQ(writer.Dropped(), 0u);
+  std::filesystem::remove_all(dir);
+}
+
+TEST(LogWriterTest, RotatesBySizeAndKeepsMaxFiles) {
+  const auto dir = FreshDir("vamiga_log_rotate");
+  const auto path = dir / "console.log";
+  gui::LogWriter writer;
+  gui::LogWriter::Options options;
+  options.max_bytes = 40;
+  options.max_files = 2;
+  ASSERT_TRUE(writer.Open(path, options));
+  // 10 bytes per line: every fourth line triggers a rotation.
+  for (int i = 0; i < 14; ++i) {
+    writer.Write(std::string("line ") + static_cast<char>('a' + i) + "...\n");
+  }
+  writer.Close();
+
+  EXPECT_EQ(ReadFile(path), "line m...\nline n...\n");
+  EXPECT_EQ(ReadFile(gui::LogWriter::RotatedPath(path, 1, false)),
+            "line i...\nline j...\nline k...\nline l...\n");
+  EXPECT_TRUE(std::filesystem::exists(gui::LogWriter::RotatedPath(path, 2, false)));
+  EXPECT_FALSE(std::filesystem::exists(gui::LogWriter::RotatedPath(path, 3, false)));
+  std::filesystem::remove_all(dir);
+}
+
+TEST(LogWriterTest, CompressesRotatedFiles) {
+  if (!gui::LogWriter::CompressionAvailable()) GTEST_SKIP() << "built without zlib";
+#ifdef HAVE_ZLIB
+  const auto dir = FreshDir("vamiga_log_gzip");
+  const auto path = dir / "console.log";
+  gui::LogWriter writer;
+  gui::LogWriter::Options options;
+  options.max_bytes = 40;
+  options.max_files = 2;
+  options.compress = true;
+  ASSERT_TRUE(writer.Open(path, options));
+  for (int i = 0; i < 6; ++i) {
+    writer.Write(std::string("line ") + static_cast<char>('a' + i) + "...\n");
+  }
+  writer.Close();
+
+  EXPECT_FALSE(std::filesystem::exists(gui::LogWriter::RotatedPath(path, 1, false)));
+  gzFile in = gzopen(gui::LogWriter::RotatedPath(path, 1, true).c_str(), "rb");
+  ASSERT_NE(in, nullptr);
+  char buf[256];
+  const int n = gzread(in, buf, sizeof(buf));
+  gzclose(in);
+  ASSERT_GT(n, 0);
+  EXPECT_EQ(std::string(buf, static_cast<std::size_t>(n)),
+            "line a...\nline b...\nline c...\nline d...\n");
+  EXPECT_EQ(ReadFile(path), "line e...\nline f...\n");
+  std::filesystem::remove_all(dir);
+#endif
+}
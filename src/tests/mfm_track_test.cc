@@ -0,0 +1,116 @@
+#include "services/mfm_track.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Encodes data bits with MFM clock bits, as trackdisk.device writes them.
+class Encoder {
+ public:
+  void Raw(uint32_t value, int bits = 32) {
+    for (int i = bits - 1; i >= 0; --i) Put((value >> i) & 1);
+  }
+  // A longword's data bits, with clocks filled in.
+  void Long(uint32_t value) {
+    for (int i = 30; i >= 0; i -= 2) {
+      const bool data = (value >> i) & 1;
+      Put(!data && !last_);
+      Put(data);
+    }
+  }
+  // Odd bits first, then even bits, each as a run of MFM longwords.
+  void OddEven(const std::vector<uint32_t>& values) {
+    for (uint32_t v : values) Long(v >> 1);
+    for (uint32_t v : values) Long(v);
+  }
+  static uint32_t Checksum(const std::vector<uint32_t>& values) {
+    uint32_t sum = 0;
+    for (uint32_t v : values) sum ^= (v >> 1) ^ v;
+    return sum & 0x55555555;
+  }
+  void Sector(int track, int sector, bool corrupt) {
+    Raw(0xAAAAAAAA);
+    Raw(0x44894489);
+    last_ = true;
+    const uint32_t info = 0xFF000000u | (uint32_t(track) << 16) | (uint32_t(sector) << 8) | 11u;
+    std::vector<uint32_t> label(4, 0);
+    std::vector<uint32_t> data(128);
+    for (std::size_t i = 0; i < data.size(); ++i) data[i] = uint32_t(i * 0x01010101u + sector);
+    std::vector<uint32_t> header = {info};
+    header.insert(header.end(), label.begin(), label.end());
+    // The checksum covers the odd/even split, which XOR leaves intact.
+    OddEven({info});
+    OddEven(label);
+    OddEven({Checksum(header)});
+    OddEven({Checksum(data)});
+    if (corrupt) data[7] ^= 0x00400000;
+    OddEven(data);
+  }
+  void Gap(int bits) {
+    for (int i = 0; i < bits; i += 2) Raw(0b10, 2);
+    last_ = false;
+  }
+  std::string bits;
+
+ private:
+  void Put(bool bit) {
+    bits.push_back(bit ? '1' : '0');
+    last_ = bit;
+  }
+  bool last_ = false;
+};
+
+}  // namespace
+
+TEST(MfmTrackTest, DecodesSectorsAndChecksums) {
+  Encoder e;
+  e.Gap(600);
+  for (int s = 0; s < 11; ++s) e.Sector(17, s, s == 4);
+  e.Gap(1200);
+  const auto track = gui::MfmTrack::Decode(e.bits);
+
+  ASSERT_EQ(track.Sectors().size(), 11u);
+  EXPECT_EQ(track.BadSectors(), 1);
+  for (int s = 0; s < 11; ++s) {
+    const auto& sector = track.Sectors()[static_cast<std::size_t>(s)];
+    EXPECT_EQ(sector.track, 17);
+    EXPECT_EQ(sector.sector, s);
+    EXPECT_TRUE(sector.header_ok);
+    EXPECT_EQ(sector.data_ok, s != 4);
+  }
+
+  // Spans tile the whole track in order.
+  std::size_t expected = 0;
+  for (const auto& span : track.Spans()) {
+    EXPECT_EQ(span.begin, expected);
+    expected = span.end;
+  }
+  EXPECT_EQ(expected, track.BitCount());
+  const auto& first = track.Sectors()[0];
+  EXPECT_EQ(track.SpanAt(first.sync_bit).region, gui::MfmTrack::Region::kSync);
+  EXPECT_EQ(track.SpanAt(first.sync_bit + 40).region, gui::MfmTrack::Region::kHeader);
+  EXPECT_EQ(track.SpanAt(first.sync_bit + 32 + gui::MfmTrack::kHeaderBits).region,
+            gui::MfmTrack::Region::kData);
+  EXPECT_EQ(track.SpanAt(0).region, gui::MfmTrack::Region::kGap);
+}
+
+TEST(MfmTrackTest, FindsSectorAcrossTheIndex) {
+  Encoder e;
+  e.Sector(3, 5, false);
+  e.Gap(400);
+  // Rotate so that the sync words straddle the end of the stream.
+  const std::size_t cut = 40;
+  const std::string rotated = e.bits.substr(cut) + e.bits.substr(0, cut);
+  const auto track = gui::MfmTrack::Decode(rotated);
+  ASSERT_EQ(track.Sectors().size(), 1u);
+  EXPECT_EQ(track.Sectors()[0].sector, 5);
+  EXPECT_TRUE(track.Sectors()[0].data_ok);
+}
+
+TEST(MfmTrackTest, HandlesEmptyTrack) {
+  const auto track = gui::MfmTrack::Decode("");
+  EXPECT_TRUE(track.Sectors().empty());
+  EXPECT_EQ(track.SpanAt(0).region, gui::MfmTrack::Region::kGap);
+}
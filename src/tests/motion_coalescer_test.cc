@@ -0,0 +1,60 @@
+#include "services/motion_coalescer.h"
+#include <gtest/gtest.h>
+
+namespace {
+constexpr int64_t kFrame = gui::MotionCoalescer::kPalFrameCycles;
+}  // namespace
+
+TEST(MotionCoalescerTest, DeliversOncePerFrame) {
+  gui::MotionCoalescer c;
+  c.Configure(1, kFrame);
+  c.Add(3, -2);
+  ASSERT_TRUE(c.Due(1000));
+  auto d = c.Take(1000);
+  EXPECT_EQ(d.dx, 3);
+  EXPECT_EQ(d.dy, -2);
+
+  for (int i = 0; i < 20; ++i) c.Add(1, 1);
+  EXPECT_FALSE(c.Due(1000 + kFrame - 1));
+  ASSERT_TRUE(c.Due(1000 + kFrame));
+  d = c.Take(1000 + kFrame);
+  EXPECT_EQ(d.dx, 20);
+  EXPECT_EQ(d.dy, 20);
+  EXPECT_TRUE(c.Empty());
+}
+
+TEST(MotionCoalescerTest, SubFrameRateShortensInterval) {
+  gui::MotionCoalescer c;
+  c.Configure(4, kFrame);
+  c.Add(1, 0);
+  c.Take(0);
+  c.Add(1, 0);
+  EXPECT_FALSE(c.Due(kFrame / 4 - 1));
+  EXPECT_TRUE(c.Due(kFrame / 4));
+}
+
+TEST(MotionCoalescerTest, KeepsFractionalRemainder) {
+  gui::MotionCoalescer c;
+  c.Configure(0, kFrame);
+  double total_x = 0.0, total_y = 0.0;
+  for (int i = 0; i < 100; ++i) {
+    c.Add(0.3, -0.7);
+    if (c.Due(i)) {
+      const auto d = c.Take(i);
+      total_x += d.dx;
+      total_y += d.dy;
+    }
+  }
+  EXPECT_EQ(total_x, 29);  // 30 minus the remainder still accumulating
+  EXPECT_EQ(total_y, -69);
+  EXPECT_FALSE(c.Empty());
+}
+
+TEST(MotionCoalescerTest, RestartsAfterClockJumpsBack) {
+  gui::MotionCoalescer c;
+  c.Configure(1, kFrame);
+  c.Add(5, 5);
+  c.Take(10 * kFrame);
+  c.Add(5, 5);
+  EXPECT_TRUE(c.Due(100));
+}
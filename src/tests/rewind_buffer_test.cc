@@ -0,0 +1,69 @@
+#include "services/lz_codec.h"
+#include "services/rewind_buffer.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<uint8_t> Snapshot(std::size_t size, int generation) {
+  std::vector<uint8_t> s(size, 0);
+  // Mostly static memory with a few changing bytes, like consecutive frames.
+  for (std::size_t i = 0; i < size; i += 97) s[i] = static_cast<uint8_t>(i * 7);
+  for (int k = 0; k < 50; ++k) s[(k * 4099 + generation * 131) % size] = static_cast<uint8_t>(generation);
+  return s;
+}
+}  // namespace
+
+TEST(LzCodecTest, RoundTripsRunsAndNoise) {
+  std::mt19937 rng(42);
+  std::vector<uint8_t> data(200000, 0);
+  for (std::size_t i = 100000; i < 150000; ++i) data[i] = static_cast<uint8_t>(rng());
+  for (std::size_t i = 150000; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i % 13);
+  const auto packed = gui::LzCompress(data);
+  EXPECT_LT(packed.size(), data.size() / 3);
+  std::vector<uint8_t> out(data.size());
+  ASSERT_TRUE(gui::LzDecompress(packed, out));
+  EXPECT_EQ(out, data);
+
+  std::vector<uint8_t> tiny = {1, 2, 3};
+  std::vector<uint8_t> tiny_out(3);
+  ASSERT_TRUE(gui::LzDecompress(gui::LzCompress(tiny), tiny_out));
+  EXPECT_EQ(tiny_out, tiny);
+}
+
+TEST(LzCodecTest, RejectsCorruptInput) {
+  std::vector<uint8_t> data(4096, 0xAB);
+  auto packed = gui::LzCompress(data);
+  std::vector<uint8_t> out(data.size());
+  EXPECT_FALSE(gui::LzDecompress(std::span(packed.data(), packed.size() / 2), out));
+  std::vector<uint8_t> wrong_size(data.size() + 1);
+  EXPECT_FALSE(gui::LzDecompress(packed, wrong_size));
+}
+
+TEST(RewindBufferTest, StepsBackThroughHistory) {
+  gui::RewindBuffer buffer;
+  for (int g = 0; g < 10; ++g) buffer.Push(Snapshot(65536 + g, g), g * 100);
+  EXPECT_EQ(buffer.Depth(), 9u);
+  for (int g = 8; g >= 0; --g) {
+    const auto* s = buffer.StepBack();
+    ASSERT_NE(s, nullptr);
+    EXPECT_EQ(*s, Snapshot(65536 + g, g)) << g;
+    EXPECT_EQ(buffer.CurrentStamp(), g * 100);
+  }
+  EXPECT_EQ(buffer.StepBack(), nullptr);
+}
+
+TEST(RewindBufferTest, EvictsOldestToStayInBudget) {
+  gui::RewindBuffer buffer(70000);
+  for (int g = 0; g < 50; ++g) buffer.Push(Snapshot(65536, g), g);
+  EXPECT_LE(buffer.MemoryBytes(), 70000u);
+  EXPECT_GT(buffer.Depth(), 0u);
+  EXPECT_EQ(buffer.OldestStamp(), 50 - static_cast<int64_t>(buffer.Depth()) - 1);
+  // Whatever is left must still restore exactly.
+  const auto depth = buffer.Depth();
+  const std::vector<uint8_t>* s = nullptr;
+  for (std::size_t i = 0; i < depth; ++i) s = buffer.StepBack();
+  ASSERT_NE(s, nullptr);
+  EXPECT_EQ(*s, Snapshot(65536, 49 - static_cast<int>(depth)));
+}
@@ -0,0 +1,57 @@
+#include "services/shell_transcript.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+std::string Lines(const std::string& line, int count) {
+  std::string text;
+  for (int i = 0; i < count; ++i) text += line + "\n";
+  return text;
+}
+}  // namespace
+
+TEST(ShellTranscriptTest, CountsAppendedLines) {
+  gui::ShellTranscript t;
+  EXPECT_EQ(t.Update("one\ntwo\n> "), 2u);
+  EXPECT_EQ(t.OpenLine(), "> ");
+  EXPECT_EQ(t.Update("one\ntwo\n> help"), 0u);
+  EXPECT_EQ(t.Update("one\ntwo\n> help\nusage\n> "), 2u);
+  EXPECT_EQ(t.CompleteLines(), 4u);
+  EXPECT_EQ(t.FirstLine(), 0u);
+  EXPECT_EQ(t.Line(2), "> help\n");
+  EXPECT_EQ(t.OpenLine(), "> ");
+}
+
+TEST(ShellTranscriptTest, KeepsNumberingWhenBufferScrolls) {
+  gui::ShellTranscript t;
+  t.Update("a\nb\nc\n> ");
+  EXPECT_EQ(t.Update("c\n> x\nd\n> "), 2u);
+  EXPECT_EQ(t.FirstLine(), 2u);
+  EXPECT_EQ(t.CompleteLines(), 5u);
+  EXPECT_EQ(t.Line(2), "c\n");
+  EXPECT_EQ(t.Line(4), "d\n");
+  EXPECT_EQ(t.Line(1), "");
+}
+
+TEST(ShellTranscriptTest, RepeatedLinesDoNotHideNewOnes) {
+  gui::ShellTranscript t;
+  t.Update(Lines("ok", 8) + "> ");
+  // A full buffer that scrolled by three identical lines and one new one.
+  EXPECT_EQ(t.Update(Lines("ok", 7) + "done\n> "), 1u);
+  EXPECT_EQ(t.Update(Lines("ok", 4) + "done\n" + Lines("ok", 3) + "> "), 3u);
+  EXPECT_EQ(t.FirstLine(), 4u);
+  EXPECT_EQ(t.Line(11), "ok\n");
+  EXPECT_EQ(t.Line(8), "done\n");
+}
+
+TEST(ShellTranscriptTest, ClearedBufferCountsAsNew) {
+  gui::ShellTranscript t;
+  t.Update("a\nb\n> ");
+  EXPECT_EQ(t.Update("> "), 0u);
+  EXPECT_EQ(t.FirstLine(), 2u);
+  EXPECT_EQ(t.Update("x\n> "), 1u);
+  EXPECT_EQ(t.Line(2), "x\n");
+  t.Reset();
+  EXPECT_EQ(t.CompleteLines(), 0u);
+  EXPECT_EQ(t.Update("x\n> "), 1u);
+}
@@ -0,0 +1,159 @@
+#include "services/snapshot_library.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+std::string Name(const char* prefix, int i) {
+  std::string digits = std::to_string(i);
+  return prefix + std::string(4 - digits.size(), '0') + digits + ".vsn";
+}
+
+class SnapshotLibraryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() / "vamiga_snaplib_test";
+    std::filesystem::remove_all(dir_);
+  }
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  gui::SnapshotLibrary::Entry MakeSnapshot(int i) {
+    gui::SnapshotLibrary::Entry e;
+    e.file = Name("snap-", i);
+    e.title = "Test";
+    e.time = 1000 + i;
+    std::ofstream(dir_ / e.file) << "x";
+    e.bytes = 1;
+    std::vector<uint32_t> frame(320 * 200, 0xFF000000u | static_cast<uint32_t>(i));
+    e.thumbnail =
+        gui::SnapshotLibrary::PackThumbnail(gui::SnapshotLibrary::MakeThumbnail(frame, 320, 200));
+    return e;
+  }
+
+  std::filesystem::path dir_;
+};
+}  // namespace
+
+TEST_F(SnapshotLibraryTest, IndexSurvivesReopen) {
+  gui::SnapshotLibrary lib;
+  ASSERT_TRUE(lib.Open(dir_));
+  for (int i = 0; i < 5; ++i) ASSERT_TRUE(lib.Add(MakeSnapshot(i)));
+  ASSERT_TRUE(lib.Remove("snap-0002.vsn"));
+  EXPECT_FALSE(std::filesystem::exists(dir_ / "snap-0002.vsn"));
+
+  gui::SnapshotLibrary reopened;
+  ASSERT_TRUE(reopened.Open(dir_));
+  ASSERT_EQ(reopened.Entries().size(), 4u);
+  EXPECT_EQ(reopened.Entries()[2].file, "snap-0003.vsn");
+  std::vector<uint32_t> thumb;
+  ASSERT_TRUE(gui::SnapshotLibrary::UnpackThumbnail(reopened.Entries()[2].thumbnail, thumb));
+  EXPECT_EQ(thumb[0], 0xFF000003u);
+}
+
+TEST_F(SnapshotLibraryTest, TrimDeletesOldest) {
+  gui::SnapshotLibrary lib;
+  ASSERT_TRUE(lib.Open(dir_));
+  for (int i = 0; i < 10; ++i) lib.Add(MakeSnapshot(i));
+  EXPECT_EQ(lib.Trim(7), 3u);
+  EXPECT_EQ(lib.Trim(7), 0u);
+  EXPECT_FALSE(std::filesystem::exists(dir_ / "snap-0002.vsn"));
+  EXPECT_TRUE(std::filesystem::exists(dir_ / "snap-0003.vsn"));
+
+  gui::SnapshotLibrary reopened;
+  ASSERT_TRUE(reopened.Open(dir_));
+  ASSERT_EQ(reopened.Entries().size(), 7u);
+  EXPECT_EQ(reopened.Entries().front().file, "snap-0003.vsn");
+}
+
+TEST_F(SnapshotLibraryTest, ResavedSnapshotKeepsOneEntryAfterReopen) {
+  gui::SnapshotLibrary lib;
+  ASSERT_TRUE(lib.Open(dir_));
+  ASSERT_TRUE(lib.Add(MakeSnapshot(0)));
+  ASSERT_TRUE(lib.Add(MakeSnapshot(1)));
+  auto resaved = MakeSnapshot(0);
+  resaved.time = 2000;
+  ASSERT_TRUE(lib.Add(std::move(resaved)));
+  ASSERT_EQ(lib.Entries().size(), 2u);
+
+  gui::SnapshotLibrary reopened;
+  ASSERT_TRUE(reopened.Open(dir_));
+  ASSERT_EQ(reopened.Entries().size(), 2u);
+  EXPECT_EQ(reopened.Entries()[1].file, "snap-0000.vsn");
+  EXPECT_EQ(reopened.Entries()[1].time, 2000);
+  EXPECT_EQ(reopened.Trim(1), 1u);
+  ASSERT_EQ(reopened.Entries().size(), 1u);
+  EXPECT_EQ(reopened.Entries()[0].file, "snap-0000.vsn");
+  EXPECT_TRUE(std::filesystem::exists(dir_ / "snap-0000.vsn"));
+  EXPECT_FALSE(std::filesystem::exists(dir_ / "snap-0001.vsn"));
+}
+
+TEST_F(SnapshotLibraryTest, RebuildsFromDirectoryAndToleratesTornAppend) {
+  std::filesystem::create_directories(dir_);
+  std::ofstream(dir_ / "a.vsn") << "abc";
+  std::ofstream(dir_ / "notes.txt") << "ignored";
+  {
+    gui::SnapshotLibrary lib;
+    ASSERT_TRUE(lib.Open(dir_));
+    ASSERT_EQ(lib.Entries().size(), 1u);
+    EXPECT_EQ(lib.Entries()[0].bytes, 3u);
+    lib.Add(MakeSnapshot(1));
+  }
+  // Simulate a crash in the middle of appending a record.
+  std::ofstream(dir_ / gui::SnapshotLibrary::kIndexName, std::ios::app | std::ios::binary)
+      << '\x01' << '\x40';
+  gui::SnapshotLibrary reopened;
+  ASSERT_TRUE(reopened.Open(dir_));
+  EXPECT_EQ(reopened.Entries().size(), 2u);
+}
+
+TEST_F(SnapshotLibraryTest, ReconcilesIndexWithDirectory) {
+  {
+    gui::SnapshotLibrary lib;
+    ASSERT_TRUE(lib.Open(dir_));
+    for (int i = 0; i < 3; ++i) lib.Add(MakeSnapshot(i));
+  }
+  // One snapshot deleted outside the library, one saved without reaching Add().
+  std::filesystem::remove(dir_ / "snap-0001.vsn");
+  std::ofstream(dir_ / "orphan.vsn") << "orphan";
+
+  gui::SnapshotLibrary lib;
+  ASSERT_TRUE(lib.Open(dir_));
+  ASSERT_EQ(lib.Entries().size(), 3u);
+  EXPECT_EQ(lib.Entries()[0].file, "snap-0000.vsn");
+  EXPECT_EQ(lib.Entries()[1].file, "snap-0002.vsn");
+  EXPECT_EQ(lib.Entries()[2].file, "orphan.vsn");
+  EXPECT_EQ(lib.Entries()[2].bytes, 6u);
+
+  // The reconciled index is written back, and the orphan can be trimmed.
+  gui::SnapshotLibrary reopened;
+  ASSERT_TRUE(reopened.Open(dir_));
+  EXPECT_EQ(reopened.Entries().size(), 3u);
+  EXPECT_EQ(reopened.Trim(1), 2u);
+  EXPECT_EQ(reopened.Entries()[0].file, "orphan.vsn");
+  EXPECT_FALSE(std::filesystem::exists(dir_ / "snap-0002.vsn"));
+}
+
+TEST_F(SnapshotLibraryTest, OpensThousandSnapshotsQuickly) {
+  {
+    gui::SnapshotLibrary lib;
+    ASSERT_TRUE(lib.Open(dir_));
+    const auto entry = MakeSnapshot(0);
+    std::filesystem::remove(dir_ / entry.file);
+    for (int i = 0; i < 1000; ++i) {
+      auto e = entry;
+      e.file = Name("bulk-", i);
+      e.time = i;
+      std::ofstream(dir_ / e.file) << "x";
+      lib.Add(std::move(e));
+    }
+  }
+  const auto start = std::chrono::steady_clock::now();
+  gui::SnapshotLibrary lib;
+  ASSERT_TRUE(lib.Open(dir_));
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(lib.Entries().size(), 1000u);
+  EXPECT_LT(elapsed, std::chrono::milliseconds(250));
+}
@@ -0,0 +1,23 @@
+#include "services/snapshot_slots.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(SnapshotSlotsTest, StoresWithoutReallocating) {
+  gui::SnapshotSlots slots;
+  const std::vector<uint8_t> a(1000, 1), b(1100, 2);
+  ASSERT_TRUE(slots.Store(3, a, 10));
+  EXPECT_GE(slots.Capacity(), 1250u);
+  const uint8_t* buffer = slots.Data(3).data();
+  ASSERT_TRUE(slots.Store(3, b, 20));
+  EXPECT_EQ(slots.Data(3).data(), buffer);
+  EXPECT_EQ(slots.Data(3), b);
+  EXPECT_EQ(slots.Time(3), 20);
+
+  EXPECT_TRUE(slots.Empty(0));
+  ASSERT_TRUE(slots.Store(0, a, 30));
+  EXPECT_GE(slots.Data(0).capacity(), slots.Capacity());
+  slots.Clear(3);
+  EXPECT_TRUE(slots.Empty(3));
+  EXPECT_FALSE(slots.Store(gui::SnapshotSlots::kCount, a, 0));
+  EXPECT_TRUE(slots.Empty(gui::SnapshotSlots::kCount));
+}
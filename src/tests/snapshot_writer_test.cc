@@ -0,0 +1,84 @@
+#include "services/snapshot_writer.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<uint8_t> ReadBytes(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+std::vector<uint8_t> FakeSnapshot() {
+  std::vector<uint8_t> s(300000, 0);
+  for (std::size_t i = 0; i < s.size(); i += 17) s[i] = static_cast<uint8_t>(i);
+  return s;
+}
+}  // namespace
+
+TEST(SnapshotWriterTest, PackRoundTrips) {
+  const auto snap = FakeSnapshot();
+  const auto packed = gui::SnapshotWriter::Pack(snap);
+  EXPECT_TRUE(gui::SnapshotWriter::IsPacked(packed));
+  EXPECT_FALSE(gui::SnapshotWriter::IsPacked(snap));
+  EXPECT_LT(packed.size(), snap.size());
+  std::vector<uint8_t> out;
+  ASSERT_TRUE(gui::SnapshotWriter::Unpack(packed, out));
+  EXPECT_EQ(out, snap);
+}
+
+TEST(SnapshotWriterTest, WritesInBackgroundAndReports) {
+  const auto dir = std::filesystem::temp_directory_path() / "vamiga_snapwriter_test";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  const auto snap = FakeSnapshot();
+
+  int delivered = 0;
+  {
+    gui::SnapshotWriter writer;
+    ASSERT_TRUE(writer.Submit(snap, dir / "raw.vsn", gui::SnapshotWriter::Format::kRaw,
+                              [&](const auto& r) { delivered += r.ok ? 1 : 100; }));
+    ASSERT_TRUE(writer.Submit(snap, dir / "packed.vsn", gui::SnapshotWriter::Format::kPacked,
+                              [&](const auto& r) { delivered += r.ok ? 1 : 100; }));
+    ASSERT_TRUE(writer.Submit(snap, dir / "missing" / "x.vsn", gui::SnapshotWriter::Format::kRaw,
+                              [&](const auto& r) { delivered += r.ok ? 100 : 1; }));
+    while (writer.Pending() > 0) writer.DeliverResults();
+  }
+  EXPECT_EQ(delivered, 3);
+  EXPECT_EQ(ReadBytes(dir / "raw.vsn"), snap);
+  std::vector<uint8_t> unpacked;
+  ASSERT_TRUE(gui::SnapshotWriter::Unpack(ReadBytes(dir / "packed.vsn"), unpacked));
+  EXPECT_EQ(unpacked, snap);
+  EXPECT_FALSE(std::filesystem::exists(dir / "raw.vsn.part"));
+  std::filesystem::remove_all(dir);
+}
+
+TEST(SnapshotWriterTest, RejectsWhenResultsAreNotDelivered) {
+  const auto dir = std::filesystem::temp_directory_path() / "vamiga_snapwriter_full";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  const std::vector<uint8_t> snap(1024, 0x5A);
+
+  int delivered = 0;
+  {
+    gui::SnapshotWriter writer;
+    const int n = static_cast<int>(gui::SnapshotWriter::kQueueSize);
+    for (int i = 0; i < n; ++i) {
+      ASSERT_TRUE(writer.Submit(snap, dir / (std::to_string(i) + ".vsn"),
+                                gui::SnapshotWriter::Format::kRaw,
+                                [&](const auto& r) { delivered += r.ok ? 1 : 100; }));
+    }
+    EXPECT_FALSE(writer.Submit(snap, dir / "extra.vsn", gui::SnapshotWriter::Format::kRaw));
+    EXPECT_EQ(writer.Pending(), n);
+    while (writer.Pending() > 0) writer.DeliverResults();
+    EXPECT_TRUE(writer.Submit(snap, dir / "again.vsn", gui::SnapshotWriter::Format::kRaw,
+                              [&](const auto& r) { delivered += r.ok ? 1 : 100; }));
+    while (writer.Pending() > 0) writer.DeliverResults();
+  }
+  EXPECT_EQ(delivered, static_cast<int>(gui::SnapshotWriter::kQueueSize) + 1);
+  EXPECT_FALSE(std::filesystem::exists(dir / "extra.vsn"));
+  std::filesystem::remove_all(dir);
+}
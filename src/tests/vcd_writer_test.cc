@@ -0,0 +1,51 @@
+#include "services/vcd_writer.h"
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace {
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+}  // namespace
+
+TEST(VcdWriterTest, WritesHeaderAndOnlyChangedValues) {
+  const auto path = std::filesystem::temp_directory_path() / "vamiga_vcd_test.vcd";
+  {
+    gui::VcdWriter writer;
+    ASSERT_TRUE(writer.Open(path, {{"fire", 1}, {"bus", 8}}));
+    writer.Sample(0, std::array<uint64_t, 2>{0, 5});
+    writer.Sample(1, std::array<uint64_t, 2>{0, 5});
+    writer.Sample(2, std::array<uint64_t, 2>{1, 5});
+    writer.Sample(3, std::array<uint64_t, 2>{1, gui::VcdWriter::kUnknown});
+    writer.Close();
+  }
+  const std::string vcd = ReadFile(path);
+  EXPECT_NE(vcd.find("$var wire 1 ! fire $end"), std::string::npos);
+  EXPECT_NE(vcd.find("$var wire 8 \" bus $end"), std::string::npos);
+  EXPECT_NE(vcd.find("#0\n$dumpvars\n0!\nb101 \"\n$end\n"), std::string::npos);
+  EXPECT_EQ(vcd.find("#1\n"), std::string::npos);
+  EXPECT_NE(vcd.find("#2\n1!\n"), std::string::npos);
+  EXPECT_NE(vcd.find("#3\nbx \"\n"), std::string::npos);
+  std::filesystem::remove(path);
+}
+
+TEST(VcdWriterTest, FlushesAllChunksOnClose) {
+  const auto path = std::filesystem::temp_directory_path() / "vamiga_vcd_chunks.vcd";
+  gui::VcdWriter writer;
+  ASSERT_TRUE(writer.Open(path, {{"bit", 1}}));
+  const uint64_t count = gui::VcdWriter::kChunkSamples * 3 + 17;
+  for (uint64_t t = 0; t < count; ++t) {
+    writer.Sample(t, std::array<uint64_t, 1>{t & 1});
+  }
+  writer.Close();
+  const std::string vcd = ReadFile(path);
+  EXPECT_NE(vcd.find("#" + std::to_string(count - 1) + "\n"), std::string::npos);
+  EXPECT_EQ(writer.SamplesQueued(), count);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,142 @@
+#include "services/volume_builder.h"
+#include <gtest/gtest.h>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "services/amiga_volume.h"
+
+namespace {
+
+std::vector<uint8_t> Pattern(std::size_t size, int seed) {
+  std::vector<uint8_t> out(size);
+  for (std::size_t i = 0; i < size; ++i) out[i] = static_cast<uint8_t>(i * 31 + seed + i / 509);
+  return out;
+}
+
+void WriteFile(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+uint32_t Long(const std::vector<uint8_t>& image, std::size_t block, std::size_t index) {
+  const uint8_t* p = image.data() + block * 512 + index * 4;
+  return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+}
+
+class VolumeBuilderTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    dir_ = std::filesystem::temp_directory_path() / "vamiga_volume_builder_test";
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_ / "c");
+    std::filesystem::create_directories(dir_ / "s" / "empty");
+    WriteFile(dir_ / "c" / "Big", Pattern(100000, 1));
+    WriteFile(dir_ / "s" / "Startup-Sequence", Pattern(700, 2));
+    WriteFile(dir_ / "Empty.txt", {});
+  }
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  std::filesystem::path dir_;
+};
+
+TEST_P(VolumeBuilderTest, RoundTripsThroughReader) {
+  const bool ffs = GetParam();
+  gui::VolumeBuilder builder;
+  std::string error;
+  ASSERT_TRUE(builder.Scan(dir_, error)) << error;
+  EXPECT_EQ(builder.GetStats().files, 3u);
+  EXPECT_EQ(builder.GetStats().directories, 3u);
+
+  gui::VolumeBuilder::Options options;
+  options.ffs = ffs;
+  options.label = "Test";
+  std::vector<uint8_t> image;
+  ASSERT_TRUE(builder.Build(options, image, error)) << error;
+  ASSERT_EQ(image.size(), 1760u * 512u);
+
+  // Every header and the root sum to zero, each bitmap likewise.
+  uint32_t sum = 0;
+  for (std::size_t i = 0; i < 128; ++i) sum += Long(image, 880, i);
+  EXPECT_EQ(sum, 0u);
+  const uint32_t bitmap = Long(image, 880, 128 - 49);
+  sum = 0;
+  uint32_t free_blocks = 0;
+  for (std::size_t i = 0; i < 128; ++i) sum += Long(image, bitmap, i);
+  for (std::size_t i = 1; i < 128; ++i) free_blocks += std::popcount(Long(image, bitmap, i));
+  EXPECT_EQ(sum, 0u);
+  EXPECT_EQ(free_blocks, 1760u - builder.BlocksNeeded(options));
+
+  gui::AmigaVolume volume(
+      [&](uint32_t nr, std::span<uint8_t> out) {
+        std::memcpy(out.data(), image.data() + std::size_t{nr} * 512, out.size());
+        return true;
+      },
+      1760, 512, !ffs);
+  std::vector<gui::AmigaVolume::Entry> root, sub;
+  ASSERT_TRUE(volume.List(gui::AmigaVolume::RootBlock(1760), root));
+  ASSERT_EQ(root.size(), 3u);
+  EXPECT_EQ(root[0].name, "c");
+  EXPECT_EQ(root[1].name, "s");
+  EXPECT_EQ(root[2].name, "Empty.txt");
+
+  ASSERT_TRUE(volume.List(root[0].block, sub));
+  ASSERT_EQ(sub.size(), 1u);
+  std::vector<uint8_t> content;
+  ASSERT_TRUE(volume.Stream(sub[0].block, [&](std::span<const uint8_t> data) {
+    content.insert(content.end(), data.begin(), data.end());
+    return true;
+  }));
+  EXPECT_EQ(content, Pattern(100000, 1));
+
+  ASSERT_TRUE(volume.List(root[1].block, sub));
+  ASSERT_EQ(sub.size(), 2u);
+  EXPECT_EQ(sub[0].kind, gui::AmigaVolume::Kind::kDirectory);
+  EXPECT_EQ(sub[1].size, 700u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, VolumeBuilderTest, ::testing::Values(false, true));
+
+TEST(VolumeBuilderHashTest, MatchesAmigaDos) {
+  // Hash slots of well-known names on a 512-byte block volume.
+  EXPECT_EQ(gui::VolumeBuilder::Hash("c", 72), (1 * 13 + 'C') % 72u);
+  EXPECT_EQ(gui::VolumeBuilder::Hash("S", 72), gui::VolumeBuilder::Hash("s", 72));
+}
+
+TEST(VolumeBuilderNameTest, SkipsCaseInsensitiveClashes) {
+  const auto dir = std::filesystem::temp_directory_path() / "vamiga_volume_builder_case";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  // Byte-wise these sort as "Foo", "bar", "foo", which hides the clash.
+  WriteFile(dir / "Foo", Pattern(10, 1));
+  WriteFile(dir / "bar", Pattern(10, 2));
+  WriteFile(dir / "foo", Pattern(10, 3));
+  gui::VolumeBuilder builder;
+  std::string error;
+  ASSERT_TRUE(builder.Scan(dir, error)) << error;
+  EXPECT_EQ(builder.GetStats().files, 2u);
+  EXPECT_EQ(builder.GetStats().skipped, 1u);
+  std::filesystem::remove_all(dir);
+}
+
+TEST(VolumeBuilderSizeTest, RejectsTreesThatDoNotFit) {
+  const auto dir = std::filesystem::temp_directory_path() / "vamiga_volume_builder_big";
+  std::filesystem::create_directories(dir);
+  WriteFile(dir / "huge", std::vector<uint8_t>(1024 * 1024));
+  gui::VolumeBuilder builder;
+  std::string error;
+  ASSERT_TRUE(builder.Scan(dir, error));
+  std::vector<uint8_t> image;
+  EXPECT_FALSE(builder.Build({}, image, error));
+  EXPECT_NE(error.find("blocks"), std::string::npos);
+
+  // Large enough to need bitmap extension blocks.
+  gui::VolumeBuilder::Options options;
+  options.num_blocks = 200000;
+  EXPECT_TRUE(builder.Build(options, image, error)) << error;
+  std::filesystem::remove_all(dir);
+}
+
+}  // namespace